@@ -46,6 +46,19 @@ public:
 
     /** Return the corresponding documentation instance for a determinate declaration. */
     virtual IDocumentation::Ptr documentationForDeclaration(Declaration* declaration) = 0;
+
+    /**
+     * Return the documentation for @p declaration without asking the providers, if it was looked up before.
+     *
+     * Otherwise the lookup is scheduled to run later from the event loop, @p pending is set to true,
+     * and documentationReady() is emitted once it is done. Use this where the documentation is
+     * shown along with other information, like in tooltips, so that those are not delayed.
+     *
+     * The providers are not thread-safe, so the deferred lookup still runs in the main thread.
+     * This function and documentationForDeclaration() may be called from any thread.
+     */
+    virtual IDocumentation::Ptr cachedDocumentationForDeclaration(Declaration* declaration, bool* pending) = 0;
+
     /** Returns a corresponding documentation if a provider has one for the given URL*/
     virtual IDocumentation::Ptr documentation(const QUrl& url) const = 0;
 public Q_SLOTS:
@@ -58,6 +71,9 @@ public Q_SLOTS:
 Q_SIGNALS:
     /** Emitted when providers list changed */
     void providersChanged();
+
+    /** Emitted when documentation lookups scheduled by cachedDocumentationForDeclaration() are done */
+    void documentationReady();
 };
 
 }
@@ -19,6 +19,8 @@
 
 #include "itestsuite.h"
 
+#include <QStringList>
+
 using namespace KDevelop;
 
 ITestSuite::~ITestSuite()
@@ -26,3 +28,12 @@ ITestSuite::~ITestSuite()
 
 }
 
+bool ITestSuite::runSerial() const
+{
+    return false;
+}
+
+QStringList ITestSuite::resourceLocks() const
+{
+    return QStringList();
+}
@@ -114,6 +114,21 @@ public:
      * @param testCase the test case
      **/
     virtual IndexedDeclaration caseDeclaration(const QString& testCase) const = 0;
+
+    /**
+     * Whether this suite must not run concurrently with any other suite.
+     *
+     * The default implementation returns false.
+     **/
+    virtual bool runSerial() const;
+
+    /**
+     * Names of resources this suite needs exclusive access to.
+     * Suites sharing a resource lock are never run concurrently.
+     *
+     * The default implementation returns an empty list.
+     **/
+    virtual QStringList resourceLocks() const;
 };
 
 }
@@ -23,6 +23,7 @@
 
 #include <util/foregroundlock.h>
 #include <editor/modificationrevision.h>
+#include <duchain/includegraph.h>
 #include <serialization/indexedstring.h>
 #include <interfaces/icore.h>
 #include <interfaces/ilanguagecontroller.h>
@@ -222,7 +223,21 @@ void DocumentChangeTracker::textRemoved(Document* document, const KTextEditor::R
 
 void DocumentChangeTracker::documentSavedOrUploaded(KTextEditor::Document* doc, bool)
 {
-    ModificationRevision::clearModificationCache(IndexedString(doc->url()));
+    const IndexedString url(doc->url());
+    ModificationRevision::clearModificationCache(url);
+
+    // Reparse the open documents including the saved one, the closest ones first.
+    // Closed dependents are updated when they get opened or used, as their environment is outdated now.
+    // The include graph is kept up to date by the parse jobs, so this needs neither the DUChain lock nor any parsing.
+    const auto dependents = IncludeGraph::self().dependents(url);
+
+    auto* backgroundParser = ICore::self()->languageController()->backgroundParser();
+    for (const auto& dependent : qAsConst(dependents)) {
+        if (backgroundParser->trackerForUrl(dependent.file)) {
+            backgroundParser->addDocument(dependent.file, TopDUContext::AllDeclarationsContextsAndUses,
+                                          BackgroundParser::NormalPriority + dependent.distance);
+        }
+    }
 }
 
 void DocumentChangeTracker::documentDestroyed(QObject*)
@@ -360,6 +360,27 @@ void TestBackgroundparser::benchmarkDocumentChanges()
     doc->save();
 }
 
+void TestBackgroundparser::benchmarkLanguagesForUrl()
+{
+    // this is what parsing a whole project spends its time on before creating any job
+    const int files = 10000;
+
+    QVector<QUrl> urls;
+    urls.reserve(files);
+    for (int i = 0; i < files; ++i) {
+        urls << QUrl::fromLocalFile(QLatin1String("/some/project/dir") + QString::number(i % 100)
+                                    + QLatin1String("/file.name") + QString::number(i) + QLatin1String(".txt"));
+    }
+
+    auto* languageController = ICore::self()->languageController();
+    QBENCHMARK {
+        for (const QUrl& url : qAsConst(urls)) {
+            const auto languages = languageController->languagesForUrl(url);
+            QCOMPARE(languages.size(), 1);
+        }
+    }
+}
+
 // see also: https://bugs.kde.org/355100
 void TestBackgroundparser::testNoDeadlockInJobCreation()
 {
@@ -116,6 +116,8 @@ private Q_SLOTS:
 
     void benchmarkDocumentChanges();
 
+    void benchmarkLanguagesForUrl();
+
 private:
     JobPlan m_jobPlan;
     TestLanguageSupport* m_langSupport = nullptr;
@@ -35,8 +35,11 @@ ClassModelNodeDocumentChangedInterface::~ClassModelNodeDocumentChangedInterface(
 ClassModelNodesController::ClassModelNodesController()
     : m_updateTimer(new QTimer(this))
 {
+    // Changes within this interval are handled as one batch.
+    m_updateTimer->setInterval(2000);
     m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, &QTimer::timeout, this, &ClassModelNodesController::updateChangedFiles);
+    connect(DUChain::self(), &DUChain::updateReady, this, &ClassModelNodesController::documentUpdated);
 }
 
 ClassModelNodesController::~ClassModelNodesController()
@@ -61,13 +64,26 @@ void ClassModelNodesController::unregisterForChanges(const KDevelop::IndexedStri
     m_filesMap.remove(a_file, a_node);
 }
 
+void ClassModelNodesController::documentUpdated(const KDevelop::IndexedString& a_file,
+                                                const KDevelop::ReferencedTopDUContext&)
+{
+    if (!m_filesMap.contains(a_file))
+        return;
+
+    m_updatedFiles.insert(a_file);
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
 void ClassModelNodesController::updateChangedFiles()
 {
     // re-parse changed documents.
-    // TODO: m_updatedFiles seems no longer set, check again and remove if
     for (const IndexedString& file : qAsConst(m_updatedFiles)) {
         const auto values = m_filesMap.values(file);
         for (ClassModelNodeDocumentChangedInterface* value : values) {
+            // Updating a node may delete other nodes of the same file.
+            if (!m_filesMap.contains(file, value))
+                continue;
             value->documentChanged(file);
         }
     }
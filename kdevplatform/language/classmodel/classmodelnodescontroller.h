@@ -25,6 +25,7 @@
 #include <QObject>
 #include "../../serialization/indexedstring.h"
 #include "../duchain/ducontext.h"
+#include "../duchain/topducontext.h"
 
 class QTimer;
 
@@ -59,6 +60,7 @@ public:
 private Q_SLOTS:
     // Files update.
     void updateChangedFiles();
+    void documentUpdated(const KDevelop::IndexedString& a_file, const KDevelop::ReferencedTopDUContext& a_topContext);
 
 private: // File updates related.
     /// List of updated files we check this list when update timer expires.
@@ -39,28 +39,48 @@ using namespace ClassModelNodes;
 //////////////////////////////////////////////////////////////////////////////
 
 /// Contains a static list of classes within the namespace.
+/// The class nodes are only created once the folder gets expanded, until then
+/// the folder just counts the classes it will contain.
 class ClassModelNodes::StaticNamespaceFolderNode
     : public Node
 {
 public:
-    StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier, NodesModelInterface* a_model);
+    StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier, DocumentClassesFolder* a_folder,
+                              NodesModelInterface* a_model);
 
     /// Returns the qualified identifier for this node
     const KDevelop::QualifiedIdentifier& qualifiedIdentifier() const { return m_identifier; }
 
+    /// Returns true if the class nodes of this namespace have been created.
+    bool isMaterialized() const { return m_materialized; }
+
 public: // Node overrides
     bool getIcon(QIcon& a_resultIcon) override;
     int score() const override { return 101; }
+    void expand() override { m_folder->materializeNamespace(this); }
+    bool hasChildren() const override { return !m_children.empty() || m_hiddenClasses > 0; }
 
 private:
+    friend class DocumentClassesFolder;
+
     /// The namespace identifier.
     KDevelop::QualifiedIdentifier m_identifier;
+
+    /// The folder that knows about the classes in this namespace.
+    DocumentClassesFolder* m_folder;
+
+    /// Number of classes in this namespace that don't have a node yet.
+    int m_hiddenClasses = 0;
+
+    bool m_materialized = false;
 };
 
 StaticNamespaceFolderNode::StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier,
+                                                     DocumentClassesFolder* a_folder,
                                                      NodesModelInterface* a_model)
     : Node(a_identifier.last().toString(), a_model)
     , m_identifier(a_identifier)
+    , m_folder(a_folder)
 {
 }
 
@@ -75,9 +95,11 @@ bool StaticNamespaceFolderNode::getIcon(QIcon& a_resultIcon)
 
 DocumentClassesFolder::OpenedFileClassItem::OpenedFileClassItem(const KDevelop::IndexedString& a_file,
                                                                 const KDevelop::IndexedQualifiedIdentifier& a_classIdentifier,
+                                                                const KDevelop::IndexedQualifiedIdentifier& a_parentIdentifier,
                                                                 ClassModelNodes::ClassNode* a_nodeItem)
     : file(a_file)
     , classIdentifier(a_classIdentifier)
+    , parentIdentifier(a_parentIdentifier)
     , nodeItem(a_nodeItem)
 {
 }
@@ -87,16 +109,29 @@ DocumentClassesFolder::DocumentClassesFolder(const QString& a_displayName, Nodes
     , m_updateTimer(new QTimer(this))
 {
     // this is the required delay.
+    // All files updated within this interval are handled in one batch with a single re-sort.
     m_updateTimer->setInterval(2000);
+    m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, &QTimer::timeout, this, &DocumentClassesFolder::updateChangedFiles);
 }
 
+void DocumentClassesFolder::documentUpdated(const IndexedString& a_file, const ReferencedTopDUContext&)
+{
+    if (!m_openFiles.contains(a_file))
+        return;
+
+    m_updatedFiles.insert(a_file);
+
+    // Don't restart a running timer, so constant parsing can't postpone the update forever.
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
 void DocumentClassesFolder::updateChangedFiles()
 {
     bool hadChanges = false;
 
-    // re-parse changed documents.
-    // TODO: m_updatedFiles seems no longer set, check again and remove if
+    // re-parse changed documents, the code model is diffed against the known classes of each file.
     for (const IndexedString& file : qAsConst(m_updatedFiles)) {
         // Make sure it's one of the monitored files.
         if (m_openFiles.contains(file))
@@ -120,14 +155,16 @@ void DocumentClassesFolder::nodeCleared()
     m_openFiles.clear();
     m_openFilesClasses.clear();
 
-    // Stop the update timer.
+    // Stop the updates.
+    disconnect(DUChain::self(), &DUChain::updateReady, this, &DocumentClassesFolder::documentUpdated);
     m_updateTimer->stop();
+    m_updatedFiles.clear();
 }
 
 void DocumentClassesFolder::populateNode()
 {
-    // Start updates timer
-    m_updateTimer->start();
+    // Get notified about changes of the monitored files.
+    connect(DUChain::self(), &DUChain::updateReady, this, &DocumentClassesFolder::documentUpdated);
 }
 
 QSet<KDevelop::IndexedString> DocumentClassesFolder::allOpenDocuments() const
@@ -145,6 +182,16 @@ ClassNode* DocumentClassesFolder::findClassNode(const IndexedQualifiedIdentifier
     if (iter == m_openFilesClasses.get<ClassIdentifierIndex>().end())
         return nullptr;
 
+    // If the namespace folder was not expanded yet - create its class nodes now.
+    if (iter->nodeItem == nullptr) {
+        NamespacesMap::iterator namespaceIter = m_namespaces.find(iter->parentIdentifier);
+        if (namespaceIter != m_namespaces.end() && !(*namespaceIter)->isMaterialized()) {
+            materializeNamespace(*namespaceIter);
+            if (iter->nodeItem)
+                return iter->nodeItem;
+        }
+    }
+
     // If the node is invisible - make it visible by going over the identifiers list.
     if (iter->nodeItem == nullptr) {
         QualifiedIdentifier qualifiedIdentifier = a_id.identifier();
@@ -190,6 +237,8 @@ void DocumentClassesFolder::closeDocument(const IndexedString& a_file)
         {
             if (item.nodeItem)
                 removeClassNode(item.nodeItem);
+            else
+                removeHiddenClass(item.parentIdentifier);
         }
 
         // Clear the lists
@@ -262,10 +311,12 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
 
             // Where should we put this class?
             Node* parentNode = nullptr;
+            StaticNamespaceFolderNode* parentNamespace = nullptr;
+            QualifiedIdentifier parentIdentifier;
 
             // Check if it's namespaced and add it to the proper namespace.
             if (id.count() > 1) {
-                QualifiedIdentifier parentIdentifier(id.left(-1));
+                parentIdentifier = id.left(-1);
 
                 // Look up the namespace in the cache.
                 // If we fail to find it we assume that the parent context is a class
@@ -273,7 +324,7 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
                 NamespacesMap::iterator iter = m_namespaces.find(parentIdentifier);
                 if (iter != m_namespaces.end()) {
                     // Add to the namespace node.
-                    parentNode = iter.value();
+                    parentNamespace = iter.value();
                 } else
                 {
                     // Reaching here means we didn't encounter any namespace declaration in the document
@@ -292,7 +343,7 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
                             // See if it should be namespaced.
                             if (decls->declaration()->kind() == Declaration::Namespace) {
                                 // This should create the namespace folder and add it to the cache.
-                                parentNode = namespaceFolder(parentIdentifier);
+                                parentNamespace = namespaceFolder(parentIdentifier);
 
                                 // Add to the locally created namespaces.
                                 declaredNamespaces.insert(parentIdentifier);
@@ -302,6 +353,7 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
                         }
                     }
                 }
+                parentNode = parentNamespace;
             } else
             {
                 // Add to the main root.
@@ -309,28 +361,15 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
             }
 
             ClassNode* newNode = nullptr;
-            if (parentNode != nullptr) {
-                // Create the new node and add it.
-                IndexedDeclaration decl;
-                uint count = 0;
-                const IndexedDeclaration* declarations;
-                DUChainReadLocker lock;
-                PersistentSymbolTable::self().declarations(item.id, count, declarations);
-                for (uint i = 0; i < count; ++i) {
-                    if (declarations[i].indexedTopContext().url() == a_file) {
-                        decl = declarations[i];
-                        break;
-                    }
-                }
-
-                if (decl.isValid()) {
-                    newNode = new ClassNode(decl.declaration(), m_model);
-                    parentNode->addNode(newNode);
-                }
+            if (parentNamespace && !parentNamespace->isMaterialized()) {
+                // The node gets created once the namespace folder is expanded.
+                ++parentNamespace->m_hiddenClasses;
+            } else if (parentNode != nullptr) {
+                newNode = createClassNode(a_file, item.id, parentNode);
             }
 
             // Insert it to the map - newNode can be 0 - meaning the class is hidden.
-            m_openFilesClasses.insert(OpenedFileClassItem(a_file, id, newNode));
+            m_openFilesClasses.insert(OpenedFileClassItem(a_file, id, parentIdentifier, newNode));
             documentChanged = true;
         }
     }
@@ -347,6 +386,8 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
     for (const FileIterator item : qAsConst(removedClasses)) {
         if (item->nodeItem)
             removeClassNode(item->nodeItem);
+        else
+            removeHiddenClass(item->parentIdentifier);
         m_openFilesClasses.get<FileIndex>().erase(item);
         documentChanged = true;
     }
@@ -363,6 +404,67 @@ void DocumentClassesFolder::parseDocument(const IndexedString& a_file)
     updateDocument(a_file);
 }
 
+ClassNode* DocumentClassesFolder::createClassNode(const IndexedString& a_file, const IndexedQualifiedIdentifier& a_id,
+                                                  Node* a_parentNode)
+{
+    IndexedDeclaration decl;
+    uint count = 0;
+    const IndexedDeclaration* declarations;
+    DUChainReadLocker lock;
+    PersistentSymbolTable::self().declarations(a_id, count, declarations);
+    for (uint i = 0; i < count; ++i) {
+        if (declarations[i].indexedTopContext().url() == a_file) {
+            decl = declarations[i];
+            break;
+        }
+    }
+
+    if (!decl.isValid())
+        return nullptr;
+
+    auto* newNode = new ClassNode(decl.declaration(), m_model);
+    a_parentNode->addNode(newNode);
+    return newNode;
+}
+
+void DocumentClassesFolder::materializeNamespace(StaticNamespaceFolderNode* a_node)
+{
+    if (a_node->m_materialized)
+        return;
+
+    a_node->m_materialized = true;
+    a_node->m_hiddenClasses = 0;
+
+    bool hadChanges = false;
+    std::pair<ParentIdentifierIterator, ParentIdentifierIterator> range =
+        m_openFilesClasses.get<ParentIdentifierIndex>().equal_range(IndexedQualifiedIdentifier(a_node->qualifiedIdentifier()));
+    for (ParentIdentifierIterator iter = range.first; iter != range.second; ++iter) {
+        if (iter->nodeItem)
+            continue;
+
+        ClassNode* newNode = createClassNode(iter->file, iter->classIdentifier, a_node);
+        if (newNode) {
+            m_openFilesClasses.get<ParentIdentifierIndex>().modify(iter, [newNode](OpenedFileClassItem& item) {
+                item.nodeItem = newNode;
+            });
+            hadChanges = true;
+        }
+    }
+
+    if (hadChanges)
+        a_node->recursiveSort();
+}
+
+void DocumentClassesFolder::removeHiddenClass(const IndexedQualifiedIdentifier& a_parentIdentifier)
+{
+    NamespacesMap::iterator iter = m_namespaces.find(a_parentIdentifier);
+    if (iter == m_namespaces.end() || (*iter)->isMaterialized())
+        return;
+
+    --(*iter)->m_hiddenClasses;
+    removeEmptyNamespace((*iter)->qualifiedIdentifier());
+}
+
 void DocumentClassesFolder::removeClassNode(ClassModelNodes::ClassNode* a_node)
 {
     // Get the parent namespace identifier.
@@ -413,7 +515,7 @@ StaticNamespaceFolderNode* DocumentClassesFolder::namespaceFolder(const KDevelop
 
         // Create the new node.
         auto* newNode =
-            new StaticNamespaceFolderNode(a_identifier, m_model);
+            new StaticNamespaceFolderNode(a_identifier, this, m_model);
         parentNode->addNode(newNode);
 
         // Add it to the cache.
@@ -23,6 +23,7 @@
 #define KDEVPLATFORM_DOCUMENTCLASSESFOLDER_H
 
 #include "classmodelnode.h"
+#include "../duchain/topducontext.h"
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -69,6 +70,7 @@ public: // Node overrides
 private Q_SLOTS:
     // Files update.
     void updateChangedFiles();
+    void documentUpdated(const KDevelop::IndexedString& a_file, const KDevelop::ReferencedTopDUContext& a_topContext);
 
 private: // File updates related.
     /// List of updated files we check this list when update timer expires.
@@ -84,6 +86,7 @@ private: // Opened class identifiers container definition.
         OpenedFileClassItem();
         OpenedFileClassItem(const KDevelop::IndexedString& a_file,
                             const KDevelop::IndexedQualifiedIdentifier& a_classIdentifier,
+                            const KDevelop::IndexedQualifiedIdentifier& a_parentIdentifier,
                             ClassNode* a_nodeItem);
 
         /// The file this class declaration comes from.
@@ -92,13 +95,18 @@ private: // Opened class identifiers container definition.
         /// The identifier for this class.
         KDevelop::IndexedQualifiedIdentifier classIdentifier;
 
-        /// An existing node item. It maybe 0 - meaning the class node is currently hidden.
+        /// The identifier of the enclosing scope, empty for global classes.
+        KDevelop::IndexedQualifiedIdentifier parentIdentifier;
+
+        /// An existing node item. It maybe 0 - meaning the class node is currently hidden
+        /// or its namespace folder has not been expanded yet.
         ClassNode* nodeItem;
     };
 
     // Index definitions.
     struct FileIndex {};
     struct ClassIdentifierIndex {};
+    struct ParentIdentifierIndex {};
 
     // Member types definitions.
     using FileMember = boost::multi_index::member<
@@ -109,6 +117,10 @@ private: // Opened class identifiers container definition.
         OpenedFileClassItem,
         KDevelop::IndexedQualifiedIdentifier,
         & OpenedFileClassItem::classIdentifier>;
+    using ParentIdentifierMember = boost::multi_index::member<
+        OpenedFileClassItem,
+        KDevelop::IndexedQualifiedIdentifier,
+        & OpenedFileClassItem::parentIdentifier>;
 
     // Container definition.
     using OpenFilesContainer = boost::multi_index::multi_index_container<
@@ -121,6 +133,10 @@ private: // Opened class identifiers container definition.
             boost::multi_index::ordered_unique<
                 boost::multi_index::tag<ClassIdentifierIndex>,
                 ClassIdentifierMember
+            >,
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<ParentIdentifierIndex>,
+                ParentIdentifierMember
             >
         >
     >;
@@ -128,6 +144,7 @@ private: // Opened class identifiers container definition.
     // Iterators definition.
     using FileIterator = OpenFilesContainer::index_iterator<FileIndex>::type;
     using ClassIdentifierIterator = OpenFilesContainer::index_iterator<ClassIdentifierIndex>::type;
+    using ParentIdentifierIterator = OpenFilesContainer::index_iterator<ParentIdentifierIndex>::type;
 
     /// Maps all displayed classes and their referenced files.
     OpenFilesContainer m_openFilesClasses;
@@ -136,6 +153,8 @@ private: // Opened class identifiers container definition.
     QSet<KDevelop::IndexedString> m_openFiles;
 
 private:
+    friend class StaticNamespaceFolderNode;
+
     using NamespacesMap = QMap<KDevelop::IndexedQualifiedIdentifier, StaticNamespaceFolderNode*>;
     /// Holds a map between an identifier and a namespace folder we hold.
     NamespacesMap m_namespaces;
@@ -149,6 +168,17 @@ private:
 
     /// Remove a single class node from the lists.
     void removeClassNode(ClassNode* a_node);
+
+    /// Forget a class that was never materialized in the namespace @p a_parentIdentifier.
+    void removeHiddenClass(const KDevelop::IndexedQualifiedIdentifier& a_parentIdentifier);
+
+    /// Create the class nodes of a namespace folder, this is deferred until the folder gets expanded.
+    void materializeNamespace(StaticNamespaceFolderNode* a_node);
+
+    /// Look up the declaration of the class @p a_id in @p a_file and add a node for it to @p a_parentNode.
+    /// @return the new node or 0 if the declaration could not be found.
+    ClassNode* createClassNode(const KDevelop::IndexedString& a_file,
+                               const KDevelop::IndexedQualifiedIdentifier& a_id, Node* a_parentNode);
 };
 } // namespace ClassModelNodes
 
@@ -40,6 +40,8 @@ ProjectFolder::ProjectFolder(NodesModelInterface* a_model)
 
 void ProjectFolder::populateNode()
 {
+    DocumentClassesFolder::populateNode();
+
     const auto files = m_project->fileSet();
     for (const IndexedString& file : files) {
         parseDocument(file);
@@ -19,6 +19,7 @@
 #include "coderepresentation.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <KTextEditor/Document>
 
 #include <serialization/indexedstring.h>
@@ -46,7 +47,7 @@ QString CodeRepresentation::rangeText(const KTextEditor::Range& range) const
     return rangedText;
 }
 
-static void grepLine(const QString& identifier, const QString& lineText, int lineNumber,
+static void grepLine(const QString& identifier, const QStringRef& lineText, int lineNumber,
                      QVector<KTextEditor::Range>& ret, bool surroundedByBoundary)
 {
     if (identifier.isEmpty())
@@ -86,8 +87,10 @@ public:
         if (identifier.isEmpty())
             return ret;
 
-        for (int line = 0; line < m_document->lines(); ++line)
-            grepLine(identifier, m_document->line(line), line, ret, surroundedByBoundary);
+        for (int line = 0; line < m_document->lines(); ++line) {
+            const QString lineText = m_document->line(line);
+            grepLine(identifier, QStringRef(&lineText), line, ret, surroundedByBoundary);
+        }
 
         return ret;
     }
@@ -170,17 +173,14 @@ public:
         QFile file(localFile);
         if (file.open(QIODevice::ReadOnly)) {
             data = QString::fromLocal8Bit(file.readAll());
-            lineData = data.split(QLatin1Char('\n'));
+            indexLines();
         }
         m_exists = file.exists();
     }
 
     QString line(int line) const override
     {
-        if (line < 0 || line >= lineData.size())
-            return QString();
-
-        return lineData.at(line);
+        return lineRef(line).toString();
     }
 
     QVector<KTextEditor::Range> grep(const QString& identifier, bool surroundedByBoundary) const override
@@ -190,15 +190,15 @@ public:
         if (identifier.isEmpty())
             return ret;
 
-        for (int line = 0; line < lineData.count(); ++line)
-            grepLine(identifier, lineData.at(line), line, ret, surroundedByBoundary);
+        for (int line = 0; line < lineOffsets.count(); ++line)
+            grepLine(identifier, lineRef(line), line, ret, surroundedByBoundary);
 
         return ret;
     }
 
     int lines() const override
     {
-        return lineData.count();
+        return lineOffsets.count();
     }
 
     QString text() const override
@@ -206,16 +206,26 @@ public:
         return data;
     }
 
+    QString rangeText(const KTextEditor::Range& range) const override
+    {
+        // lines are separated by a single '\n', so the range maps onto one contiguous piece of the text
+        const int start = offset(range.start());
+        const int end = offset(range.end());
+        return (end > start) ? data.mid(start, end - start) : QString();
+    }
+
     bool setText(const QString& text) override
     {
         Q_ASSERT(!onDiskChangesForbidden);
         QString localFile(m_document.toUrl().toLocalFile());
 
-        QFile file(localFile);
+        // write to a temporary file and rename it over the original, so the file
+        // is either fully updated or left untouched
+        QSaveFile file(localFile);
         if (file.open(QIODevice::WriteOnly)) {
             QByteArray data = text.toLocal8Bit();
 
-            if (file.write(data) == data.size()) {
+            if (file.write(data) == data.size() && file.commit()) {
                 ModificationRevision::clearModificationCache(m_document);
                 return true;
             }
@@ -229,10 +239,40 @@ public:
     }
 
 private:
-    //We use QByteArray, because the column-numbers are measured in utf-8
+    void indexLines()
+    {
+        lineOffsets.clear();
+        lineOffsets.append(0);
+        for (int pos = data.indexOf(QLatin1Char('\n')); pos != -1; pos = data.indexOf(QLatin1Char('\n'), pos + 1)) {
+            lineOffsets.append(pos + 1);
+        }
+    }
+
+    /// Offset of @p cursor in the text, with the line and the column clamped to the existing text like in CodeRepresentation::rangeText()
+    int offset(const KTextEditor::Cursor& cursor) const
+    {
+        if (lineOffsets.isEmpty() || cursor.line() < 0)
+            return 0;
+        if (cursor.line() >= lineOffsets.size())
+            return data.size();
+
+        return lineOffsets.at(cursor.line()) + qBound(0, cursor.column(), lineRef(cursor.line()).size());
+    }
+
+    QStringRef lineRef(int line) const
+    {
+        if (line < 0 || line >= lineOffsets.size())
+            return QStringRef();
+
+        const int start = lineOffsets.at(line);
+        const int end = (line + 1 < lineOffsets.size()) ? lineOffsets.at(line + 1) - 1 : data.size();
+        return data.midRef(start, end - start);
+    }
+
     IndexedString m_document;
     bool m_exists;
-    QStringList lineData;
+    // Offsets of the line starts in data, lines are only materialized on request
+    QVector<int> lineOffsets;
     QString data;
 };
 
@@ -310,7 +350,7 @@ public:
             return ret;
 
         for (int line = 0; line < data->lines().count(); ++line)
-            grepLine(identifier, data->lines().at(line), line, ret, surroundedByBoundary);
+            grepLine(identifier, QStringRef(&data->lines().at(line)), line, ret, surroundedByBoundary);
 
         return ret;
     }
@@ -352,7 +392,12 @@ CodeRepresentation::Ptr createCodeRepresentation(const IndexedString& path)
     if (document && document->textDocument())
         return CodeRepresentation::Ptr(new EditorCodeRepresentation(document->textDocument()));
     else
-        return CodeRepresentation::Ptr(new FileCodeRepresentation(path));
+        return createFileCodeRepresentation(path);
+}
+
+CodeRepresentation::Ptr createFileCodeRepresentation(const IndexedString& path)
+{
+    return CodeRepresentation::Ptr(new FileCodeRepresentation(path));
 }
 
 void CodeRepresentation::setDiskChangesForbidden(bool changesForbidden)
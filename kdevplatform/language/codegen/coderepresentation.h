@@ -157,6 +157,12 @@ public:
  */
 KDEVPLATFORMLANGUAGE_EXPORT CodeRepresentation::Ptr createCodeRepresentation(const IndexedString& url);
 
+/**
+ * Creates a code-representation that reads @p url from disk, even if the document is open in an editor.
+ * Unlike createCodeRepresentation(), this does not access the document controller and may be called from any thread.
+ */
+KDEVPLATFORMLANGUAGE_EXPORT CodeRepresentation::Ptr createFileCodeRepresentation(const IndexedString& url);
+
 /**
  * @return true if an artificial code representation already exists for the specified URL
  */
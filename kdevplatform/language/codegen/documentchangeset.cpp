@@ -25,6 +25,8 @@
 
 #include <QStringList>
 #include <QMimeDatabase>
+#include <QMutex>
+#include <QtConcurrentMap>
 
 #include <KLocalizedString>
 
@@ -64,31 +66,79 @@ public:
     ChangesHash changes;
     QHash<IndexedString, IndexedString> documentsRename;
 
+    /// Everything needed to compute the new contents of a single file
+    struct FileChanges
+    {
+        IndexedString file;
+        /// Null for files that are neither open nor artificial, those are read on the worker thread
+        CodeRepresentation::Ptr repr;
+        /// Snapshot of the current text, taken on the main thread for open documents and artificial code
+        QString text;
+        ISourceFormatter* formatter = nullptr;
+        QMimeType mime;
+        ChangesList sortedChanges;
+        QString newText;
+        DocumentChangeSet::ChangeResult result = DocumentChangeSet::ChangeResult::successfulResult();
+    };
+
     DocumentChangeSet::ChangeResult addChange(const DocumentChangePointer& change);
     DocumentChangeSet::ChangeResult replaceOldText(CodeRepresentation* repr, const QString& newText,
                                                    const ChangesList& sortedChangesList);
     DocumentChangeSet::ChangeResult generateNewText(const IndexedString& file,
                                                     ChangesList& sortedChanges,
-                                                    const CodeRepresentation* repr,
-                                                    QString& output);
+                                                    const QString& text,
+                                                    ISourceFormatter* formatter,
+                                                    const QMimeType& mime,
+                                                    QString& output) const;
     DocumentChangeSet::ChangeResult removeDuplicates(const IndexedString& file,
-                                                     ChangesList& filteredChanges);
+                                                     ChangesList& filteredChanges) const;
+    /// Thread-safe, called concurrently for all files of the change set
+    void processFile(FileChanges& fileChanges) const;
     void formatChanges();
     void updateFiles();
 };
 
 // Simple helpers to clear up code clutter
 namespace {
-inline bool changeIsValid(const DocumentChange& change, const QStringList& textLines)
+/// Offsets of the line starts within a text, used to address ranges without splitting the text into lines
+class LineIndex
 {
-    return change.m_range.start() <= change.m_range.end() &&
-           change.m_range.end().line() < textLines.size() &&
-           change.m_range.start().line() >= 0 &&
-           change.m_range.start().column() >= 0 &&
-           change.m_range.start().column() <= textLines[change.m_range.start().line()].length() &&
-           change.m_range.end().column() >= 0 &&
-           change.m_range.end().column() <= textLines[change.m_range.end().line()].length();
-}
+public:
+    explicit LineIndex(const QString& text)
+        : m_textLength(text.length())
+    {
+        m_offsets.append(0);
+        for (int pos = text.indexOf(QLatin1Char('\n')); pos != -1; pos = text.indexOf(QLatin1Char('\n'), pos + 1)) {
+            m_offsets.append(pos + 1);
+        }
+    }
+
+    int lineLength(int line) const
+    {
+        const int end = (line + 1 < m_offsets.size()) ? m_offsets[line + 1] - 1 : m_textLength;
+        return end - m_offsets[line];
+    }
+
+    int offset(const KTextEditor::Cursor& cursor) const
+    {
+        return m_offsets[cursor.line()] + cursor.column();
+    }
+
+    bool isValid(const KTextEditor::Range& range) const
+    {
+        return range.start() <= range.end() &&
+               range.end().line() < m_offsets.size() &&
+               range.start().line() >= 0 &&
+               range.start().column() >= 0 &&
+               range.start().column() <= lineLength(range.start().line()) &&
+               range.end().column() >= 0 &&
+               range.end().column() <= lineLength(range.end().line());
+    }
+
+private:
+    QVector<int> m_offsets;
+    int m_textLength;
+};
 
 inline bool duplicateChanges(const DocumentChangePointer& previous, const DocumentChangePointer& current)
 {
@@ -100,26 +150,6 @@ inline bool duplicateChanges(const DocumentChangePointer& previous, const Docume
             (previous->m_ignoreOldText && current->m_ignoreOldText));
 }
 
-inline QString rangeText(const KTextEditor::Range& range, const QStringList& textLines)
-{
-    QStringList ret;
-    ret.reserve(range.end().line() - range.start().line() + 1);
-    for (int line = range.start().line(); line <= range.end().line(); ++line) {
-        const QString lineText = textLines.at(line);
-        int startColumn = 0;
-        int endColumn = lineText.length();
-        if (line == range.start().line()) {
-            startColumn = range.start().column();
-        }
-        if (line == range.end().line()) {
-            endColumn = range.end().column();
-        }
-        ret << lineText.mid(startColumn, endColumn - startColumn);
-    }
-
-    return ret.join(QLatin1Char('\n'));
-}
-
 // need to have it as otherwise the arguments can exceed the maximum of 10
 static QString printRange(const KTextEditor::Range& r)
 {
@@ -127,6 +157,9 @@ static QString printRange(const KTextEditor::Range& r)
                  r.start().line(), r.start().column(),
                  r.end().line(), r.end().column());
 }
+
+// Source formatters keep internal state and are not guaranteed to be reentrant
+QMutex formatterMutex;
 }
 
 DocumentChangeSet::DocumentChangeSet()
@@ -280,33 +313,47 @@ DocumentChangeSet::ChangeResult DocumentChangeSet::applyAllChanges()
         }
     }
 
-    QMap<IndexedString, CodeRepresentation::Ptr> codeRepresentations;
-    QMap<IndexedString, QString> newTexts;
-    ChangesHash filteredSortedChanges;
-    ChangeResult result = ChangeResult::successfulResult();
-
     const QList<IndexedString> files(d->changes.keys());
 
+    // Open documents and artificial code can only be accessed from the main thread, everything
+    // else is read, validated and rewritten concurrently below
+    QVector<DocumentChangeSetPrivate::FileChanges> fileChanges;
+    fileChanges.reserve(files.size());
+    auto* core = ICore::self();
     for (const IndexedString& file : files) {
-        CodeRepresentation::Ptr repr = createCodeRepresentation(file);
-        if (!repr) {
-            return ChangeResult(QStringLiteral("Could not create a Representation for %1").arg(file.str()));
+        DocumentChangeSetPrivate::FileChanges changes;
+        changes.file = file;
+        const QUrl url = file.toUrl();
+        if (artificialCodeRepresentationExists(file) || (core && core->documentController()->documentForUrl(url))) {
+            changes.repr = createCodeRepresentation(file);
+            if (!changes.repr) {
+                return ChangeResult(QStringLiteral("Could not create a Representation for %1").arg(file.str()));
+            }
+            changes.text = changes.repr->text();
+        }
+        if (core && d->formatPolicy != NoAutoFormat) {
+            changes.mime = QMimeDatabase().mimeTypeForUrl(url);
+            changes.formatter = core->sourceFormatterController()->formatterForUrl(url, changes.mime);
         }
+        fileChanges.append(changes);
+    }
 
-        codeRepresentations[file] = repr;
+    QtConcurrent::blockingMap(fileChanges, [d](DocumentChangeSetPrivate::FileChanges& changes) {
+        d->processFile(changes);
+    });
 
-        QList<DocumentChangePointer>& sortedChangesList(filteredSortedChanges[file]);
-        {
-            result = d->removeDuplicates(file, sortedChangesList);
-            if (!result)
-                return result;
-        }
+    QMap<IndexedString, CodeRepresentation::Ptr> codeRepresentations;
+    QMap<IndexedString, QString> newTexts;
+    ChangesHash filteredSortedChanges;
+    ChangeResult result = ChangeResult::successfulResult();
 
-        {
-            result = d->generateNewText(file, sortedChangesList, repr.data(), newTexts[file]);
-            if (!result)
-                return result;
+    for (const auto& changes : qAsConst(fileChanges)) {
+        if (!changes.result) {
+            return changes.result;
         }
+        codeRepresentations[changes.file] = changes.repr;
+        newTexts[changes.file] = changes.newText;
+        filteredSortedChanges[changes.file] = changes.sortedChanges;
     }
 
     QMap<IndexedString, QString> oldTexts;
@@ -391,40 +438,65 @@ DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::replaceOldText(CodeRep
     return DocumentChangeSet::ChangeResult::successfulResult();
 }
 
-DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::generateNewText(const IndexedString& file,
-                                                                          ChangesList& sortedChanges,
-                                                                          const CodeRepresentation* repr,
-                                                                          QString& output)
+void DocumentChangeSetPrivate::processFile(FileChanges& fileChanges) const
 {
-    //Create the actual new modified file
-    QStringList textLines = repr->text().split(QLatin1Char('\n'));
+    // Only files on disk are read here, the representations of open documents must not be touched off the main thread
+    if (!fileChanges.repr) {
+        fileChanges.repr = createFileCodeRepresentation(fileChanges.file);
+        fileChanges.text = fileChanges.repr->text();
+    }
 
-    QUrl url = file.toUrl();
+    fileChanges.result = removeDuplicates(fileChanges.file, fileChanges.sortedChanges);
+    if (!fileChanges.result)
+        return;
 
-    QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
+    fileChanges.result = generateNewText(fileChanges.file, fileChanges.sortedChanges, fileChanges.text,
+                                         fileChanges.formatter, fileChanges.mime, fileChanges.newText);
+}
+
+DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::generateNewText(const IndexedString& file,
+                                                                          ChangesList& sortedChanges,
+                                                                          const QString& text,
+                                                                          ISourceFormatter* formatter,
+                                                                          const QMimeType& mime,
+                                                                          QString& output) const
+{
+    const LineIndex lineIndex(text);
 
-    auto core = ICore::self();
-    ISourceFormatter* formatter = core ? core->sourceFormatterController()->formatterForUrl(file.toUrl(), mime) : nullptr;
+    const bool format = formatter && (formatPolicy == DocumentChangeSet::AutoFormatChanges
+                                      || formatPolicy == DocumentChangeSet::AutoFormatChangesKeepIndentation);
+    const QUrl url = file.toUrl();
 
-    QVector<int> removedLines;
+    // The changes are sorted and do not intersect, so the new text is assembled from the unchanged
+    // pieces of the old text and the replacements of all changes that could be applied
+    QVector<bool> applied(sortedChanges.size(), false);
+    // The already rewritten text behind the current change, only needed as context for the formatter
+    QString rightTail;
+    int rightTailStart = text.length();
 
     for (int pos = sortedChanges.size() - 1; pos >= 0; --pos) {
         DocumentChange& change(*sortedChanges[pos]);
         QString encountered;
-        if (changeIsValid(change, textLines)  && //We demand this, although it should be fixed
-            ((encountered = rangeText(change.m_range, textLines)) == change.m_oldText || change.m_ignoreOldText)) {
-            ///Problem: This does not work if the other changes significantly alter the context @todo Use the changed context
-            QString leftContext = QStringList(textLines.mid(0, change.m_range.start().line() + 1)).join(QLatin1Char(
-                                                                                                            '\n'));
-            leftContext.chop(textLines[change.m_range.start().line()].length() - change.m_range.start().column());
-
-            QString rightContext = QStringList(textLines.mid(change.m_range.end().line())).join(QLatin1Char('\n')).mid(
-                change.m_range.end().column());
-
-            if (formatter && (formatPolicy == DocumentChangeSet::AutoFormatChanges
-                              || formatPolicy == DocumentChangeSet::AutoFormatChangesKeepIndentation)) {
+        const bool valid = lineIndex.isValid(change.m_range);
+        if (valid) {
+            const int start = lineIndex.offset(change.m_range.start());
+            encountered = text.mid(start, lineIndex.offset(change.m_range.end()) - start);
+        }
+        if (valid  && //We demand this, although it should be fixed
+            (encountered == change.m_oldText || change.m_ignoreOldText)) {
+            const int startOffset = lineIndex.offset(change.m_range.start());
+            const int endOffset = lineIndex.offset(change.m_range.end());
+
+            if (format) {
+                ///Problem: This does not work if the other changes significantly alter the context @todo Use the changed context
+                const QString leftContext = text.left(startOffset);
+                const QString rightContext = text.mid(endOffset, rightTailStart - endOffset) + rightTail;
+
                 QString oldNewText = change.m_newText;
-                change.m_newText = formatter->formatSource(change.m_newText, url, mime, leftContext, rightContext);
+                {
+                    QMutexLocker lock(&formatterMutex);
+                    change.m_newText = formatter->formatSource(change.m_newText, url, mime, leftContext, rightContext);
+                }
 
                 if (formatPolicy == DocumentChangeSet::AutoFormatChangesKeepIndentation) {
                     // Reproduce the previous indentation
@@ -462,27 +534,13 @@ DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::generateNewText(const
                             oldNewText;
                     }
                 }
-            }
 
-            QString& line = textLines[change.m_range.start().line()];
-            if (change.m_range.start().line() == change.m_range.end().line()) {
-                // simply replace existing line content
-                line.replace(change.m_range.start().column(),
-                             change.m_range.end().column() - change.m_range.start().column(),
-                             change.m_newText);
-            } else {
-                // replace first line contents
-                line.replace(change.m_range.start().column(), line.length() - change.m_range.start().column(),
-                             change.m_newText);
-                // null other lines and remember for deletion
-                const int firstLine = change.m_range.start().line() + 1;
-                const int lastLine = change.m_range.end().line();
-                removedLines.reserve(removedLines.size() + lastLine - firstLine + 1);
-                for (int i = firstLine; i <= lastLine; ++i) {
-                    textLines[i].clear();
-                    removedLines << i;
-                }
+                rightTail.prepend(text.midRef(endOffset, rightTailStart - endOffset));
+                rightTail.prepend(change.m_newText);
+                rightTailStart = startOffset;
             }
+
+            applied[pos] = true;
         } else {
             QString warningString = i18nc("Inconsistent change in <document> at <range>"
                                           " = <oldText> (encountered <encountered>) -> <newText>",
@@ -504,26 +562,31 @@ DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::generateNewText(const
         }
     }
 
-    if (!removedLines.isEmpty()) {
-        int offset = 0;
-        std::sort(removedLines.begin(), removedLines.end());
-        for (int l : qAsConst(removedLines)) {
-            textLines.removeAt(l - offset);
-            ++offset;
-        }
+    output.clear();
+    output.reserve(text.length());
+    int copiedUntil = 0;
+    for (int pos = 0; pos < sortedChanges.size(); ++pos) {
+        if (!applied[pos])
+            continue;
+        const DocumentChange& change(*sortedChanges[pos]);
+        const int startOffset = lineIndex.offset(change.m_range.start());
+        output += text.midRef(copiedUntil, startOffset - copiedUntil);
+        output += change.m_newText;
+        copiedUntil = lineIndex.offset(change.m_range.end());
     }
-    output = textLines.join(QLatin1Char('\n'));
+    output += text.midRef(copiedUntil);
     return DocumentChangeSet::ChangeResult::successfulResult();
 }
 
 //Removes all duplicate changes for a single file, and then returns (via filteredChanges) the filtered duplicates
 DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::removeDuplicates(const IndexedString& file,
-                                                                           ChangesList& filteredChanges)
+                                                                           ChangesList& filteredChanges) const
 {
     using ChangesMap = QMultiMap<KTextEditor::Cursor, DocumentChangePointer>;
     ChangesMap sortedChanges;
 
-    for (const DocumentChangePointer& change : qAsConst(changes[file])) {
+    const ChangesList fileChanges = changes.value(file);
+    for (const DocumentChangePointer& change : fileChanges) {
         sortedChanges.insert(change->m_range.end(), change);
     }
 
@@ -594,14 +657,19 @@ void DocumentChangeSetPrivate::updateFiles()
 
         // If there are currently open documents that now need an update, update them too
         const auto documents = ICore::self()->languageController()->backgroundParser()->managedDocuments();
-        for (const IndexedString& doc : documents) {
+        QVector<IndexedString> outdatedDocuments;
+        {
             DUChainReadLocker lock(DUChain::lock());
-            TopDUContext* top = DUChainUtils::standardContextForUrl(doc.toUrl(), true);
-            if ((top && top->parsingEnvironmentFile() && top->parsingEnvironmentFile()->needsUpdate()) || !top) {
-                lock.unlock();
-                ICore::self()->languageController()->backgroundParser()->addDocument(doc);
+            for (const IndexedString& doc : documents) {
+                TopDUContext* top = DUChainUtils::standardContextForUrl(doc.toUrl(), true);
+                if ((top && top->parsingEnvironmentFile() && top->parsingEnvironmentFile()->needsUpdate()) || !top) {
+                    outdatedDocuments.append(doc);
+                }
             }
         }
+        for (const IndexedString& doc : qAsConst(outdatedDocuments)) {
+            ICore::self()->languageController()->backgroundParser()->addDocument(doc);
+        }
 
         // Eventually update _all_ affected files
         const auto files = changes.keys();
@@ -21,6 +21,7 @@
 
 #include "test_documentchangeset.h"
 
+#include <language/codegen/coderepresentation.h>
 #include <language/codegen/documentchangeset.h>
 
 #include <tests/testcore.h>
@@ -72,3 +73,49 @@ void TestDocumentchangeset::testReplaceSameLine()
     QVERIFY(result);
 }
 
+void TestDocumentchangeset::testReplaceMultipleFiles()
+{
+    QVector<TestFile*> files;
+    DocumentChangeSet changes;
+    changes.setFormatPolicy(DocumentChangeSet::NoAutoFormat);
+    for (int i = 0; i < 20; ++i) {
+        auto* file = new TestFile(QStringLiteral("int a;\nint b;\nint c;\n"), QStringLiteral("cpp"));
+        files << file;
+        // multi-line change
+        changes.addChange(
+            DocumentChange(
+                file->url(),
+                KTextEditor::Range(0, 4, 1, 5),
+                QStringLiteral("a;\nint b"), QStringLiteral("ab")
+        ));
+        // pure insertion
+        changes.addChange(
+            DocumentChange(
+                file->url(),
+                KTextEditor::Range(2, 0, 2, 0),
+                QString(), QStringLiteral("const ")
+        ));
+    }
+
+    DocumentChangeSet::ChangeResult result = changes.applyAllChanges();
+    QVERIFY2(result, qPrintable(result.m_failureReason));
+
+    for (TestFile* file : qAsConst(files)) {
+        QCOMPARE(file->fileContents(), QStringLiteral("int ab;\nconst int c;\n"));
+    }
+    qDeleteAll(files);
+}
+
+void TestDocumentchangeset::testFileRangeText()
+{
+    TestFile file(QStringLiteral("int a;\nint b;"), QStringLiteral("cpp"));
+    CodeRepresentation::Ptr repr = createFileCodeRepresentation(IndexedString(file.url()));
+    QCOMPARE(repr->rangeText(KTextEditor::Range(0, 4, 1, 3)), QStringLiteral("a;\nint"));
+    // columns behind the end of a line must not reach into the following line
+    QCOMPARE(repr->rangeText(KTextEditor::Range(0, 4, 0, 20)), QStringLiteral("a;"));
+    QCOMPARE(repr->rangeText(KTextEditor::Range(0, 20, 1, 3)), QStringLiteral("\nint"));
+
+    CodeRepresentation::Ptr missing = createFileCodeRepresentation(IndexedString(QStringLiteral("/does/not/exist.cpp")));
+    QCOMPARE(missing->lines(), 0);
+    QVERIFY(missing->rangeText(KTextEditor::Range(0, 0, 0, 3)).isEmpty());
+}
@@ -32,6 +32,8 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testReplaceSameLine();
+    void testReplaceMultipleFiles();
+    void testFileRangeText();
 };
 
 #endif // TESTDOCUMENTCHANGESET_H
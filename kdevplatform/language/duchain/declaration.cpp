@@ -232,9 +232,20 @@ void Declaration::setIdentifier(const Identifier& identifier)
 
     d->m_identifier = identifier;
 
+    if (m_context)
+        m_context->m_dynamicData->invalidateIdentifierIndex();
+
     setInSymbolTable(wasInSymbolTable);
 }
 
+void Declaration::setRange(const RangeInRevision& range)
+{
+    DUChainBase::setRange(range);
+
+    if (m_context)
+        m_context->m_dynamicData->invalidateDeclarationRangeIndex();
+}
+
 IndexedType Declaration::indexedType() const
 {
     return d_func()->m_type;
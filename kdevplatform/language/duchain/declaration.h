@@ -342,6 +342,11 @@ public:
      */
     void setIdentifier(const Identifier& identifier);
 
+    /**
+     * Changes the range of this declaration, keeping the lookups by position in its context up to date.
+     */
+    void setRange(const RangeInRevision& range) override;
+
     /**
      * Access this declaration's \a identifier.
      *
@@ -60,6 +60,7 @@
 #include "serialization/itemrepository.h"
 #include "waitforupdate.h"
 #include "importers.h"
+#include "includegraph.h"
 
 #if HAVE_MALLOC_TRIM
 #include "malloc.h"
@@ -805,7 +806,7 @@ public:
         }
 
         QTime startTime = QTime::currentTime();
-        PersistentSymbolTable::self().clearCache();
+        PersistentSymbolTable::self().trimCache();
 
         storeAllInformation(!retries, writeLock); //Puts environment-information into a repository
 
@@ -943,6 +944,7 @@ unloadContexts:
             ///@todo Solve this more elegantly, using a general mechanism to store static duchain-like data
             Q_ASSERT(ParsingEnvironmentFile::m_staticData);
             QFile f(globalItemRepositoryRegistry().path() + QLatin1String("/parsing_environment_data"));
+            globalItemRepositoryRegistry().journalFile(f.fileName(), ItemRepositoryRegistry::MoveFile);
             bool opened = f.open(QIODevice::WriteOnly);
             Q_ASSERT(opened);
             Q_UNUSED(opened);
@@ -954,6 +956,7 @@ unloadContexts:
             QMutexLocker lock(&m_chainsMutex);
 
             QFile f(globalItemRepositoryRegistry().path() + QLatin1String("/available_top_context_indices"));
+            globalItemRepositoryRegistry().journalFile(f.fileName(), ItemRepositoryRegistry::MoveFile);
             bool opened = f.open(QIODevice::WriteOnly);
             Q_ASSERT(opened);
             Q_UNUSED(opened);
@@ -967,8 +970,6 @@ unloadContexts:
         }
 
         if (lockFlag != NoLock) {
-            globalItemRepositoryRegistry().unlockForWriting();
-
             const auto elapsedMS = startTime.msecsTo(QTime::currentTime());
             qCDebug(LANGUAGE) << "time spent doing cleanup:" << elapsedMS << "ms - top-contexts still open:" <<
                 m_chainsByUrl.size() << "- retries" << retries;
@@ -978,6 +979,16 @@ unloadContexts:
             lock->unlock();
         }
 
+        if (lockFlag != NoLock) {
+            //Syncing the written files to disk may take a while, so don't block the duchain meanwhile.
+            //The cleanup mutex is still held, so no other cleanup can write to the repository before the commit.
+            writeLock.unlock();
+
+            QTime commitTime = QTime::currentTime();
+            globalItemRepositoryRegistry().unlockForWriting();
+            qCDebug(LANGUAGE) << "time spent committing the repository:" << commitTime.msecsTo(QTime::currentTime()) << "ms";
+        }
+
 #if HAVE_MALLOC_TRIM
         // trim unused memory but keep a pad buffer of about 50 MB
         // this can greatly decrease the perceived memory consumption of kdevelop
@@ -1273,6 +1284,7 @@ void DUChain::initialize()
     initInstantiationInformationRepository();
 
     Importers::self();
+    IncludeGraph::self();
 
     globalImportIdentifier();
     globalIndexedImportIdentifier();
@@ -1307,6 +1319,7 @@ void DUChain::removeDocumentChain(TopDUContext* context)
     ENSURE_CHAIN_WRITE_LOCKED;
     IndexedTopDUContext indexed(context->indexed());
     Q_ASSERT(indexed.data() == context); ///This assertion fails if you call removeDocumentChain(..) on a document that has not been added to the du-chain
+    IncludeGraph::self().removeImports(context);
     context->m_dynamicData->deleteOnDisk();
     Q_ASSERT(indexed.data() == context);
     sdDUChainPrivate->removeDocumentChainFromMemory(context);
@@ -1326,6 +1339,9 @@ void DUChain::addDocumentChain(TopDUContext* chain)
 
     Q_ASSERT(!sdDUChainPrivate->hasChainForIndex(chain->ownIndex()));
 
+    //Contexts loaded from disk are marked before, their imports are in the include graph already
+    const bool wasLoaded = chain->inDUChain();
+
     {
         QMutexLocker lock(&DUChain::chainsByIndexLock);
         if (DUChain::chainsByIndex.size() <= chain->ownIndex())
@@ -1346,6 +1362,10 @@ void DUChain::addDocumentChain(TopDUContext* chain)
 
     l.unlock();
 
+    if (!wasLoaded) {
+        IncludeGraph::self().setImports(chain);
+    }
+
     addToEnvironmentManager(chain);
 
     // This function might be called during shutdown by stale parse jobs
@@ -27,6 +27,7 @@
 #include <serialization/indexedstring.h>
 #include "topducontext.h"
 #include "duchainregister.h"
+#include "duchainitemarena.h"
 #include <util/foregroundlock.h>
 #include <interfaces/icore.h>
 #include <interfaces/ilanguagecontroller.h>
@@ -36,6 +37,12 @@
 namespace KDevelop {
 REGISTER_DUCHAIN_ITEM(DUChainBase);
 
+namespace {
+// Whether the item deleted last on this thread was placed into an arena. The destructors run
+// right before operator delete, which cannot look at the destroyed item itself anymore.
+thread_local bool deletingArenaItem = false;
+}
+
 uint DUChainBaseData::classSize() const
 {
     return DUChainItemSystem::self().dataClassSize(*this);
@@ -91,6 +98,19 @@ void DUChainBase::setData(DUChainBaseData* data, bool constructorCalled)
     d_ptr = data;
 }
 
+void DUChainBase::operator delete(void* pointer)
+{
+    if (!deletingArenaItem) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    deletingArenaItem = false;
+    const bool released = DUChainItemArena::release(pointer);
+    Q_ASSERT(released);
+    Q_UNUSED(released);
+}
+
 DUChainBase::~DUChainBase()
 {
     if (m_ptr)
@@ -100,6 +120,9 @@ DUChainBase::~DUChainBase()
         DUChainItemSystem::self().deleteDynamicData(d_ptr);
         d_ptr = nullptr;
     }
+
+    // read by operator delete, which follows right after the destructors
+    deletingArenaItem = m_inArena;
 }
 
 TopDUContext* DUChainBase::topContext() const
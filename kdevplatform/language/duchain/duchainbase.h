@@ -140,6 +140,13 @@ public:
     /// Destructor
     virtual ~DUChainBase();
 
+    /**
+     * Items loaded from disk are placed into the arena of their top-context,
+     * see DUChainItemArena. This gives their memory back to the right place.
+     * Only those need to look up their arena, other items go to the heap directly.
+     */
+    static void operator delete(void* pointer);
+
     /**
      * Determine the top context to which this object belongs.
      */
@@ -172,7 +179,7 @@ public:
     RangeInRevision range() const;
 
     ///Changes the range assigned to this object, in the document revision when this document is parsed.
-    void setRange(const RangeInRevision& range);
+    virtual void setRange(const RangeInRevision& range);
 
     ///Returns the range assigned to this object, transformed into the current revision of the document.
     ///@warning This must only be called from the foreground thread, or with the foreground lock acquired.
@@ -221,8 +228,11 @@ protected:
     DUChainBaseData* d_ptr;
 
 private:
+    friend class DUChainItemSystem;
 
     mutable QExplicitlySharedDataPointer<DUChainPointerData> m_ptr;
+    /// Set by DUChainItemSystem for items placed into an arena
+    bool m_inArena = false;
 
 public:
     DUCHAIN_DECLARE_DATA(DUChainBase)
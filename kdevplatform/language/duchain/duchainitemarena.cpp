@@ -0,0 +1,143 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#include "duchainitemarena.h"
+
+#include <QMutexLocker>
+
+#include <cstdint>
+#include <map>
+
+namespace KDevelop {
+namespace {
+constexpr size_t firstBlockSize = 4 * 1024;
+constexpr size_t maxBlockSize = 64 * 1024;
+
+struct Block
+{
+    uintptr_t begin;
+    DUChainItemArena* arena;
+};
+
+// the blocks of all arenas by their end address, used to find the arena of an item on deletion
+struct BlockRegistry
+{
+    QMutex mutex;
+    std::map<uintptr_t, Block> blocks;
+};
+
+BlockRegistry& blockRegistry()
+{
+    // never destroyed, items may still be deleted during static destruction
+    static auto* registry = new BlockRegistry;
+    return *registry;
+}
+
+DUChainItemArena* arenaForPointer(const void* pointer)
+{
+    const auto address = reinterpret_cast<uintptr_t>(pointer);
+
+    auto& registry = blockRegistry();
+    QMutexLocker lock(&registry.mutex);
+    const auto it = registry.blocks.upper_bound(address);
+    if (it == registry.blocks.end() || it->second.begin > address) {
+        return nullptr;
+    }
+    return it->second.arena;
+}
+}
+
+DUChainItemArena::DUChainItemArena()
+    : m_refs(1)
+{
+}
+
+DUChainItemArena::~DUChainItemArena()
+{
+    auto& registry = blockRegistry();
+    QMutexLocker lock(&registry.mutex);
+    for (char* block : qAsConst(m_blocks)) {
+        registry.blocks.erase(reinterpret_cast<uintptr_t>(block) + *reinterpret_cast<size_t*>(block));
+        ::operator delete(block);
+    }
+}
+
+void DUChainItemArena::ref()
+{
+    m_refs.ref();
+}
+
+void DUChainItemArena::deref()
+{
+    if (!m_refs.deref()) {
+        delete this;
+    }
+}
+
+char* DUChainItemArena::allocateBlock(size_t size)
+{
+    // the size is remembered at the beginning of the block, to unregister it later
+    size += alignof(std::max_align_t);
+    auto* block = static_cast<char*>(::operator new(size));
+    *reinterpret_cast<size_t*>(block) = size;
+    m_blocks.append(block);
+    m_reservedSize += size;
+
+    const auto begin = reinterpret_cast<uintptr_t>(block);
+    auto& registry = blockRegistry();
+    QMutexLocker lock(&registry.mutex);
+    registry.blocks[begin + size] = {begin, this};
+
+    return block + alignof(std::max_align_t);
+}
+
+void* DUChainItemArena::allocate(size_t size, size_t alignment)
+{
+    QMutexLocker lock(&m_mutex);
+
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(m_current) % alignment) % alignment;
+    if (!m_current || size + padding > m_available) {
+        // grow the blocks with the number of items, so small top-contexts waste little
+        const size_t blockSize = m_blocks.isEmpty() ? firstBlockSize : qMin(maxBlockSize, 2 * m_reservedSize);
+        if (size > blockSize) {
+            // large items get a block of their own, the current one is still used for the next items
+            m_refs.ref();
+            return allocateBlock(size);
+        }
+
+        m_current = allocateBlock(blockSize);
+        m_available = blockSize;
+        padding = 0;
+    }
+
+    char* ret = m_current + padding;
+    m_current = ret + size;
+    m_available -= padding + size;
+    m_refs.ref();
+    return ret;
+}
+
+bool DUChainItemArena::release(void* pointer)
+{
+    DUChainItemArena* arena = arenaForPointer(pointer);
+    if (!arena) {
+        return false;
+    }
+    arena->deref();
+    return true;
+}
+}
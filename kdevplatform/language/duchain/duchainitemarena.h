@@ -0,0 +1,76 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_DUCHAINITEMARENA_H
+#define KDEVPLATFORM_DUCHAINITEMARENA_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+#include <cstddef>
+
+namespace KDevelop {
+/**
+ * Memory the items of one top-context are placed into while they are loaded from disk.
+ *
+ * Items are placed one after the other into few large blocks, instead of getting a separate
+ * heap allocation each. Deleting an item does not give its memory back, the blocks are freed
+ * together once all items placed into them and the owning TopDUContextDynamicData are gone.
+ * That's usually when the top-context is unloaded.
+ *
+ * Only DUChainItemSystem::create() places items into an arena, and tags them. All other items
+ * are allocated from the heap as usual. DUChainBase::operator delete uses release() for tagged
+ * items only, which looks up the block containing the item.
+ */
+class DUChainItemArena
+{
+public:
+    /// The arena is created with a reference count of one, held by its owner.
+    DUChainItemArena();
+
+    DUChainItemArena(const DUChainItemArena&) = delete;
+    DUChainItemArena& operator=(const DUChainItemArena&) = delete;
+
+    void ref();
+    /// Frees the arena with all its blocks when the last reference is gone.
+    void deref();
+
+    /// Returns memory for an item of @p size bytes, the arena is referenced until it is released.
+    void* allocate(size_t size, size_t alignment);
+
+    /**
+     * Releases the memory of an item if it was allocated from an arena.
+     * @returns false if @p pointer does not belong to any arena.
+     */
+    static bool release(void* pointer);
+
+private:
+    ~DUChainItemArena();
+
+    char* allocateBlock(size_t size);
+
+    QMutex m_mutex;
+    QAtomicInt m_refs;
+    QVector<char*> m_blocks;
+    size_t m_reservedSize = 0;
+    char* m_current = nullptr;
+    size_t m_available = 0;
+};
+}
+
+#endif // KDEVPLATFORM_DUCHAINITEMARENA_H
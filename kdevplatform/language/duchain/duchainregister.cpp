@@ -18,6 +18,7 @@
 
 #include "duchainregister.h"
 #include "duchainbase.h"
+#include "duchainitemarena.h"
 
 #include <QDebug>
 
@@ -37,6 +38,16 @@ DUChainBase* DUChainItemSystem::create(DUChainBaseData* data) const
     return m_factories[data->classId]->create(data);
 }
 
+DUChainBase* DUChainItemSystem::create(DUChainBaseData* data, DUChainItemArena* arena) const
+{
+    if (uint(m_factories.size()) <= data->classId || m_factories[data->classId] == nullptr)
+        return nullptr;
+    const DUChainBaseFactory* factory = m_factories[data->classId];
+    DUChainBase* item = factory->createAt(data, arena->allocate(factory->itemSize(), factory->itemAlignment()));
+    item->m_inArena = true;
+    return item;
+}
+
 DUChainBaseData* DUChainItemSystem::cloneData(const DUChainBaseData& data) const
 {
     if (uint(m_factories.size()) <= data.classId || m_factories[data.classId] == nullptr) {
@@ -21,9 +21,12 @@
 
 #include "duchainbase.h"
 
+#include <new>
+
 namespace KDevelop {
 class DUChainBase;
 class DUChainBaseData;
+class DUChainItemArena;
 
 ///This class is purely internal and doesn't need to be documented. It brings a "fake" type-info
 ///to classes that don't have type-info in the normal C++ way.
@@ -32,6 +35,9 @@ class KDEVPLATFORMLANGUAGE_EXPORT DUChainBaseFactory
 {
 public:
     virtual DUChainBase* create(DUChainBaseData* data) const = 0;
+    virtual DUChainBase* createAt(DUChainBaseData* data, void* memory) const = 0;
+    virtual size_t itemSize() const = 0;
+    virtual size_t itemAlignment() const = 0;
     virtual void callDestructor(DUChainBaseData* data) const = 0;
     virtual void freeDynamicData(DUChainBaseData* data) const = 0;
     virtual void deleteDynamicData(DUChainBaseData* data) const = 0;
@@ -55,6 +61,21 @@ public:
         return new T(*static_cast<Data*>(data));
     }
 
+    DUChainBase* createAt(DUChainBaseData* data, void* memory) const override
+    {
+        return new (memory) T(*static_cast<Data*>(data));
+    }
+
+    size_t itemSize() const override
+    {
+        return sizeof(T);
+    }
+
+    size_t itemAlignment() const override
+    {
+        return alignof(T);
+    }
+
     void copy(const DUChainBaseData& from, DUChainBaseData& to, bool constant) const override
     {
         Q_ASSERT(from.classId == T::Identity);
@@ -147,6 +168,9 @@ public:
      */
     DUChainBase* create(DUChainBaseData* data) const;
 
+    /// Like create(), but places the item into @p arena instead of allocating it from the heap.
+    DUChainBase* create(DUChainBaseData* data, DUChainItemArena* arena) const;
+
     ///Creates a dynamic copy of the given data
     DUChainBaseData* cloneData(const DUChainBaseData& data) const;
 
@@ -312,18 +312,15 @@ ItemUnderCursorInternal itemUnderCursorInternal(const CursorInRevision& c, DUCon
     }
   }
 
-  const auto localDeclarations = ctx->localDeclarations();
-  for (Declaration* decl : localDeclarations) {
-    if(decl->range().contains(c, behavior)) {
-      return {decl, ctx, decl->range()};
-    }
+  if (Declaration* decl = ctx->findLocalDeclarationAt(c, behavior)) {
+    return {decl, ctx, decl->range()};
   }
 
   //Try finding a use under the cursor
-  for(int a = 0; a < ctx->usesCount(); ++a) {
-    if(ctx->uses()[a].m_range.contains(c, behavior)) {
-      return {ctx->topContext()->usedDeclarationForIndex(ctx->uses()[a].m_declarationIndex), ctx, ctx->uses()[a].m_range};
-    }
+  const int useIndex = ctx->findLocalUseAt(c, behavior);
+  if (useIndex != -1) {
+    const Use& use = ctx->uses()[useIndex];
+    return {ctx->topContext()->usedDeclarationForIndex(use.m_declarationIndex), ctx, use.m_range};
   }
 
   return {nullptr, nullptr, RangeInRevision()};
@@ -22,6 +22,8 @@
 #include <limits>
 #include <algorithm>
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSet>
 
 #include "ducontextdata.h"
@@ -131,6 +133,10 @@ void DUContext::rebuildDynamicData(DUContext* parent, uint ownIndex)
         m_dynamicData->m_localDeclarations << declaration;
     }
 
+    m_dynamicData->invalidateIdentifierIndex();
+    m_dynamicData->invalidateDeclarationRangeIndex();
+    m_dynamicData->invalidateUseRangeIndex();
+
     DUChainBase::rebuildDynamicData(parent, ownIndex);
 }
 
@@ -176,6 +182,142 @@ void DUContextDynamicData::scopeIdentifier(bool includeClasses, QualifiedIdentif
         target += d_func()->m_scopeIdentifier;
 }
 
+QVector<Declaration*> DUContextDynamicData::visibleDeclarations(const IndexedIdentifier& identifier) const
+{
+    // the hash is built lazily with the DUChain only read-locked, so concurrent readers serialize on building it.
+    // it is only dropped with the DUChain write-locked, so once it exists, it can be searched without the mutex
+    static QMutex identifierIndexMutex;
+    const QHash<IndexedIdentifier, QVector<Declaration*>>* index;
+    {
+        QMutexLocker lock(&identifierIndexMutex);
+
+        if (!m_identifierIndex) {
+            m_identifierIndex.reset(new QHash<IndexedIdentifier, QVector<Declaration*>>);
+            m_identifierIndex->reserve(m_localDeclarations.size());
+
+            VisibleDeclarationIterator it(this);
+            while (it) {
+                Declaration* declaration = *it;
+                if (declaration)
+                    (*m_identifierIndex)[declaration->indexedIdentifier()].append(declaration);
+                ++it;
+            }
+        }
+        index = m_identifierIndex.get();
+    }
+
+    return index->value(identifier);
+}
+
+void DUContextDynamicData::invalidateIdentifierIndex()
+{
+    DUContextDynamicData* data = this;
+    while (true) {
+        data->m_identifierIndex.reset();
+
+        DUContext* parent = data->m_parentContext.data();
+        if (!parent || !data->d_func()->m_propagateDeclarations)
+            break;
+        data = parent->m_dynamicData;
+    }
+}
+
+DUContextDynamicData::RangeIndex::RangeIndex(const QVector<RangeInRevision>& ranges)
+{
+    m_entries.reserve(ranges.size());
+    for (int i = 0; i < ranges.size(); ++i) {
+        m_entries.append({ranges[i], ranges[i].end, i});
+    }
+
+    // stable, so entries with the same start stay in their original order
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.range.start < rhs.range.start;
+    });
+
+    for (int i = 1; i < m_entries.size(); ++i) {
+        m_entries[i].maxEnd = qMax(m_entries[i].range.end, m_entries[i - 1].maxEnd);
+    }
+}
+
+int DUContextDynamicData::RangeIndex::find(const CursorInRevision& position,
+                                           RangeInRevision::ContainsBehavior behavior) const
+{
+    // all ranges containing the position start at or before it
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), position,
+                               [](const CursorInRevision& position, const Entry& entry) {
+        return position < entry.range.start;
+    });
+
+    int ret = -1;
+    while (it != m_entries.begin()) {
+        --it;
+        if (it->maxEnd < position)
+            break;
+        if (it->range.contains(position, behavior) && (ret == -1 || it->index < ret))
+            ret = it->index;
+    }
+    return ret;
+}
+
+namespace {
+// the range indices are built lazily with the DUChain only read-locked, so concurrent readers serialize on building them.
+// they are only dropped with the DUChain write-locked, so once one exists, it can be searched without the mutex
+QMutex rangeIndexMutex;
+}
+
+int DUContextDynamicData::localDeclarationAt(const CursorInRevision& position,
+                                             RangeInRevision::ContainsBehavior behavior) const
+{
+    const RangeIndex* index;
+    {
+        QMutexLocker lock(&rangeIndexMutex);
+
+        if (!m_declarationRangeIndex) {
+            QVector<RangeInRevision> ranges;
+            ranges.reserve(m_localDeclarations.size());
+            for (Declaration* declaration : m_localDeclarations) {
+                ranges.append(declaration->range());
+            }
+            m_declarationRangeIndex.reset(new RangeIndex(ranges));
+        }
+        index = m_declarationRangeIndex.get();
+    }
+
+    return index->find(position, behavior);
+}
+
+int DUContextDynamicData::useAt(const CursorInRevision& position, RangeInRevision::ContainsBehavior behavior) const
+{
+    const RangeIndex* index;
+    {
+        QMutexLocker lock(&rangeIndexMutex);
+
+        if (!m_useRangeIndex) {
+            const Use* uses = d_func()->m_uses();
+            const uint usesSize = d_func()->m_usesSize();
+            QVector<RangeInRevision> ranges;
+            ranges.reserve(usesSize);
+            for (uint i = 0; i < usesSize; ++i) {
+                ranges.append(uses[i].m_range);
+            }
+            m_useRangeIndex.reset(new RangeIndex(ranges));
+        }
+        index = m_useRangeIndex.get();
+    }
+
+    return index->find(position, behavior);
+}
+
+void DUContextDynamicData::invalidateDeclarationRangeIndex()
+{
+    m_declarationRangeIndex.reset();
+}
+
+void DUContextDynamicData::invalidateUseRangeIndex()
+{
+    m_useRangeIndex.reset();
+}
+
 bool DUContextDynamicData::imports(const DUContext* context, const TopDUContext* source,
                                    QSet<const DUContextDynamicData*>* recursionGuard) const
 {
@@ -236,6 +378,9 @@ void DUContextDynamicData::addDeclaration(Declaration* newDeclaration)
         d_func_dynamic()->m_localDeclarationsList().insert(0, newDeclaration);
         Q_ASSERT(d_func()->m_localDeclarations()[0].data(m_topContext) == newDeclaration);
     }
+
+    invalidateIdentifierIndex();
+    invalidateDeclarationRangeIndex();
 }
 
 bool DUContextDynamicData::removeDeclaration(Declaration* declaration)
@@ -245,6 +390,8 @@ bool DUContextDynamicData::removeDeclaration(Declaration* declaration)
         Q_ASSERT(d_func()->m_localDeclarations()[idx].data(m_topContext) == declaration);
         m_localDeclarations.remove(idx);
         d_func_dynamic()->m_localDeclarationsList().remove(idx);
+        invalidateIdentifierIndex();
+        invalidateDeclarationRangeIndex();
         return true;
     } else {
         Q_ASSERT(d_func_dynamic()->m_localDeclarationsList().indexOf(LocalIndexedDeclaration(declaration)) == -1);
@@ -286,6 +433,8 @@ void DUContextDynamicData::addChildContext(DUContext* context)
         d_func_dynamic()->m_childContextsList().insert(0, indexed);
         context->m_dynamicData->m_parentContext = m_context;
     }
+
+    invalidateIdentifierIndex();
 }
 
 bool DUContextDynamicData::removeChildContext(DUContext* context)
@@ -297,6 +446,7 @@ bool DUContextDynamicData::removeChildContext(DUContext* context)
         m_childContexts.remove(idx);
         Q_ASSERT(d_func()->m_childContexts()[idx] == LocalIndexedDUContext(context));
         d_func_dynamic()->m_childContextsList().remove(idx);
+        invalidateIdentifierIndex();
         return true;
     } else {
         Q_ASSERT(d_func_dynamic()->m_childContextsList().indexOf(LocalIndexedDUContext(context)) == -1);
@@ -525,6 +675,9 @@ void DUContext::setPropagateDeclarations(bool propagate)
         return;
 
     d->m_propagateDeclarations = propagate;
+
+    if (DUContext* parent = parentContext())
+        parent->m_dynamicData->invalidateIdentifierIndex();
 }
 
 bool DUContext::isPropagateDeclarations() const
@@ -568,6 +721,9 @@ bool contextIsChildOrEqual(const DUContext* childContext, const DUContext* conte
         return false;
 }
 
+///Contexts with at least this count of local declarations use a hash to find declarations by identifier
+constexpr int identifierIndexThreshold = 64;
+
 struct Checker
 {
     Checker(DUContext::SearchFlags flags, const AbstractType::Ptr& dataType,
@@ -641,21 +797,24 @@ void DUContext::findLocalDeclarationsInternal(const IndexedIdentifier& identifie
 
         TopDUContext* top = topContext();
 
-        uint count;
-        const IndexedDeclaration* declarations;
-        PersistentSymbolTable::self().declarations(id, count, declarations);
-        for (uint a = 0; a < count; ++a) {
-            ///@todo Eventually do efficient iteration-free filtering
-            if (declarations[a].topContextIndex() == top->ownIndex()) {
-                Declaration* decl = declarations[a].declaration();
-                if (decl && contextIsChildOrEqual(decl->context(), this)) {
-                    Declaration* checked = checker.check(decl);
-                    if (checked) {
-                        ret.append(checked);
-                    }
+        KDevVarLengthArray<IndexedDeclaration> declarations;
+        PersistentSymbolTable::self().declarationsInTopContext(id, top->ownIndex(), declarations);
+        for (const IndexedDeclaration& indexedDeclaration : qAsConst(declarations)) {
+            Declaration* decl = indexedDeclaration.declaration();
+            if (decl && contextIsChildOrEqual(decl->context(), this)) {
+                Declaration* checked = checker.check(decl);
+                if (checked) {
+                    ret.append(checked);
                 }
             }
         }
+    } else if (m_dynamicData->m_localDeclarations.size() >= identifierIndexThreshold) {
+        const auto declarations = m_dynamicData->visibleDeclarations(identifier);
+        for (Declaration* declaration : declarations) {
+            Declaration* checked = checker.check(declaration);
+            if (checked)
+                ret.append(checked);
+        }
     } else {
         //Iterate through all declarations
         DUContextDynamicData::VisibleDeclarationIterator it(m_dynamicData);
@@ -1056,6 +1215,8 @@ void DUContext::deleteLocalDeclarations()
     }
 
     m_dynamicData->m_localDeclarations.clear();
+    m_dynamicData->invalidateIdentifierIndex();
+    m_dynamicData->invalidateDeclarationRangeIndex();
 }
 
 void DUContext::deleteChildContextsRecursively()
@@ -1067,6 +1228,7 @@ void DUContext::deleteChildContextsRecursively()
     qDeleteAll(currentChildContexts);
 
     m_dynamicData->m_childContexts.clear();
+    m_dynamicData->invalidateIdentifierIndex();
 }
 
 QVector<Declaration*> DUContext::clearLocalDeclarations()
@@ -1169,6 +1331,7 @@ void DUContext::deleteUse(int index)
     ENSURE_CAN_WRITE
         DUCHAIN_D_DYNAMIC(DUContext);
     d->m_usesList().remove(index);
+    m_dynamicData->invalidateUseRangeIndex();
 }
 
 void DUContext::deleteUses()
@@ -1177,6 +1340,7 @@ void DUContext::deleteUses()
 
         DUCHAIN_D_DYNAMIC(DUContext);
     d->m_usesList().clear();
+    m_dynamicData->invalidateUseRangeIndex();
 }
 
 void DUContext::deleteUsesRecursively()
@@ -1362,6 +1526,7 @@ int DUContext::createUse(int declarationIndex, const RangeInRevision& range, int
     }
 
     d->m_usesList().insert(insertBefore, use);
+    m_dynamicData->invalidateUseRangeIndex();
 
     return insertBefore;
 }
@@ -1370,6 +1535,7 @@ void DUContext::changeUseRange(int useIndex, const RangeInRevision& range)
 {
     ENSURE_CAN_WRITE
         d_func_dynamic()->m_usesList()[useIndex].m_range = range;
+    m_dynamicData->invalidateUseRangeIndex();
 }
 
 void DUContext::setUseDeclaration(int useNumber, int declarationIndex)
@@ -1399,6 +1565,11 @@ DUContext* DUContext::findContextAt(const CursorInRevision& position, bool inclu
     return const_cast<DUContext*>(this);
 }
 
+namespace {
+// below this, a linear search is cheaper than building the range index
+constexpr int rangeIndexThreshold = 32;
+}
+
 Declaration* DUContext::findDeclarationAt(const CursorInRevision& position) const
 {
     ENSURE_CAN_READ
@@ -1406,8 +1577,22 @@ Declaration* DUContext::findDeclarationAt(const CursorInRevision& position) cons
     if (!range().contains(position))
         return nullptr;
 
-    for (Declaration* child : qAsConst(m_dynamicData->m_localDeclarations)) {
-        if (child->range().contains(position)) {
+    return findLocalDeclarationAt(position);
+}
+
+Declaration* DUContext::findLocalDeclarationAt(const CursorInRevision& position,
+                                               RangeInRevision::ContainsBehavior behavior) const
+{
+    ENSURE_CAN_READ
+
+    const auto& localDeclarations = m_dynamicData->m_localDeclarations;
+    if (localDeclarations.size() >= rangeIndexThreshold) {
+        const int index = m_dynamicData->localDeclarationAt(position, behavior);
+        return index == -1 ? nullptr : localDeclarations[index];
+    }
+
+    for (Declaration* child : localDeclarations) {
+        if (child->range().contains(position, behavior)) {
             return child;
         }
     }
@@ -1438,8 +1623,20 @@ int DUContext::findUseAt(const CursorInRevision& position) const
     if (!range().contains(position))
         return -1;
 
-    for (unsigned int a = 0; a < d_func()->m_usesSize(); ++a)
-        if (d_func()->m_uses()[a].m_range.contains(position))
+    return findLocalUseAt(position);
+}
+
+int DUContext::findLocalUseAt(const CursorInRevision& position, RangeInRevision::ContainsBehavior behavior) const
+{
+    ENSURE_CAN_READ
+
+    const int usesSize = d_func()->m_usesSize();
+    if (usesSize >= rangeIndexThreshold)
+        return m_dynamicData->useAt(position, behavior);
+
+    const Use* uses = d_func()->m_uses();
+    for (int a = 0; a < usesSize; ++a)
+        if (uses[a].m_range.contains(position, behavior))
             return a;
 
     return -1;
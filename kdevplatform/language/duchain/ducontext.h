@@ -194,6 +194,17 @@ public:
      */
     Declaration* findDeclarationAt(const CursorInRevision& position) const;
 
+    /**
+     * Find the first local declaration whose range covers the given @p position.
+     *
+     * Unlike findDeclarationAt(), the position does not need to be within the range of this context.
+     * For contexts with many declarations, this is a logarithmic lookup.
+     *
+     * @warning This uses the ranges in the local revision of the document (at last parsing time).
+     */
+    Declaration* findLocalDeclarationAt(const CursorInRevision& position,
+                                        RangeInRevision::ContainsBehavior behavior = RangeInRevision::Default) const;
+
     /**
      * Find the context which most specifically covers @a range.
      *
@@ -624,6 +635,16 @@ private:
      */
     int findUseAt(const CursorInRevision& position) const;
 
+    /**
+     * Find the first use which encompasses @a position, if one exists.
+     *
+     * Unlike findUseAt(), the position does not need to be within the range of this context.
+     * For contexts with many uses, this is a logarithmic lookup.
+     * @return The local index of the use, or -1
+     */
+    int findLocalUseAt(const CursorInRevision& position,
+                       RangeInRevision::ContainsBehavior behavior = RangeInRevision::Default) const;
+
     /**
      * @note The change must not break the ordering
      */
@@ -24,6 +24,11 @@
 
 #include "ducontextdata.h"
 
+#include <QHash>
+#include <QVector>
+
+#include <memory>
+
 namespace KDevelop {
 ///This class contains data that is only runtime-dependent and does not need to be stored to disk
 class DUContextDynamicData
@@ -75,6 +80,73 @@ public:
     //Files the scope identifier into target
     void scopeIdentifier(bool includeClasses, QualifiedIdentifier& target) const;
 
+    /**
+     * Returns the visible declarations with the given identifier, in the order of VisibleDeclarationIterator.
+     *
+     * The declarations are looked up in a hash, which is built on first use and kept until the
+     * visible declarations change. Only use this for contexts with many local declarations.
+     * */
+    QVector<Declaration*> visibleDeclarations(const IndexedIdentifier& identifier) const;
+
+    /**
+     * Drops the identifier hash of this context, and of all parent contexts
+     * this context propagates its declarations to.
+     *
+     * The DUChain must be write-locked, unless the context is not reachable by others yet,
+     * as visibleDeclarations() searches the hash without holding a lock.
+     * */
+    void invalidateIdentifierIndex();
+
+    /**
+     * Point queries over a list of ranges, answering which of them contain a position.
+     *
+     * The ranges are kept sorted by their start, together with the greatest end of all
+     * ranges starting before. A query only visits the ranges that start before the position,
+     * back to the first one that can't reach it anymore. For the usually disjoint ranges of
+     * declarations and uses, that's a binary search plus a few steps.
+     * */
+    class RangeIndex
+    {
+    public:
+        explicit RangeIndex(const QVector<RangeInRevision>& ranges);
+
+        ///@return the lowest index into the ranges given to the constructor whose range contains @p position, or -1
+        int find(const CursorInRevision& position, RangeInRevision::ContainsBehavior behavior) const;
+
+    private:
+        struct Entry
+        {
+            RangeInRevision range;
+            // the greatest end of this and all preceding entries
+            CursorInRevision maxEnd;
+            int index;
+        };
+        QVector<Entry> m_entries;
+    };
+
+    /**
+     * Returns the index of the first local declaration whose range contains @p position, or -1.
+     *
+     * Like visibleDeclarations(), this builds an index on first use, which is kept until
+     * the local declarations or their ranges change. Only use this for contexts with many local declarations.
+     * */
+    int localDeclarationAt(const CursorInRevision& position, RangeInRevision::ContainsBehavior behavior) const;
+
+    /**
+     * Returns the index of the first use whose range contains @p position, or -1.
+     *
+     * The index is kept until the uses of this context change. Only use this for contexts with many uses.
+     * */
+    int useAt(const CursorInRevision& position, RangeInRevision::ContainsBehavior behavior) const;
+
+    /// Drops the range index of the local declarations.
+    /// Like invalidateIdentifierIndex(), this requires the DUChain to be write-locked.
+    void invalidateDeclarationRangeIndex();
+
+    /// Drops the range index of the uses.
+    /// Like invalidateIdentifierIndex(), this requires the DUChain to be write-locked.
+    void invalidateUseRangeIndex();
+
     //Iterates through all visible declarations within a given context, including the ones propagated from sub-contexts
     class VisibleDeclarationIterator
     {
@@ -159,6 +231,13 @@ public:
      * */
     bool imports(const DUContext* context, const TopDUContext* source,
                  QSet<const DUContextDynamicData*>* recursionGuard) const;
+
+private:
+    // lazily built by visibleDeclarations()
+    mutable std::unique_ptr<QHash<IndexedIdentifier, QVector<Declaration*>>> m_identifierIndex;
+    // lazily built by localDeclarationAt() and useAt()
+    mutable std::unique_ptr<RangeIndex> m_declarationRangeIndex;
+    mutable std::unique_ptr<RangeIndex> m_useRangeIndex;
 };
 }
 
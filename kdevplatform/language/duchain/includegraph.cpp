@@ -0,0 +1,447 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#include "includegraph.h"
+
+#include "appendedlist.h"
+#include "duchain.h"
+#include "duchainlock.h"
+#include "indexedtopducontext.h"
+#include "topducontext.h"
+#include <serialization/itemrepository.h>
+#include <serialization/referencecounting.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+namespace KDevelop {
+struct IncludeGraphImporter
+{
+    IndexedString file;
+    /// Number of top-contexts of the file importing the other one
+    uint count;
+};
+
+DEFINE_LIST_MEMBER_HASH(IncludeGraphImportsItem, files, IndexedString)
+
+/// The files imported by one top-context
+class IncludeGraphImportsItem
+{
+public:
+    IncludeGraphImportsItem()
+    {
+        initializeAppendedLists();
+    }
+    IncludeGraphImportsItem(const IncludeGraphImportsItem& rhs, bool dynamic = true) : context(rhs.context)
+    {
+        initializeAppendedLists(dynamic);
+        copyListsFrom(rhs);
+    }
+
+    ~IncludeGraphImportsItem()
+    {
+        freeAppendedLists();
+    }
+
+    IncludeGraphImportsItem& operator=(const IncludeGraphImportsItem& rhs) = delete;
+
+    unsigned int hash() const
+    {
+        //We only compare the context. This allows us implementing a map, although the item-repository
+        //originally represents a set.
+        return context;
+    }
+
+    unsigned int itemSize() const
+    {
+        return dynamicSize();
+    }
+
+    uint classSize() const
+    {
+        return sizeof(IncludeGraphImportsItem);
+    }
+
+    uint context = 0;
+
+    START_APPENDED_LISTS(IncludeGraphImportsItem);
+    APPENDED_LIST_FIRST(IncludeGraphImportsItem, IndexedString, files);
+    END_APPENDED_LISTS(IncludeGraphImportsItem, files);
+};
+
+DEFINE_LIST_MEMBER_HASH(IncludeGraphImportersItem, importers, IncludeGraphImporter)
+
+/// The files importing one file
+class IncludeGraphImportersItem
+{
+public:
+    IncludeGraphImportersItem()
+    {
+        initializeAppendedLists();
+    }
+    IncludeGraphImportersItem(const IncludeGraphImportersItem& rhs, bool dynamic = true) : file(rhs.file)
+    {
+        initializeAppendedLists(dynamic);
+        copyListsFrom(rhs);
+    }
+
+    ~IncludeGraphImportersItem()
+    {
+        freeAppendedLists();
+    }
+
+    IncludeGraphImportersItem& operator=(const IncludeGraphImportersItem& rhs) = delete;
+
+    unsigned int hash() const
+    {
+        return file.index();
+    }
+
+    unsigned int itemSize() const
+    {
+        return dynamicSize();
+    }
+
+    uint classSize() const
+    {
+        return sizeof(IncludeGraphImportersItem);
+    }
+
+    IndexedString file;
+
+    START_APPENDED_LISTS(IncludeGraphImportersItem);
+    APPENDED_LIST_FIRST(IncludeGraphImportersItem, IncludeGraphImporter, importers);
+    END_APPENDED_LISTS(IncludeGraphImportersItem, importers);
+};
+
+template <class Item>
+class IncludeGraphRequestItem
+{
+public:
+
+    IncludeGraphRequestItem(const Item& item) : m_item(item)
+    {
+    }
+    enum {
+        AverageSize = 40 //This should be the approximate average size of an Item
+    };
+
+    unsigned int hash() const
+    {
+        return m_item.hash();
+    }
+
+    uint itemSize() const
+    {
+        return m_item.itemSize();
+    }
+
+    void createItem(Item* item) const
+    {
+        Q_ASSERT(shouldDoDUChainReferenceCounting(item));
+        new (item) Item(m_item, false);
+    }
+
+    static void destroy(Item* item, KDevelop::AbstractItemRepository&)
+    {
+        Q_ASSERT(shouldDoDUChainReferenceCounting(item));
+        item->~Item();
+    }
+
+    static bool persistent(const Item* /*item*/)
+    {
+        return true;
+    }
+
+    bool equals(const Item* item) const
+    {
+        // the hash is the key of the map itself
+        return m_item.hash() == item->hash();
+    }
+
+    const Item& m_item;
+};
+
+using IncludeGraphImportsRepository =
+    ItemRepository<IncludeGraphImportsItem, IncludeGraphRequestItem<IncludeGraphImportsItem>>;
+using IncludeGraphImportersRepository =
+    ItemRepository<IncludeGraphImportersItem, IncludeGraphRequestItem<IncludeGraphImportersItem>>;
+
+class IncludeGraphPrivate
+{
+public:
+
+    IncludeGraphPrivate()
+        : m_imports(QStringLiteral("Include Graph Imports"))
+        , m_importers(QStringLiteral("Include Graph Importers"))
+    {
+    }
+
+    QVector<IndexedString> importsOf(uint context) const
+    {
+        QVector<IndexedString> ret;
+
+        IncludeGraphImportsItem item;
+        item.context = context;
+
+        const uint index = m_imports.findIndex(item);
+        if (index) {
+            const IncludeGraphImportsItem* repositoryItem = m_imports.itemFromIndex(index);
+            ret.reserve(repositoryItem->filesSize());
+            FOREACH_FUNCTION(const IndexedString &file, repositoryItem->files)
+            ret.append(file);
+        }
+
+        return ret;
+    }
+
+    void setImportsOf(uint context, const QVector<IndexedString>& files)
+    {
+        IncludeGraphImportsItem item;
+        item.context = context;
+        IncludeGraphRequestItem<IncludeGraphImportsItem> request(item);
+
+        const uint index = m_imports.findIndex(item);
+        if (index) {
+            m_imports.deleteItem(index);
+        }
+
+        if (!files.isEmpty()) {
+            for (const IndexedString& file : files) {
+                item.filesList().append(file);
+            }
+            //This inserts the changed item
+            m_imports.index(request);
+        }
+    }
+
+    /// Adds @p delta to the count of top-contexts of @p file importing @p importedFile
+    void changeEdge(const IndexedString& file, const IndexedString& importedFile, int delta)
+    {
+        IncludeGraphImportersItem item;
+        item.file = importedFile;
+        IncludeGraphRequestItem<IncludeGraphImportersItem> request(item);
+
+        int count = delta;
+        const uint index = m_importers.findIndex(item);
+        if (index) {
+            const IncludeGraphImportersItem* repositoryItem = m_importers.itemFromIndex(index);
+            FOREACH_FUNCTION(const IncludeGraphImporter &importer, repositoryItem->importers) {
+                if (importer.file == file) {
+                    count += static_cast<int>(importer.count);
+                } else {
+                    item.importersList().append(importer);
+                }
+            }
+            m_importers.deleteItem(index);
+        }
+
+        // the edge is dropped once no top-context of the file imports the other one anymore
+        if (count > 0) {
+            item.importersList().append({file, static_cast<uint>(count)});
+        }
+
+        //This inserts the changed item
+        if (!item.importersList().isEmpty()) {
+            m_importers.index(request);
+        }
+    }
+
+    // mutable as things like findIndex are not const
+    mutable IncludeGraphImportsRepository m_imports;
+    mutable IncludeGraphImportersRepository m_importers;
+
+    // Serializes the updates, which consist of multiple changes to the repositories
+    mutable QMutex m_graphMutex;
+};
+
+IncludeGraph::IncludeGraph()
+    : d_ptr(new IncludeGraphPrivate())
+{
+}
+
+IncludeGraph::~IncludeGraph() = default;
+
+void IncludeGraph::addImport(const TopDUContext* context, const TopDUContext* imported)
+{
+    Q_D(IncludeGraph);
+
+    const IndexedString file = context->url();
+    const IndexedString importedFile = imported->url();
+    if (importedFile.isEmpty() || importedFile == file) {
+        return;
+    }
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    auto imports = d->importsOf(context->ownIndex());
+    if (imports.contains(importedFile)) {
+        return;
+    }
+    imports.append(importedFile);
+    d->setImportsOf(context->ownIndex(), imports);
+    d->changeEdge(file, importedFile, 1);
+}
+
+void IncludeGraph::removeImport(const TopDUContext* context, const TopDUContext* imported)
+{
+    Q_D(IncludeGraph);
+
+    const IndexedString importedFile = imported->url();
+
+    // the file may still be imported through a top-context for another environment
+    const auto importedContexts = context->importedParentContexts();
+    for (const DUContext::Import& import : importedContexts) {
+        if (IndexedTopDUContext(import.topContextIndex()).url() == importedFile) {
+            return;
+        }
+    }
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    auto imports = d->importsOf(context->ownIndex());
+    if (!imports.removeOne(importedFile)) {
+        return;
+    }
+    d->setImportsOf(context->ownIndex(), imports);
+    d->changeEdge(context->url(), importedFile, -1);
+}
+
+void IncludeGraph::setImports(const TopDUContext* context)
+{
+    ENSURE_CHAIN_READ_LOCKED
+
+    Q_D(IncludeGraph);
+
+    const IndexedString file = context->url();
+    const auto importedContexts = context->importedParentContexts();
+
+    QVector<IndexedString> imports;
+    imports.reserve(importedContexts.size());
+    for (const DUContext::Import& import : importedContexts) {
+        const IndexedString importedFile = IndexedTopDUContext(import.topContextIndex()).url();
+        if (!importedFile.isEmpty() && importedFile != file && !imports.contains(importedFile)) {
+            imports.append(importedFile);
+        }
+    }
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    const auto oldImports = d->importsOf(context->ownIndex());
+    if (oldImports == imports) {
+        return;
+    }
+    d->setImportsOf(context->ownIndex(), imports);
+
+    for (const IndexedString& removed : oldImports) {
+        if (!imports.contains(removed)) {
+            d->changeEdge(file, removed, -1);
+        }
+    }
+    for (const IndexedString& added : qAsConst(imports)) {
+        if (!oldImports.contains(added)) {
+            d->changeEdge(file, added, 1);
+        }
+    }
+}
+
+void IncludeGraph::removeImports(const TopDUContext* context)
+{
+    Q_D(IncludeGraph);
+
+    const IndexedString file = context->url();
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    const auto oldImports = d->importsOf(context->ownIndex());
+    if (oldImports.isEmpty()) {
+        return;
+    }
+    d->setImportsOf(context->ownIndex(), {});
+    for (const IndexedString& removed : oldImports) {
+        d->changeEdge(file, removed, -1);
+    }
+}
+
+QVector<IndexedString> IncludeGraph::importers(const IndexedString& file) const
+{
+    Q_D(const IncludeGraph);
+
+    QVector<IndexedString> ret;
+
+    IncludeGraphImportersItem item;
+    item.file = file;
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    const uint index = d->m_importers.findIndex(item);
+    if (index) {
+        const IncludeGraphImportersItem* repositoryItem = d->m_importers.itemFromIndex(index);
+        ret.reserve(repositoryItem->importersSize());
+        FOREACH_FUNCTION(const IncludeGraphImporter &importer, repositoryItem->importers)
+        ret.append(importer.file);
+    }
+
+    return ret;
+}
+
+QVector<IncludeGraph::Dependent> IncludeGraph::dependents(const IndexedString& file, int maxDistance) const
+{
+    Q_D(const IncludeGraph);
+
+    QVector<Dependent> ret;
+    QSet<IndexedString> visited{file};
+    QVector<IndexedString> current{file};
+
+    QMutexLocker lock(&d->m_graphMutex);
+
+    //Breadth-first, so every dependent is reached on its shortest path first
+    for (int distance = 1; !current.isEmpty() && (maxDistance < 0 || distance <= maxDistance); ++distance) {
+        QVector<IndexedString> next;
+
+        for (const IndexedString& importedFile : qAsConst(current)) {
+            IncludeGraphImportersItem item;
+            item.file = importedFile;
+
+            const uint index = d->m_importers.findIndex(item);
+            if (!index) {
+                continue;
+            }
+
+            const IncludeGraphImportersItem* repositoryItem = d->m_importers.itemFromIndex(index);
+            FOREACH_FUNCTION(const IncludeGraphImporter &importer, repositoryItem->importers) {
+                if (!visited.contains(importer.file)) {
+                    visited.insert(importer.file);
+                    next.append(importer.file);
+                    ret.append({importer.file, distance});
+                }
+            }
+        }
+
+        current.swap(next);
+    }
+
+    return ret;
+}
+
+IncludeGraph& IncludeGraph::self()
+{
+    static IncludeGraph globalIncludeGraph;
+    return globalIncludeGraph;
+}
+}
@@ -0,0 +1,95 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_INCLUDEGRAPH_H
+#define KDEVPLATFORM_INCLUDEGRAPH_H
+
+#include <language/languageexport.h>
+#include <serialization/indexedstring.h>
+
+#include <QScopedPointer>
+#include <QVector>
+
+namespace KDevelop {
+class TopDUContext;
+class IncludeGraphPrivate;
+
+/**
+ * Persistent file-level import graph, with the reverse edges stored next to the forward ones.
+ *
+ * This allows enumerating all files that include a given header, directly or indirectly,
+ * without loading any top-context or environment information, see dependents().
+ *
+ * The edges are updated right away by TopDUContext when the imports of a top-context
+ * registered in the DUChain change, and when the top-context is removed from the DUChain.
+ * The imports are stored per top-context, so when a file is parsed in multiple environments,
+ * it imports the union of the files imported by its top-contexts.
+ *
+ * All functions are thread-safe.
+ */
+class KDEVPLATFORMLANGUAGE_EXPORT IncludeGraph
+{
+public:
+    struct Dependent
+    {
+        IndexedString file;
+        /// Number of import edges between the dependent and the queried file, 1 for direct importers
+        int distance;
+    };
+
+    /// Constructor.
+    IncludeGraph();
+    /// Destructor.
+    ~IncludeGraph();
+
+    /// Adds the edge from the file of @p context to the file of @p imported, if @p context didn't import it yet.
+    void addImport(const TopDUContext* context, const TopDUContext* imported);
+
+    /// Removes the edge from the file of @p context to the file of @p imported,
+    /// unless another top-context of the file still imports it.
+    void removeImport(const TopDUContext* context, const TopDUContext* imported);
+
+    /**
+     * Replaces the stored imports of @p context with its current ones.
+     * Used when a top-context is registered in the DUChain after its imports were added.
+     * The DUChain must be read-locked.
+     * */
+    void setImports(const TopDUContext* context);
+
+    /// Removes all stored imports of @p context, used when it is removed from the DUChain or its imports are cleared.
+    void removeImports(const TopDUContext* context);
+
+    ///@return the files directly importing @p file
+    QVector<IndexedString> importers(const IndexedString& file) const;
+
+    /**
+     * @return all files that import @p file directly or indirectly, closest ones first
+     * @param maxDistance if not negative, only dependents up to this distance are returned
+     * */
+    QVector<Dependent> dependents(const IndexedString& file, int maxDistance = -1) const;
+
+    static IncludeGraph& self();
+
+private:
+    const QScopedPointer<class IncludeGraphPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(IncludeGraph)
+};
+}
+
+Q_DECLARE_TYPEINFO(KDevelop::IncludeGraph::Dependent, Q_MOVABLE_TYPE);
+
+#endif
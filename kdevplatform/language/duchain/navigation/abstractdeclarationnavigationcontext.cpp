@@ -112,7 +112,14 @@ QString AbstractDeclarationNavigationContext::html(bool shorten)
     modifyHtml() += QStringLiteral("<p>");
 
     if (!shorten) {
-        doc = ICore::self()->documentationController()->documentationForDeclaration(d->m_declaration.data());
+        // asking the documentation providers can take a while, so the tooltip is updated once they are done
+        auto* documentationController = ICore::self()->documentationController();
+        bool pending = false;
+        doc = documentationController->cachedDocumentationForDeclaration(d->m_declaration.data(), &pending);
+        if (pending) {
+            connect(documentationController, &IDocumentationController::documentationReady, this,
+                    &AbstractDeclarationNavigationContext::contentsChanged, Qt::UniqueConnection);
+        }
 
         const auto* function =
             dynamic_cast<const AbstractFunctionDeclaration*>(d->m_declaration.data());
@@ -19,17 +19,23 @@
 #include "persistentsymboltable.h"
 
 #include <QHash>
+#include <QVector>
 
 #include "declaration.h"
 #include "declarationid.h"
 #include "appendedlist.h"
 #include "serialization/itemrepository.h"
+#include "util/kdevhash.h"
 #include "identifier.h"
 #include "ducontext.h"
 #include "topducontext.h"
 #include "duchain.h"
 #include "duchainlock.h"
 #include <util/embeddedfreetree.h>
+#include <debug.h>
+
+#include <algorithm>
+#include <memory>
 
 //For now, just _always_ use the cache
 const uint MinimumCountForCache = 1;
@@ -154,32 +160,638 @@ public:
     const PersistentSymbolTableItem& m_item;
 };
 
+/**
+ * The name index maps short keys derived from the last component of an identifier
+ * to the identifiers, so that prefix and camel hump queries only need to look at
+ * the identifiers sharing the key with the query:
+ * - the first characters of the name, lower-cased
+ * - '#' followed by the initials of the first humps of the name, lower-cased
+ *
+ * Characters not in keyCharacters share the placeholder '.', so the keys only
+ * consist of those and can be packed into an integer, one byte per character.
+ *
+ * The identifiers of a key are sorted by their lower-cased name, or the initials of
+ * their humps for hump keys, so a query finds its matches with a binary search.
+ */
+const int NameIndexKeyLength = 3;
+
+using NameIndexKey = quint32;
+
+const char keyCharacters[] = "abcdefghijklmnopqrstuvwxyz0123456789_.";
+
+struct SymbolNameIndexEntry
+{
+    IndexedQualifiedIdentifier id;
+    uint leftChild = 0;
+    uint rightChild = 0;
+    /// whether the entry is stored under a hump key, which decides its sort key
+    bool humps = false;
+
+    /// @return the lower-cased name, or the lower-cased initials of the humps for hump keys
+    QString sortKey() const;
+
+    bool operator<(const SymbolNameIndexEntry& rhs) const
+    {
+        const int order = sortKey().compare(rhs.sortKey());
+        return order < 0 || (order == 0 && id < rhs.id);
+    }
+};
+
+class SymbolNameIndexEntryHandler
+{
+public:
+    static int leftChild(const SymbolNameIndexEntry& m_data)
+    {
+        return ( int )m_data.leftChild;
+    }
+    static void setLeftChild(SymbolNameIndexEntry& m_data, int child)
+    {
+        m_data.leftChild = ( uint )child;
+    }
+    static int rightChild(const SymbolNameIndexEntry& m_data)
+    {
+        return ( int )m_data.rightChild;
+    }
+    static void setRightChild(SymbolNameIndexEntry& m_data, int child)
+    {
+        m_data.rightChild = ( uint )child;
+    }
+    //Copies this item into the given one
+    static void copyTo(const SymbolNameIndexEntry& m_data, SymbolNameIndexEntry& data)
+    {
+        data = m_data;
+    }
+
+    static void createFreeItem(SymbolNameIndexEntry& data)
+    {
+        data = SymbolNameIndexEntry();
+        data.leftChild = (uint) - 1;
+        data.rightChild = (uint) - 1;
+    }
+
+    static bool isFree(const SymbolNameIndexEntry& m_data)
+    {
+        return !m_data.id.isValid();
+    }
+
+    static bool equals(const SymbolNameIndexEntry& m_data, const SymbolNameIndexEntry& rhs)
+    {
+        return m_data.id == rhs.id;
+    }
+};
+
+DEFINE_LIST_MEMBER_HASH(SymbolNameIndexItem, entries, SymbolNameIndexEntry)
+
+class SymbolNameIndexItem
+{
+public:
+    SymbolNameIndexItem()
+    {
+        initializeAppendedLists();
+    }
+    SymbolNameIndexItem(const SymbolNameIndexItem& rhs, bool dynamic = true) : key(rhs.key)
+        , centralFreeItem(rhs.centralFreeItem)
+    {
+        initializeAppendedLists(dynamic);
+        copyListsFrom(rhs);
+    }
+
+    ~SymbolNameIndexItem()
+    {
+        freeAppendedLists();
+    }
+
+    SymbolNameIndexItem& operator=(const SymbolNameIndexItem& rhs) = delete;
+
+    unsigned int hash() const
+    {
+        KDevHash hash;
+        return hash << key;
+    }
+
+    uint itemSize() const
+    {
+        return dynamicSize();
+    }
+
+    uint classSize() const
+    {
+        return sizeof(SymbolNameIndexItem);
+    }
+
+    NameIndexKey key = 0;
+    int centralFreeItem = -1;
+
+    START_APPENDED_LISTS(SymbolNameIndexItem);
+    APPENDED_LIST_FIRST(SymbolNameIndexItem, SymbolNameIndexEntry, entries);
+    END_APPENDED_LISTS(SymbolNameIndexItem, entries);
+};
+
+class SymbolNameIndexRequestItem
+{
+public:
+
+    SymbolNameIndexRequestItem(const SymbolNameIndexItem& item) : m_item(item)
+    {
+    }
+    enum {
+        AverageSize = 60 //This should be the approximate average size of an Item
+    };
+
+    unsigned int hash() const
+    {
+        return m_item.hash();
+    }
+
+    uint itemSize() const
+    {
+        return m_item.itemSize();
+    }
+
+    void createItem(SymbolNameIndexItem* item) const
+    {
+        new (item) SymbolNameIndexItem(m_item, false);
+    }
+
+    static void destroy(SymbolNameIndexItem* item, KDevelop::AbstractItemRepository&)
+    {
+        item->~SymbolNameIndexItem();
+    }
+
+    static bool persistent(const SymbolNameIndexItem*)
+    {
+        return true;
+    }
+
+    bool equals(const SymbolNameIndexItem* item) const
+    {
+        return m_item.key == item->key;
+    }
+
+    const SymbolNameIndexItem& m_item;
+};
+
+/// Splits @p name into its humps: "FooBar_baz" has the humps "Foo", "Bar" and "baz"
+QVector<QStringRef> camelHumps(const QString& name)
+{
+    QVector<QStringRef> humps;
+    int start = -1;
+    for (int i = 0; i < name.size(); ++i) {
+        const QChar c = name.at(i);
+        if (c == QLatin1Char('_')) {
+            if (start != -1) {
+                humps.append(name.midRef(start, i - start));
+                start = -1;
+            }
+            continue;
+        }
+        if (start == -1) {
+            start = i;
+        } else if (c.isUpper() && !name.at(i - 1).isUpper()) {
+            humps.append(name.midRef(start, i - start));
+            start = i;
+        }
+    }
+    if (start != -1) {
+        humps.append(name.midRef(start));
+    }
+    return humps;
+}
+
+/// @return the lower-cased initials of @p humps
+QString humpInitials(const QVector<QStringRef>& humps)
+{
+    QString initials;
+    initials.reserve(humps.size());
+    for (const QStringRef& hump : humps) {
+        initials.append(hump.at(0).toLower());
+    }
+    return initials;
+}
+
+QString SymbolNameIndexEntry::sortKey() const
+{
+    if (!id.isValid()) {
+        return QString();
+    }
+    const QualifiedIdentifier identifier = id.identifier();
+    if (identifier.isEmpty()) {
+        return QString();
+    }
+    const QString name = identifier.last().identifier().str();
+    return humps ? humpInitials(camelHumps(name)) : name.toLower();
+}
+
+/// @return the position of the first entry of @p item whose sort key is not less than @p sortKey, or -1
+int lowerBound(const SymbolNameIndexItem* item, const QString& sortKey)
+{
+    const SymbolNameIndexEntry* entries = item->entries();
+    int start = 0;
+    int end = item->entriesSize();
+    int currentBound = -1;
+    while (start < end) {
+        int center = (start + end) / 2;
+
+        //Skip free items, since they cannot be used for ordering
+        while (center < end && SymbolNameIndexEntryHandler::isFree(entries[center])) {
+            ++center;
+        }
+
+        if (center == end) {
+            end = (start + end) / 2;
+        } else if (entries[center].sortKey() < sortKey) {
+            start = center + 1;
+        } else {
+            currentBound = center;
+            end = (start + end) / 2;
+        }
+    }
+    return currentBound;
+}
+
+char keyCharacter(QChar c)
+{
+    const ushort lower = c.toLower().unicode();
+    if ((lower >= 'a' && lower <= 'z') || (lower >= '0' && lower <= '9') || lower == '_') {
+        return static_cast<char>(lower);
+    }
+    return '.';
+}
+
+NameIndexKey appendToKey(NameIndexKey key, char c)
+{
+    return (key << 8) | static_cast<uchar>(c);
+}
+
+/// @param length set to the count of name characters in the key
+NameIndexKey prefixKey(const QString& name, int* length = nullptr)
+{
+    const int count = qMin(name.size(), NameIndexKeyLength);
+    NameIndexKey key = 0;
+    for (int i = 0; i < count; ++i) {
+        key = appendToKey(key, keyCharacter(name.at(i)));
+    }
+    if (length) {
+        *length = count;
+    }
+    return key;
+}
+
+/// @param length set to the count of humps in the key
+NameIndexKey humpKey(const QVector<QStringRef>& humps, int* length = nullptr)
+{
+    const int count = qMin(humps.size(), NameIndexKeyLength);
+    NameIndexKey key = appendToKey(0, '#');
+    for (int i = 0; i < count; ++i) {
+        key = appendToKey(key, keyCharacter(humps[i].at(0)));
+    }
+    if (length) {
+        *length = count;
+    }
+    return key;
+}
+
+bool isHumpKey(NameIndexKey key)
+{
+    while (key > 0xff) {
+        key >>= 8;
+    }
+    return key == static_cast<uchar>('#');
+}
+
+/// @return the keys under which an identifier with the given last component is stored
+QVector<NameIndexKey> nameIndexKeys(const IndexedQualifiedIdentifier& id)
+{
+    const QualifiedIdentifier identifier = id.identifier();
+    if (identifier.isEmpty()) {
+        return {};
+    }
+    const QString name = identifier.last().identifier().str();
+    if (name.isEmpty()) {
+        return {};
+    }
+
+    QVector<NameIndexKey> keys{prefixKey(name)};
+    const auto humps = camelHumps(name);
+    // names with a single hump are found with the prefix already
+    if (humps.size() > 1) {
+        keys.append(humpKey(humps));
+    }
+    return keys;
+}
+
+/// Splits a camel hump query, unlike in names every upper-case character starts a hump: "FB" is "F", "B"
+QVector<QStringRef> queryCamelHumps(const QString& query)
+{
+    QVector<QStringRef> humps;
+    const bool lowerCase = (query == query.toLower());
+    int start = -1;
+    for (int i = 0; i < query.size(); ++i) {
+        const QChar c = query.at(i);
+        if (c == QLatin1Char('_')) {
+            if (start != -1) {
+                humps.append(query.midRef(start, i - start));
+                start = -1;
+            }
+            continue;
+        }
+        if (start != -1 && (c.isUpper() || (lowerCase && !query.contains(QLatin1Char('_'))))) {
+            humps.append(query.midRef(start, i - start));
+            start = -1;
+        }
+        if (start == -1) {
+            start = i;
+        }
+    }
+    if (start != -1) {
+        humps.append(query.midRef(start));
+    }
+    return humps;
+}
+
+bool matchesCamelHumps(const QVector<QStringRef>& queryHumps, const QString& name)
+{
+    const auto nameHumps = camelHumps(name);
+    if (nameHumps.size() < queryHumps.size()) {
+        return false;
+    }
+    for (int i = 0; i < queryHumps.size(); ++i) {
+        if (!nameHumps[i].startsWith(queryHumps[i], Qt::CaseInsensitive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @return all keys consisting of @p key followed by up to @p count further characters,
+///         as shorter queries cannot be looked up directly
+QVector<NameIndexKey> completedKeys(NameIndexKey key, int count)
+{
+    const int characterCount = sizeof(keyCharacters) - 1;
+
+    QVector<NameIndexKey> keys{key};
+    int first = 0;
+    for (int i = 0; i < count; ++i) {
+        const int last = keys.size();
+        keys.reserve(last + (last - first) * characterCount);
+        for (int j = first; j < last; ++j) {
+            for (int c = 0; c < characterCount; ++c) {
+                keys.append(appendToKey(keys[j], keyCharacters[c]));
+            }
+        }
+        first = last;
+    }
+    return keys;
+}
+
 template <class ValueType>
 struct CacheEntry
 {
-    using Data = KDevVarLengthArray<ValueType>;
-    using DataHash = QHash<TopDUContext::IndexedRecursiveImports, Data>;
+    static constexpr int Prealloc = 256;
+    using Data = KDevVarLengthArray<ValueType, Prealloc>;
+
+    struct Item
+    {
+        // shared, so an evicted array can outlive the entry while iterators still use it, see m_retiredData
+        std::shared_ptr<Data> data;
+        quint64 lastUse = 0;
+    };
+
+    using DataHash = QHash<TopDUContext::IndexedRecursiveImports, Item>;
 
     DataHash m_hash;
+
+    static qint64 itemSize(const Item& item)
+    {
+        // the preallocated storage is part of the item, only larger arrays allocate
+        const int allocated = item.data->capacity() > Prealloc ? item.data->capacity() : 0;
+        return sizeof(TopDUContext::IndexedRecursiveImports) + sizeof(Item) + sizeof(Data) + allocated * sizeof(ValueType);
+    }
+};
+
+struct ImportsCacheEntry
+{
+    PersistentSymbolTable::CachedIndexedRecursiveImports imports;
+    quint64 lastUse = 0;
+    qint64 size = 0;
 };
 
 class PersistentSymbolTablePrivate
 {
 public:
 
-    PersistentSymbolTablePrivate() : m_declarations(QStringLiteral("Persistent Declaration Table"))
+    PersistentSymbolTablePrivate()
+        : m_declarations(QStringLiteral("Persistent Declaration Table"))
+        , m_nameIndex(QStringLiteral("Persistent Symbol Name Index"))
     {
+        if (qEnvironmentVariableIsSet("KDEV_SYMBOLTABLE_CACHE_BUDGET_MB")) {
+            bool ok = false;
+            const int budget = qEnvironmentVariableIntValue("KDEV_SYMBOLTABLE_CACHE_BUDGET_MB", &ok);
+            if (ok && budget >= 0) {
+                m_statistics.budget = budget * qint64(1024 * 1024);
+            } else {
+                qCWarning(LANGUAGE) << "ignoring invalid KDEV_SYMBOLTABLE_CACHE_BUDGET_MB:"
+                                    << qgetenv("KDEV_SYMBOLTABLE_CACHE_BUDGET_MB");
+            }
+        }
     }
+
+    void removeFromDeclarationsCache(const IndexedQualifiedIdentifier& id);
+    void addToNameIndex(const IndexedQualifiedIdentifier& id);
+    void removeFromNameIndex(const IndexedQualifiedIdentifier& id);
+    void trimCache(qint64 targetSize);
+    void trimCacheIfNeeded();
+    void releaseRetiredData();
+
     //Maps declaration-ids to declarations
     // mutable as things like findIndex are not const
     mutable ItemRepository<PersistentSymbolTableItem, PersistentSymbolTableRequestItem, true, false> m_declarations;
 
+    //Maps keys derived from the names to the identifiers with declarations, see nameIndexKeys()
+    mutable ItemRepository<SymbolNameIndexItem, SymbolNameIndexRequestItem, true, false> m_nameIndex;
+
     mutable QHash<IndexedQualifiedIdentifier, CacheEntry<IndexedDeclaration>> m_declarationsCache;
 
     //We cache the imports so the currently used nodes are very close in memory, which leads to much better CPU cache utilization
-    mutable QHash<TopDUContext::IndexedRecursiveImports, PersistentSymbolTable::CachedIndexedRecursiveImports> m_importsCache;
+    mutable QHash<TopDUContext::IndexedRecursiveImports, ImportsCacheEntry> m_importsCache;
+
+    // the caches are bounded by evicting the least recently used entries, see trimCache()
+    mutable quint64 m_useCounter = 0;
+    mutable PersistentSymbolTable::CacheStatistics m_statistics = {0, 0, 0, 0, 64 * 1024 * 1024};
+
+    // The arrays of evicted entries. Lookups also trim the cache, while other threads holding the
+    // DUChain read lock may still iterate over the arrays, so they are only freed with the write lock held.
+    mutable std::vector<std::shared_ptr<CacheEntry<IndexedDeclaration>::Data>> m_retiredData;
 };
 
+void PersistentSymbolTablePrivate::removeFromDeclarationsCache(const IndexedQualifiedIdentifier& id)
+{
+    const auto it = m_declarationsCache.find(id);
+    if (it == m_declarationsCache.end()) {
+        return;
+    }
+    for (const auto& item : qAsConst(it->m_hash)) {
+        m_statistics.bytes -= CacheEntry<IndexedDeclaration>::itemSize(item);
+    }
+    m_declarationsCache.erase(it);
+}
+
+void PersistentSymbolTablePrivate::addToNameIndex(const IndexedQualifiedIdentifier& id)
+{
+    const auto keys = nameIndexKeys(id);
+
+    QMutexLocker lock(m_nameIndex.mutex());
+    for (const NameIndexKey key : keys) {
+        SymbolNameIndexItem item;
+        item.key = key;
+        SymbolNameIndexRequestItem request(item);
+
+        SymbolNameIndexEntry entry;
+        entry.id = id;
+        entry.humps = isHumpKey(key);
+
+        const uint index = m_nameIndex.findIndex(item);
+        if (index) {
+            DynamicItem<SymbolNameIndexItem, true> editableItem = m_nameIndex.dynamicItemFromIndex(index);
+
+            EmbeddedTreeAlgorithms<SymbolNameIndexEntry, SymbolNameIndexEntryHandler> alg(
+                editableItem->entries(), editableItem->entriesSize(), editableItem->centralFreeItem);
+            if (alg.indexOf(entry) != -1) {
+                continue;
+            }
+
+            EmbeddedTreeAddItem<SymbolNameIndexEntry, SymbolNameIndexEntryHandler> add(
+                const_cast<SymbolNameIndexEntry*>(editableItem->entries()),
+                editableItem->entriesSize(), editableItem->centralFreeItem, entry);
+
+            if (add.newItemCount() == editableItem->entriesSize()) {
+                //We're fine, the entry could be added to the existing list
+                continue;
+            }
+            //We need to resize. Update and fill the new item, and delete the old item.
+            item.entriesList().resize(add.newItemCount());
+            add.transferData(item.entriesList().data(), item.entriesList().size(), &item.centralFreeItem);
+            m_nameIndex.deleteItem(index);
+        } else {
+            item.entriesList().append(entry);
+        }
+
+        m_nameIndex.index(request);
+    }
+}
+
+void PersistentSymbolTablePrivate::removeFromNameIndex(const IndexedQualifiedIdentifier& id)
+{
+    const auto keys = nameIndexKeys(id);
+
+    QMutexLocker lock(m_nameIndex.mutex());
+    for (const NameIndexKey key : keys) {
+        SymbolNameIndexItem item;
+        item.key = key;
+        SymbolNameIndexRequestItem request(item);
+
+        const uint index = m_nameIndex.findIndex(item);
+        if (!index) {
+            continue;
+        }
+
+        SymbolNameIndexEntry entry;
+        entry.id = id;
+        entry.humps = isHumpKey(key);
+
+        DynamicItem<SymbolNameIndexItem, true> editableItem = m_nameIndex.dynamicItemFromIndex(index);
+
+        EmbeddedTreeAlgorithms<SymbolNameIndexEntry, SymbolNameIndexEntryHandler> alg(
+            editableItem->entries(), editableItem->entriesSize(), editableItem->centralFreeItem);
+        if (alg.indexOf(entry) == -1) {
+            continue;
+        }
+
+        EmbeddedTreeRemoveItem<SymbolNameIndexEntry, SymbolNameIndexEntryHandler> remove(
+            const_cast<SymbolNameIndexEntry*>(editableItem->entries()),
+            editableItem->entriesSize(), editableItem->centralFreeItem, entry);
+
+        const uint newItemCount = remove.newItemCount();
+        if (newItemCount == editableItem->entriesSize()) {
+            continue;
+        }
+        if (newItemCount) {
+            item.entriesList().resize(newItemCount);
+            remove.transferData(item.entriesList().data(), item.entriesList().size(), &item.centralFreeItem);
+        }
+        m_nameIndex.deleteItem(index);
+        if (newItemCount) {
+            m_nameIndex.index(request);
+        }
+    }
+}
+
+void PersistentSymbolTablePrivate::releaseRetiredData()
+{
+    ENSURE_CHAIN_WRITE_LOCKED
+    m_retiredData.clear();
+}
+
+void PersistentSymbolTablePrivate::trimCacheIfNeeded()
+{
+    if (m_statistics.bytes > m_statistics.budget) {
+        // leave some room, so that we don't have to trim again on the next change
+        trimCache(m_statistics.budget / 4 * 3);
+    }
+}
+
+void PersistentSymbolTablePrivate::trimCache(qint64 targetSize)
+{
+    if (m_statistics.bytes <= targetSize) {
+        return;
+    }
+
+    struct Candidate
+    {
+        quint64 lastUse;
+        const IndexedQualifiedIdentifier* id; // nullptr for entries of the imports cache
+        const TopDUContext::IndexedRecursiveImports* visibility;
+    };
+
+    QVector<Candidate> candidates;
+    for (auto it = m_declarationsCache.constBegin(), end = m_declarationsCache.constEnd(); it != end; ++it) {
+        for (auto itemIt = it->m_hash.constBegin(), itemEnd = it->m_hash.constEnd(); itemIt != itemEnd; ++itemIt) {
+            candidates.append({itemIt->lastUse, &it.key(), &itemIt.key()});
+        }
+    }
+    for (auto it = m_importsCache.constBegin(), end = m_importsCache.constEnd(); it != end; ++it) {
+        candidates.append({it->lastUse, nullptr, &it.key()});
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.lastUse < rhs.lastUse;
+    });
+
+    // copy the keys before erasing, the candidates point into the hashes
+    for (const Candidate& candidate : qAsConst(candidates)) {
+        if (m_statistics.bytes <= targetSize) {
+            break;
+        }
+        const TopDUContext::IndexedRecursiveImports visibility = *candidate.visibility;
+        if (candidate.id) {
+            const IndexedQualifiedIdentifier id = *candidate.id;
+            auto it = m_declarationsCache.find(id);
+            auto itemIt = it->m_hash.find(visibility);
+            m_statistics.bytes -= CacheEntry<IndexedDeclaration>::itemSize(*itemIt);
+            m_retiredData.push_back(std::move(itemIt->data));
+            it->m_hash.erase(itemIt);
+            if (it->m_hash.isEmpty()) {
+                m_declarationsCache.erase(it);
+            }
+        } else {
+            auto it = m_importsCache.find(visibility);
+            m_statistics.bytes -= it->size;
+            m_importsCache.erase(it);
+        }
+        ++m_statistics.evictions;
+    }
+}
+
 void PersistentSymbolTable::clearCache()
 {
     Q_D(PersistentSymbolTable);
@@ -189,9 +801,42 @@ void PersistentSymbolTable::clearCache()
         QMutexLocker lock(d->m_declarations.mutex());
         d->m_importsCache.clear();
         d->m_declarationsCache.clear();
+        d->m_retiredData.clear();
+        d->m_statistics.bytes = 0;
     }
 }
 
+void PersistentSymbolTable::trimCache()
+{
+    Q_D(PersistentSymbolTable);
+
+    ENSURE_CHAIN_WRITE_LOCKED
+
+    QMutexLocker lock(d->m_declarations.mutex());
+    d->trimCache(d->m_statistics.budget);
+    d->releaseRetiredData();
+}
+
+PersistentSymbolTable::CacheStatistics PersistentSymbolTable::cacheStatistics() const
+{
+    Q_D(const PersistentSymbolTable);
+
+    QMutexLocker lock(d->m_declarations.mutex());
+    return d->m_statistics;
+}
+
+void PersistentSymbolTable::setCacheMemoryBudget(qint64 bytes)
+{
+    Q_D(PersistentSymbolTable);
+
+    ENSURE_CHAIN_WRITE_LOCKED
+
+    QMutexLocker lock(d->m_declarations.mutex());
+    d->m_statistics.budget = bytes;
+    d->trimCache(bytes);
+    d->releaseRetiredData();
+}
+
 PersistentSymbolTable::PersistentSymbolTable()
     : d_ptr(new PersistentSymbolTablePrivate())
 {
@@ -212,7 +857,9 @@ void PersistentSymbolTable::addDeclaration(const IndexedQualifiedIdentifier& id,
     QMutexLocker lock(d->m_declarations.mutex());
     ENSURE_CHAIN_WRITE_LOCKED
 
-    d->m_declarationsCache.remove(id);
+    d->removeFromDeclarationsCache(id);
+    d->trimCacheIfNeeded();
+    d->releaseRetiredData();
 
     PersistentSymbolTableItem item;
     item.id = id;
@@ -250,6 +897,7 @@ void PersistentSymbolTable::addDeclaration(const IndexedQualifiedIdentifier& id,
         }
     } else {
         item.declarationsList().append(declaration);
+        d->addToNameIndex(id);
     }
 
     //This inserts the changed item
@@ -264,8 +912,10 @@ void PersistentSymbolTable::removeDeclaration(const IndexedQualifiedIdentifier&
     QMutexLocker lock(d->m_declarations.mutex());
     ENSURE_CHAIN_WRITE_LOCKED
 
-    d->m_declarationsCache.remove(id);
+    d->removeFromDeclarationsCache(id);
     Q_ASSERT(!d->m_declarationsCache.contains(id));
+    d->trimCacheIfNeeded();
+    d->releaseRetiredData();
 
     PersistentSymbolTableItem item;
     item.id = id;
@@ -306,6 +956,8 @@ void PersistentSymbolTable::removeDeclaration(const IndexedQualifiedIdentifier&
     //This inserts the changed item
     if (item.declarationsSize())
         d->m_declarations.index(request);
+    else
+        d->removeFromNameIndex(id);
 }
 
 struct DeclarationCacheVisitor
@@ -333,29 +985,42 @@ PersistentSymbolTable::FilteredDeclarationIterator PersistentSymbolTable::filter
 
     Declarations decls = declarations(id).iterator();
 
+    const quint64 use = ++d->m_useCounter;
+
     CachedIndexedRecursiveImports cachedImports;
 
-    QHash<TopDUContext::IndexedRecursiveImports,
-        CachedIndexedRecursiveImports>::const_iterator it = d->m_importsCache.constFind(visibility);
-    if (it != d->m_importsCache.constEnd()) {
-        cachedImports = *it;
+    auto it = d->m_importsCache.find(visibility);
+    if (it != d->m_importsCache.end()) {
+        it->lastUse = use;
+        cachedImports = it->imports;
     } else {
-        cachedImports = CachedIndexedRecursiveImports(visibility.set().stdSet());
-        d->m_importsCache.insert(visibility, cachedImports);
+        const auto importSet = visibility.set().stdSet();
+        cachedImports = CachedIndexedRecursiveImports(importSet);
+        const qint64 size = sizeof(TopDUContext::IndexedRecursiveImports) + sizeof(ImportsCacheEntry)
+                          + importSet.size() * sizeof(uint);
+        d->m_importsCache.insert(visibility, {cachedImports, use, size});
+        d->m_statistics.bytes += size;
     }
 
+    FilteredDeclarationIterator result;
+
     if (decls.dataSize() > MinimumCountForCache) {
         //Do visibility caching
         CacheEntry<IndexedDeclaration>& cached(d->m_declarationsCache[id]);
-        CacheEntry<IndexedDeclaration>::DataHash::const_iterator cacheIt = cached.m_hash.constFind(visibility);
-        if (cacheIt != cached.m_hash.constEnd())
-            return FilteredDeclarationIterator(Declarations::Iterator(cacheIt->constData(),
-                                                                      cacheIt->size(), -1), cachedImports);
+        CacheEntry<IndexedDeclaration>::DataHash::iterator cacheIt = cached.m_hash.find(visibility);
+        if (cacheIt != cached.m_hash.end()) {
+            ++d->m_statistics.hits;
+            cacheIt->lastUse = use;
+            return FilteredDeclarationIterator(Declarations::Iterator(cacheIt->data->constData(),
+                                                                      cacheIt->data->size(), -1), cachedImports);
+        }
 
-        CacheEntry<IndexedDeclaration>::DataHash::iterator insertIt = cached.m_hash.insert(visibility,
-                                                                                           KDevVarLengthArray<IndexedDeclaration>());
+        ++d->m_statistics.misses;
+        CacheEntry<IndexedDeclaration>::DataHash::iterator insertIt = cached.m_hash.insert(visibility, {});
+        insertIt->lastUse = use;
+        insertIt->data = std::make_shared<CacheEntry<IndexedDeclaration>::Data>();
 
-        KDevVarLengthArray<IndexedDeclaration>& cache(*insertIt);
+        KDevVarLengthArray<IndexedDeclaration>& cache(*insertIt->data);
 
         {
             using FilteredDeclarationCacheVisitor =
@@ -368,11 +1033,17 @@ PersistentSymbolTable::FilteredDeclarationIterator PersistentSymbolTable::filter
             FilteredDeclarationCacheVisitor visitor(v, decls.iterator(), cachedImports);
         }
 
-        return FilteredDeclarationIterator(Declarations::Iterator(cache.constData(),
-                                                                  cache.size(), -1), cachedImports, true);
+        d->m_statistics.bytes += CacheEntry<IndexedDeclaration>::itemSize(*insertIt);
+
+        result = FilteredDeclarationIterator(Declarations::Iterator(cache.constData(),
+                                                                    cache.size(), -1), cachedImports, true);
     } else {
-        return FilteredDeclarationIterator(decls.iterator(), cachedImports);
+        result = FilteredDeclarationIterator(decls.iterator(), cachedImports);
     }
+
+    // evicted arrays stay alive in m_retiredData, so this keeps the returned and all other iterators valid
+    d->trimCacheIfNeeded();
+    return result;
 }
 
 PersistentSymbolTable::Declarations PersistentSymbolTable::declarations(const IndexedQualifiedIdentifier& id) const
@@ -419,6 +1090,118 @@ void PersistentSymbolTable::declarations(const IndexedQualifiedIdentifier& id, u
     }
 }
 
+void PersistentSymbolTable::declarationsInTopContext(const IndexedQualifiedIdentifier& id, uint topContextIndex,
+                                                     KDevVarLengthArray<IndexedDeclaration>& target) const
+{
+    Q_D(const PersistentSymbolTable);
+
+    QMutexLocker lock(d->m_declarations.mutex());
+    ENSURE_CHAIN_READ_LOCKED
+
+    PersistentSymbolTableItem item;
+    item.id = id;
+
+    uint index = d->m_declarations.findIndex(item);
+    if (!index)
+        return;
+
+    const PersistentSymbolTableItem* repositoryItem = d->m_declarations.itemFromIndex(index);
+    const IndexedDeclaration* declarations = repositoryItem->declarations();
+    const int size = repositoryItem->declarationsSize();
+
+    EmbeddedTreeAlgorithms<IndexedDeclaration, IndexedDeclarationHandler> alg(declarations, size,
+                                                                              repositoryItem->centralFreeItem);
+    int position = alg.lowerBound(IndexedDeclaration(topContextIndex, 0), 0, size);
+    if (position == -1)
+        return;
+
+    for (; position < size; ++position) {
+        //Skip the free items of the embedded tree, all others are sorted by top-context
+        if (IndexedDeclarationHandler::isFree(declarations[position]))
+            continue;
+        if (declarations[position].topContextIndex() != topContextIndex)
+            break;
+        target.append(declarations[position]);
+    }
+}
+
+QVector<IndexedQualifiedIdentifier> PersistentSymbolTable::findIdentifiers(const QString& query, NameMatch match,
+                                                                           Qt::CaseSensitivity caseSensitivity,
+                                                                           int maxResults) const
+{
+    Q_D(const PersistentSymbolTable);
+
+    ENSURE_CHAIN_READ_LOCKED
+
+    QVector<IndexedQualifiedIdentifier> result;
+    if (query.isEmpty() || maxResults == 0) {
+        return result;
+    }
+
+    QVector<QStringRef> queryHumps;
+    if (match == CamelHumpMatch) {
+        queryHumps = queryCamelHumps(query);
+        if (queryHumps.size() < 2) {
+            // a single hump is just a prefix
+            match = PrefixMatch;
+            caseSensitivity = Qt::CaseInsensitive;
+        }
+    }
+
+    // the sort key of the entries in the buckets, which all matches start with
+    const QString sortKey = match == PrefixMatch ? query.toLower() : humpInitials(queryHumps);
+
+    QVector<NameIndexKey> keys;
+    int keyLength = 0;
+    if (match == PrefixMatch) {
+        const NameIndexKey key = prefixKey(query, &keyLength);
+        keys = completedKeys(key, NameIndexKeyLength - keyLength);
+    } else {
+        const NameIndexKey key = humpKey(queryHumps, &keyLength);
+        // names with fewer humps than the key length are stored with a shorter key
+        keys = completedKeys(key, NameIndexKeyLength - keyLength);
+    }
+
+    QMutexLocker lock(d->m_nameIndex.mutex());
+
+    for (const NameIndexKey key : qAsConst(keys)) {
+        SymbolNameIndexItem item;
+        item.key = key;
+
+        const uint index = d->m_nameIndex.findIndex(item);
+        if (!index) {
+            continue;
+        }
+
+        const SymbolNameIndexItem* repositoryItem = d->m_nameIndex.itemFromIndex(index);
+        const int first = lowerBound(repositoryItem, sortKey);
+        if (first == -1) {
+            continue;
+        }
+        for (uint i = static_cast<uint>(first); i < repositoryItem->entriesSize(); ++i) {
+            const SymbolNameIndexEntry& entry = repositoryItem->entries()[i];
+            if (SymbolNameIndexEntryHandler::isFree(entry)) {
+                continue;
+            }
+            if (!entry.sortKey().startsWith(sortKey)) {
+                break;
+            }
+
+            const QString name = entry.id.identifier().last().identifier().str();
+            const bool matches = match == PrefixMatch ? name.startsWith(query, caseSensitivity)
+                                                      : matchesCamelHumps(queryHumps, name);
+            if (matches) {
+                result.append(entry.id);
+                if (result.size() == maxResults) {
+                    return result;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 struct DebugVisitor
 {
     explicit DebugVisitor(const QTextStream& _out)
@@ -125,6 +125,14 @@ public:
     ///@warning DUChain must be read locked as long as the returned data is used
     void declarations(const IndexedQualifiedIdentifier& id, uint& count, const IndexedDeclaration*& declarations) const;
 
+    ///Retrieves the declarations for a given IndexedQualifiedIdentifier that are located in one top-context.
+    ///The declarations of an identifier are sorted by top-context, so this is a binary search instead of a scan.
+    ///@param topContextIndex The index of the top-context the declarations should be located in
+    ///@param target The found declarations are appended to this list
+    ///@warning DUChain must be read locked
+    void declarationsInTopContext(const IndexedQualifiedIdentifier& id, uint topContextIndex,
+                                  KDevVarLengthArray<IndexedDeclaration>& target) const;
+
     using Declarations = ConstantConvenientEmbeddedSet<IndexedDeclaration, IndexedDeclarationHandler>;
 
     ///Retrieves all the declarations for a given IndexedQualifiedIdentifier in an efficient way, and returns
@@ -146,15 +154,57 @@ public:
     FilteredDeclarationIterator filteredDeclarations(const IndexedQualifiedIdentifier& id,
                                                      const TopDUContext::IndexedRecursiveImports& visibility) const;
 
+    enum NameMatch {
+        /// The name starts with the query
+        PrefixMatch,
+        /// The humps of the query are prefixes of the leading humps of the name,
+        /// e.g. "FoBa" or "fb" match "FooBarBaz". An all-lowercase query is taken as one hump per character
+        CamelHumpMatch
+    };
+
+    ///Retrieves the identifiers in the symbol table whose last component matches @p query.
+    ///This uses a persistent index of the names, so it does not need to visit all identifiers.
+    ///@param caseSensitivity Only used for PrefixMatch, camel humps are always matched case-insensitively
+    ///@param maxResults Stop after this many results, -1 for no limit
+    ///@warning DUChain must be read locked
+    QVector<IndexedQualifiedIdentifier> findIdentifiers(const QString& query, NameMatch match,
+                                                        Qt::CaseSensitivity caseSensitivity = Qt::CaseInsensitive,
+                                                        int maxResults = -1) const;
+
     static PersistentSymbolTable& self();
 
     //Very expensive: Checks for problems in the symbol table
     void dump(const QTextStream& out);
 
-    //Clears the internal cache. Should be called regularly to save memory
-    //The duchain must be read-locked
+    //Clears the internal cache completely
+    //The duchain must be write-locked
     void clearCache();
 
+    ///Evicts the least recently used entries of the internal cache until it fits into the memory budget.
+    ///This is done automatically by lookups and when declarations are added or removed. The memory of
+    ///entries evicted by lookups is only freed with the write lock held, e.g. by calling this.
+    ///@warning DUChain must be write locked, as this invalidates iterators returned by filteredDeclarations()
+    void trimCache();
+
+    struct CacheStatistics
+    {
+        /// Lookups in filteredDeclarations() answered from the cache
+        quint64 hits = 0;
+        /// Lookups in filteredDeclarations() which had to filter the declarations
+        quint64 misses = 0;
+        /// Cache entries evicted to stay within the memory budget
+        quint64 evictions = 0;
+        /// Estimated memory used by the cache
+        qint64 bytes = 0;
+        qint64 budget = 0;
+    };
+    CacheStatistics cacheStatistics() const;
+
+    ///Sets the memory budget of the internal cache in bytes.
+    ///The default is 64 MiB, it can be overridden with the KDEV_SYMBOLTABLE_CACHE_BUDGET_MB environment variable.
+    ///@warning DUChain must be write locked
+    void setCacheMemoryBudget(qint64 bytes);
+
 private:
     // cannot use QScopedPointer yet, see comment in ~PersistentSymbolTable()
     class PersistentSymbolTablePrivate* const d_ptr;
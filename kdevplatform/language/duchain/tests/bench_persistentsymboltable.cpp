@@ -0,0 +1,162 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "bench_persistentsymboltable.h"
+
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/identifier.h>
+#include <language/duchain/persistentsymboltable.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QTest>
+#include <QVector>
+
+#include <limits>
+#include <set>
+
+QTEST_GUILESS_MAIN(BenchPersistentSymbolTable)
+
+using namespace KDevelop;
+
+namespace {
+// the synthetic project: every identifier is declared in a few of the files,
+// every translation unit sees a pseudo-random part of all files through its imports
+constexpr uint fileCount = 100000;
+constexpr int identifierCount = 20000;
+constexpr int declarationsPerIdentifier = 8;
+constexpr int translationUnitCount = 200;
+constexpr uint visibleFilesRatio = 50;
+constexpr int lookupsPerTranslationUnit = 500;
+
+inline uint mix(uint a, uint b)
+{
+    uint h = a * 0x9e3779b1u ^ (b + 0x7f4a7c15u + (a << 6) + (a >> 2));
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+inline uint fileIndex(uint a, uint b)
+{
+    return mix(a, b) % fileCount + 1;
+}
+
+QVector<IndexedQualifiedIdentifier> identifiers;
+QVector<TopDUContext::IndexedRecursiveImports> translationUnits;
+}
+
+void BenchPersistentSymbolTable::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChainWriteLocker lock;
+
+    identifiers.reserve(identifierCount);
+    for (int i = 0; i < identifierCount; ++i) {
+        const IndexedQualifiedIdentifier id(QualifiedIdentifier(QStringLiteral("ns%1::symbol%2").arg(i % 100).arg(i)));
+        identifiers << id;
+        for (int j = 0; j < declarationsPerIdentifier; ++j) {
+            PersistentSymbolTable::self().addDeclaration(id, IndexedDeclaration(fileIndex(i, j), j + 1));
+        }
+    }
+
+    translationUnits.reserve(translationUnitCount);
+    for (int i = 0; i < translationUnitCount; ++i) {
+        std::set<uint> imports;
+        for (uint file = 1; file <= fileCount; ++file) {
+            if (mix(file, i) % visibleFilesRatio == 0) {
+                imports.insert(file);
+            }
+        }
+        translationUnits << TopDUContext::IndexedRecursiveImports(imports);
+    }
+}
+
+void BenchPersistentSymbolTable::cleanupTestCase()
+{
+    {
+        DUChainWriteLocker lock;
+        for (int i = 0; i < identifierCount; ++i) {
+            for (int j = 0; j < declarationsPerIdentifier; ++j) {
+                PersistentSymbolTable::self().removeDeclaration(identifiers[i], IndexedDeclaration(fileIndex(i, j), j + 1));
+            }
+        }
+        PersistentSymbolTable::self().clearCache();
+        PersistentSymbolTable::self().setCacheMemoryBudget(64 * 1024 * 1024);
+        identifiers.clear();
+        translationUnits.clear();
+    }
+
+    TestCore::shutdown();
+}
+
+void BenchPersistentSymbolTable::filteredDeclarations_data()
+{
+    QTest::addColumn<qint64>("budget");
+
+    QTest::newRow("unbounded") << std::numeric_limits<qint64>::max();
+    QTest::newRow("64MiB") << qint64(64 * 1024 * 1024);
+    QTest::newRow("16MiB") << qint64(16 * 1024 * 1024);
+    QTest::newRow("1MiB") << qint64(1024 * 1024);
+}
+
+void BenchPersistentSymbolTable::filteredDeclarations()
+{
+    QFETCH(qint64, budget);
+
+    {
+        DUChainWriteLocker lock;
+        PersistentSymbolTable::self().clearCache();
+        PersistentSymbolTable::self().setCacheMemoryBudget(budget);
+    }
+    const auto statisticsBefore = PersistentSymbolTable::self().cacheStatistics();
+
+    uint found = 0;
+    QBENCHMARK {
+        for (int unit = 0; unit < translationUnitCount; ++unit) {
+            {
+                DUChainReadLocker lock;
+                for (int lookup = 0; lookup < lookupsPerTranslationUnit; ++lookup) {
+                    // look up the same identifiers repeatedly, like a file being reparsed
+                    const auto& id = identifiers[mix(unit % 10, lookup) % identifierCount];
+                    auto filter = PersistentSymbolTable::self().filteredDeclarations(id, translationUnits[unit]);
+                    for (; filter; ++filter) {
+                        ++found;
+                    }
+                }
+            }
+            // like the regular cleanup of the DUChain
+            DUChainWriteLocker lock;
+            PersistentSymbolTable::self().trimCache();
+        }
+    }
+
+    const auto statistics = PersistentSymbolTable::self().cacheStatistics();
+    qDebug() << "found" << found << "declarations,"
+             << "hits:" << statistics.hits - statisticsBefore.hits
+             << "misses:" << statistics.misses - statisticsBefore.misses
+             << "evictions:" << statistics.evictions - statisticsBefore.evictions
+             << "bytes:" << statistics.bytes;
+    QVERIFY(statistics.bytes <= budget);
+}
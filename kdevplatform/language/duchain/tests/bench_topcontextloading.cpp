@@ -0,0 +1,152 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "bench_topcontextloading.h"
+
+#include <language/duchain/declaration.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
+#include <language/duchain/topducontext.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchTopContextLoading)
+
+using namespace KDevelop;
+
+namespace {
+constexpr int contextCount = 200;
+constexpr int declarationsPerContext = 20;
+constexpr int cycleCount = 200;
+// when the memory of unloaded items is reused, the resident set size stays about the same over the cycles,
+// while a leak or heavy fragmentation let it grow by about the size of the items in every cycle
+constexpr qint64 maxResidentSizeGrowth = 4 * 1024;
+
+uint topContextIndex = 0;
+
+/// @return the number of items, after loading all of them
+int loadAllItems(DUContext* context)
+{
+    int ret = 1 + context->localDeclarations().size();
+    const auto childContexts = context->childContexts();
+    for (DUContext* child : childContexts) {
+        ret += loadAllItems(child);
+    }
+    return ret;
+}
+
+/// Stores the top-context and unloads it from memory, then loads all its items again
+int loadUnloadCycle()
+{
+    DUChain::self()->storeToDisk();
+
+    DUChainReadLocker lock;
+    TopDUContext* top = DUChain::self()->chainForIndex(topContextIndex);
+    return top ? loadAllItems(top) : 0;
+}
+
+/// @return the resident set size of this process in kB, or -1 if it is not known
+qint64 residentSize()
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+}
+
+void BenchTopContextLoading::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChain::self()->disablePersistentStorage(false);
+
+    DUChainWriteLocker lock;
+
+    const IndexedString url(QStringLiteral("/bench/topcontextloading.cpp"));
+    auto* top = new TopDUContext(url, RangeInRevision(0, 0, contextCount, 0), new ParsingEnvironmentFile(url));
+    DUChain::self()->addDocumentChain(top);
+    topContextIndex = top->ownIndex();
+
+    for (int i = 0; i < contextCount; ++i) {
+        auto* context = new DUContext(RangeInRevision(i, 0, i, declarationsPerContext), top);
+        for (int j = 0; j < declarationsPerContext; ++j) {
+            auto* declaration = new Declaration(RangeInRevision(i, j, i, j + 1), context);
+            declaration->setIdentifier(Identifier(QStringLiteral("declaration%1").arg(j)));
+        }
+    }
+}
+
+void BenchTopContextLoading::cleanupTestCase()
+{
+    {
+        DUChainWriteLocker lock;
+        if (TopDUContext* top = DUChain::self()->chainForIndex(topContextIndex)) {
+            DUChain::self()->removeDocumentChain(top);
+        }
+    }
+
+    DUChain::self()->disablePersistentStorage(true);
+    TestCore::shutdown();
+}
+
+void BenchTopContextLoading::loadUnload()
+{
+    const int expectedItems = 1 + contextCount * (1 + declarationsPerContext);
+
+    QBENCHMARK {
+        QCOMPARE(loadUnloadCycle(), expectedItems);
+    }
+}
+
+void BenchTopContextLoading::residentSizeAfterCycles()
+{
+    if (residentSize() < 0) {
+        QSKIP("The resident set size is only known on Linux");
+    }
+
+    // warm up, so the repositories and caches are already filled
+    loadUnloadCycle();
+    const qint64 before = residentSize();
+
+    for (int cycle = 0; cycle < cycleCount; ++cycle) {
+        loadUnloadCycle();
+    }
+
+    const qint64 after = residentSize();
+    const qint64 growth = after - before;
+    qDebug() << "resident set size after" << cycleCount << "load/unload cycles:" << after << "kB, grew by"
+             << growth << "kB";
+    QVERIFY2(growth <= maxResidentSizeGrowth,
+             qPrintable(QStringLiteral("the resident set size grew by %1 kB, more than %2 kB")
+                        .arg(growth).arg(maxResidentSizeGrowth)));
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "bench_typerepository.h"
+
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/types/functiontype.h>
+#include <language/duchain/types/indexedtype.h>
+#include <language/duchain/types/integraltype.h>
+#include <language/duchain/types/pointertype.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QTest>
+#include <QVector>
+
+QTEST_GUILESS_MAIN(BenchTypeRepository)
+
+using namespace KDevelop;
+
+namespace {
+constexpr int typeCount = 1000;
+constexpr int lookupCount = 100000;
+
+QVector<IndexedType> types;
+}
+
+void BenchTypeRepository::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChainWriteLocker lock;
+
+    // a mix of simple and nested types, like the ones declarations refer to
+    types.reserve(typeCount);
+    for (int i = 0; i < typeCount; ++i) {
+        AbstractType::Ptr integral(new IntegralType(IntegralType::TypeInt));
+        integral->setModifiers(i % 16);
+
+        auto* pointerType = new PointerType;
+        pointerType->setBaseType(integral);
+        pointerType->setModifiers(i / 16 % 4);
+        const AbstractType::Ptr pointer(pointerType);
+
+        FunctionType::Ptr function(new FunctionType);
+        function->setReturnType(pointer);
+        for (int argument = 0; argument < i % 5; ++argument) {
+            function->addArgument(integral);
+        }
+
+        types << function->indexed();
+    }
+}
+
+void BenchTypeRepository::cleanupTestCase()
+{
+    types.clear();
+    TestCore::shutdown();
+}
+
+void BenchTypeRepository::abstractType_data()
+{
+    QTest::addColumn<bool>("keepPrevious");
+
+    // the usual pattern: decode the type, look at it, drop it again
+    QTest::newRow("temporary") << false;
+    // every type is still referenced on the next lookup of the same index, so it cannot be reused
+    QTest::newRow("referenced") << true;
+}
+
+void BenchTypeRepository::abstractType()
+{
+    QFETCH(bool, keepPrevious);
+
+    DUChainReadLocker lock;
+
+    QVector<AbstractType::Ptr> previous(typeCount);
+    int functions = 0;
+    QBENCHMARK {
+        for (int lookup = 0; lookup < lookupCount; ++lookup) {
+            // repeatedly looks up the same few types, like completion does for the items of a scope
+            const int index = lookup % 50;
+            const AbstractType::Ptr type = types[index].abstractType();
+            functions += type->whichType() == AbstractType::TypeFunction;
+            if (keepPrevious) {
+                previous[index] = type;
+            }
+        }
+    }
+    QVERIFY(functions > 0);
+}
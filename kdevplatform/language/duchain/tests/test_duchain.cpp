@@ -33,6 +33,7 @@
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/persistentsymboltable.h>
 #include <language/duchain/codemodel.h>
+#include <language/duchain/includegraph.h>
 #include <language/duchain/types/typesystemdata.h>
 #include <language/duchain/types/integraltype.h>
 #include <language/duchain/types/typeregister.h>
@@ -395,6 +396,72 @@ void TestDUChain::testSymbolTableValid()
     PersistentSymbolTable::self().dump(QTextStream(stdout));
 }
 
+void TestDUChain::testSymbolTableFindIdentifiers_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("match");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<QStringList>("expected");
+
+    const auto prefix = static_cast<int>(PersistentSymbolTable::PrefixMatch);
+    const auto camelHump = static_cast<int>(PersistentSymbolTable::CamelHumpMatch);
+
+    QTest::newRow("prefix") << "FindIdFoo" << prefix << false
+                            << QStringList{"FindIdFooBar", "ns::findIdFooBaz", "findidfoo"};
+    QTest::newRow("prefix-case-sensitive") << "FindIdFoo" << prefix << true << QStringList{"FindIdFooBar"};
+    QTest::newRow("prefix-short") << "fi" << prefix << false
+                                  << QStringList{"FindIdFooBar", "ns::findIdFooBaz", "findidfoo", "FindId_x",
+                                                 "FinA", "Fizz"};
+    QTest::newRow("prefix-none") << "FindIdX" << prefix << false << QStringList{};
+    QTest::newRow("camel") << "FiIdFB" << camelHump << false << QStringList{"FindIdFooBar", "ns::findIdFooBaz"};
+    QTest::newRow("camel-lowercase") << "fifb" << camelHump << false << QStringList{"FindIdFooBar", "ns::findIdFooBaz"};
+    QTest::newRow("camel-short") << "FI" << camelHump << false
+                                 << QStringList{"FindIdFooBar", "ns::findIdFooBaz", "FindId_x", "fändIdÜber"};
+    QTest::newRow("camel-underscore") << "fin_id" << camelHump << false
+                                      << QStringList{"FindIdFooBar", "ns::findIdFooBaz", "FindId_x"};
+    // names with characters other than letters, digits and underscores, also after the query
+    QTest::newRow("prefix-tilde") << "~Find" << prefix << false << QStringList{"ns::~FindIdDtor"};
+    QTest::newRow("prefix-tilde-short") << "~" << prefix << false << QStringList{"ns::~FindIdDtor"};
+    QTest::newRow("prefix-non-ascii") << "FÄ" << prefix << false << QStringList{"fändIdÜber"};
+    QTest::newRow("camel-non-ascii") << "FIÜ" << camelHump << false << QStringList{"fändIdÜber"};
+}
+
+void TestDUChain::testSymbolTableFindIdentifiers()
+{
+    QFETCH(QString, query);
+    QFETCH(int, match);
+    QFETCH(bool, caseSensitive);
+    QFETCH(QStringList, expected);
+
+    const QStringList identifiers = {"FindIdFooBar", "ns::findIdFooBaz", "findidfoo", "FindId_x",
+                                     "ns::~FindIdDtor", "fändIdÜber", "FinA", "Fizz"};
+
+    DUChainWriteLocker lock;
+    uint localIndex = 1;
+    for (const QString& identifier : identifiers) {
+        PersistentSymbolTable::self().addDeclaration(IndexedQualifiedIdentifier(QualifiedIdentifier(identifier)),
+                                                     IndexedDeclaration(1, localIndex++));
+    }
+
+    QStringList found;
+    const auto ids = PersistentSymbolTable::self().findIdentifiers(query,
+        static_cast<PersistentSymbolTable::NameMatch>(match), caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    for (const auto& id : ids) {
+        found << id.identifier().toString();
+    }
+    found.sort();
+    expected.sort();
+    QCOMPARE(found, expected);
+
+    localIndex = 1;
+    for (const QString& identifier : identifiers) {
+        PersistentSymbolTable::self().removeDeclaration(IndexedQualifiedIdentifier(QualifiedIdentifier(identifier)),
+                                                        IndexedDeclaration(1, localIndex++));
+    }
+    QVERIFY(PersistentSymbolTable::self().findIdentifiers(query,
+        static_cast<PersistentSymbolTable::NameMatch>(match)).isEmpty());
+}
+
 void TestDUChain::testIndexedStrings()
 {
     int testCount  = 600000;
@@ -583,6 +650,153 @@ uint collectNaiveNodeCount(uint currentNode)
     return ret;
 }
 
+void TestDUChain::testIncludeGraph()
+{
+    const IndexedString header("/includegraph/a.h");
+    const IndexedString middle("/includegraph/b.h");
+    const IndexedString other("/includegraph/c.h");
+    const IndexedString source("/includegraph/main.cpp");
+
+    DUChainWriteLocker lock;
+    auto createContext = [](const IndexedString& url) {
+        auto top = new TopDUContext(url, {0, 0, 1, 0});
+        DUChain::self()->addDocumentChain(top);
+        return top;
+    };
+    auto headerContext = createContext(header);
+    auto middleContext = createContext(middle);
+    auto otherContext = createContext(other);
+    middleContext->addImportedParentContext(headerContext);
+    otherContext->addImportedParentContext(headerContext);
+
+    // the imports of a context are added when registering it
+    auto sourceContext = new TopDUContext(source, {0, 0, 1, 0});
+    sourceContext->addImportedParentContext(middleContext);
+    sourceContext->addImportedParentContext(otherContext);
+    QVERIFY(IncludeGraph::self().importers(middle).isEmpty());
+    DUChain::self()->addDocumentChain(sourceContext);
+
+    auto& graph = IncludeGraph::self();
+    QCOMPARE(graph.importers(middle), QVector<IndexedString>{source});
+    QCOMPARE(graph.importers(header).size(), 2);
+    QVERIFY(graph.importers(header).contains(middle));
+    QVERIFY(graph.importers(header).contains(other));
+
+    auto dependents = graph.dependents(header);
+    QCOMPARE(dependents.size(), 3);
+    QCOMPARE(dependents.last().file, source);
+    QCOMPARE(dependents.last().distance, 2);
+    QCOMPARE(graph.dependents(header, 1).size(), 2);
+
+    // the edge stays as long as any context of the file imports the header
+    auto otherContext2 = createContext(other);
+    otherContext2->addImportedParentContext(headerContext);
+    otherContext->removeImportedParentContext(headerContext);
+    QVERIFY(graph.importers(header).contains(other));
+    DUChain::self()->removeDocumentChain(otherContext2);
+    QCOMPARE(graph.importers(header), QVector<IndexedString>{middle});
+
+    sourceContext->clearImportedParentContexts();
+    QVERIFY(graph.importers(middle).isEmpty());
+    QVERIFY(graph.importers(other).isEmpty());
+
+    // deleting a context removes its edges
+    DUChain::self()->removeDocumentChain(middleContext);
+    QVERIFY(graph.dependents(header).isEmpty());
+
+    DUChain::self()->removeDocumentChain(sourceContext);
+    DUChain::self()->removeDocumentChain(otherContext);
+    DUChain::self()->removeDocumentChain(headerContext);
+}
+
+void TestDUChain::testFindLocalDeclarationsInLargeContext()
+{
+    DUChainWriteLocker lock;
+    auto top = new TopDUContext(IndexedString("/tmp/largecontext"), {0, 0, INT_MAX, INT_MAX});
+    DUChain::self()->addDocumentChain(top);
+
+    // large enough to be looked up through the identifier hash
+    auto context = new DUContext({0, 0, 1000, 0}, top);
+    QVector<Declaration*> declarations;
+    for (int i = 0; i < 200; ++i) {
+        auto declaration = new Declaration({i, 0, i, 1}, context);
+        declaration->setIdentifier(Identifier(QStringLiteral("decl%1").arg(i % 100)));
+        declarations << declaration;
+    }
+
+    const Identifier decl7(QStringLiteral("decl7"));
+    QCOMPARE(context->findLocalDeclarations(decl7).size(), 2);
+    QCOMPARE(context->findLocalDeclarations(decl7).first(), declarations[7]);
+
+    // the hash needs to be updated on renames, removals and declarations propagated from children
+    declarations[7]->setIdentifier(Identifier(QStringLiteral("renamed")));
+    QCOMPARE(context->findLocalDeclarations(decl7), QList<Declaration*>{declarations[107]});
+    QCOMPARE(context->findLocalDeclarations(Identifier(QStringLiteral("renamed"))).size(), 1);
+
+    delete declarations[107];
+    QVERIFY(context->findLocalDeclarations(decl7).isEmpty());
+
+    auto child = new DUContext({500, 0, 600, 0}, context);
+    child->setPropagateDeclarations(true);
+    auto propagated = new Declaration({500, 0, 500, 1}, child);
+    propagated->setIdentifier(decl7);
+    QCOMPARE(context->findLocalDeclarations(decl7), QList<Declaration*>{propagated});
+
+    child->setPropagateDeclarations(false);
+    QVERIFY(context->findLocalDeclarations(decl7).isEmpty());
+
+    DUChain::self()->removeDocumentChain(top);
+}
+
+void TestDUChain::testFindItemsAtInLargeContext()
+{
+    DUChainWriteLocker lock;
+    auto top = new TopDUContext(IndexedString("/tmp/largecontext"), {0, 0, INT_MAX, INT_MAX});
+    DUChain::self()->addDocumentChain(top);
+
+    // large enough to be looked up through the range index
+    auto context = new DUContext({0, 0, 1000, 0}, top);
+    QVector<Declaration*> declarations;
+    for (int i = 0; i < 200; ++i) {
+        declarations << new Declaration({i, 0, i, 5}, context);
+        context->createUse(i, {i, 10, i, 15});
+    }
+
+    QCOMPARE(context->findDeclarationAt({7, 2}), declarations[7]);
+    QVERIFY(!context->findDeclarationAt({7, 5}));
+    QCOMPARE(context->findLocalDeclarationAt({7, 5}, RangeInRevision::IncludeBackEdge), declarations[7]);
+    QVERIFY(!context->findDeclarationAt({2000, 0}));
+    QCOMPARE(context->findUseAt({42, 12}), 42);
+    QCOMPARE(context->findUseAt({42, 7}), -1);
+    QCOMPARE(context->findLocalUseAt({42, 15}, RangeInRevision::IncludeBackEdge), 42);
+
+    // the first matching declaration in the context wins for overlapping ranges
+    auto enclosing = new Declaration({6, 3, 9, 0}, context);
+    QCOMPARE(context->findDeclarationAt({6, 2}), declarations[6]);
+    QCOMPARE(context->findDeclarationAt({7, 2}), enclosing);
+    QCOMPARE(context->findDeclarationAt({8, 7}), enclosing);
+
+    // the index needs to be updated when ranges change, and when declarations are added or removed
+    delete enclosing;
+    QCOMPARE(context->findDeclarationAt({7, 2}), declarations[7]);
+
+    declarations[7]->setRange({500, 0, 500, 5});
+    QVERIFY(!context->findDeclarationAt({7, 2}));
+    QCOMPARE(context->findDeclarationAt({500, 2}), declarations[7]);
+
+    context->changeUseRange(42, {600, 0, 600, 5});
+    QCOMPARE(context->findUseAt({42, 12}), -1);
+    QCOMPARE(context->findUseAt({600, 2}), 42);
+
+    context->deleteUse(0);
+    QCOMPARE(context->findUseAt({1, 12}), 0);
+
+    context->deleteUses();
+    QCOMPARE(context->findUseAt({1, 12}), -1);
+
+    DUChain::self()->removeDocumentChain(top);
+}
+
 void TestDUChain::testImportStructure()
 {
     Timer total;
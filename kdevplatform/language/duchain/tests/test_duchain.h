@@ -40,8 +40,13 @@ private Q_SLOTS:
     void testStringSets();
 #endif
     void testSymbolTableValid();
+    void testSymbolTableFindIdentifiers();
+    void testSymbolTableFindIdentifiers_data();
     void testIndexedStrings();
     void testImportStructure();
+    void testIncludeGraph();
+    void testFindLocalDeclarationsInLargeContext();
+    void testFindItemsAtInLargeContext();
     void testLockForWrite();
     void testLockForRead();
     void testLockForReadWrite();
@@ -0,0 +1,91 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "test_typerepository.h"
+
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/types/integraltype.h>
+#include <language/duchain/types/indexedtype.h>
+#include <serialization/itemrepositoryregistry.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestTypeRepository)
+
+using namespace KDevelop;
+
+void TestTypeRepository::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+}
+
+void TestTypeRepository::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestTypeRepository::testSharedType()
+{
+    IntegralType::Ptr type(new IntegralType(IntegralType::TypeInt));
+    type->setSizeOf(1234);
+    const IndexedType indexed(type);
+
+    const AbstractType::Ptr first = indexed.abstractType();
+    const AbstractType::Ptr second = indexed.abstractType();
+    QCOMPARE(first.data(), second.data());
+
+    // modifying a clone leaves the shared type alone
+    AbstractType::Ptr modified(first->clone());
+    modified->setModifiers(AbstractType::ConstModifier);
+    QVERIFY(!first->equals(modified.data()));
+    QVERIFY(indexed.abstractType()->equals(type.data()));
+}
+
+void TestTypeRepository::testReusedIndex()
+{
+    IntegralType::Ptr deleted(new IntegralType(IntegralType::TypeInt));
+    deleted->setSizeOf(-2);
+    const uint index = IndexedType(deleted).index();
+    const AbstractType::Ptr cached = IndexedType(index).abstractType();
+
+    // nothing references the type, so the cleanup deletes it from the repository
+    {
+        DUChainWriteLocker lock;
+        globalItemRepositoryRegistry().finalCleanup();
+    }
+
+    // create types of the same size until one of them gets the freed index
+    IntegralType::Ptr reused;
+    for (int sizeOf = 1; sizeOf < 1000000 && !reused; ++sizeOf) {
+        IntegralType::Ptr type(new IntegralType(IntegralType::TypeInt));
+        type->setSizeOf(sizeOf);
+        if (IndexedType(type).index() == index)
+            reused = type;
+    }
+    QVERIFY(reused);
+
+    const AbstractType::Ptr found = IndexedType(index).abstractType();
+    QVERIFY(found.data() != cached.data());
+    QVERIFY(found->equals(reused.data()));
+    QVERIFY(!found->equals(deleted.data()));
+}
@@ -23,6 +23,7 @@
 #include <limits>
 
 #include "persistentsymboltable.h"
+#include "includegraph.h"
 #include "problem.h"
 #include "declaration.h"
 #include "duchain.h"
@@ -1059,6 +1060,9 @@ void TopDUContext::clearImportedParentContexts()
 
     m_local->clearImportedContextsRecursively();
 
+    if (inDUChain())
+        IncludeGraph::self().removeImports(this);
+
     Q_ASSERT(m_local->m_recursiveImports.count() == 0);
 
     Q_ASSERT(m_local->m_indexedRecursiveImports.count() == 1);
@@ -1082,6 +1086,10 @@ void TopDUContext::addImportedParentContext(DUContext* context, const CursorInRe
     DUContext::addImportedParentContext(context, position, anonymous, temporary);
 
     m_local->addImportedContextRecursively(static_cast<TopDUContext*>(context), temporary, true);
+
+    //The imports of contexts that are not registered yet are added by DUChain::addDocumentChain()
+    if (inDUChain())
+        IncludeGraph::self().addImport(this, static_cast<TopDUContext*>(context));
 }
 
 void TopDUContext::removeImportedParentContext(DUContext* context)
@@ -1089,6 +1097,9 @@ void TopDUContext::removeImportedParentContext(DUContext* context)
     DUContext::removeImportedParentContext(context);
 
     m_local->removeImportedContextRecursively(static_cast<TopDUContext*>(context), true);
+
+    if (context && inDUChain())
+        IncludeGraph::self().removeImport(this, static_cast<TopDUContext*>(context));
 }
 
 void TopDUContext::addImportedParentContexts(const QVector<QPair<TopDUContext*, CursorInRevision>>& contexts,
@@ -1108,6 +1119,12 @@ void TopDUContext::removeImportedParentContexts(const QList<TopDUContext*>& cont
     }
 
     m_local->removeImportedContextsRecursively(contexts, true);
+
+    if (inDUChain()) {
+        for (TopDUContext* context : contexts) {
+            IncludeGraph::self().removeImport(this, context);
+        }
+    }
 }
 
 /// Returns true if this object is registered in the du-chain. If it is not, all sub-objects(context, declarations, etc.)
@@ -32,6 +32,7 @@
 #include "ducontextdata.h"
 #include "ducontextdynamicdata.h"
 #include "duchainregister.h"
+#include "duchainitemarena.h"
 #include "serialization/itemrepository.h"
 #include "problem.h"
 #include <debug.h>
@@ -397,7 +398,7 @@ Item TopDUContextDynamicData::DUChainItemStorage<Item>::itemForIndex(uint index)
                         );
 
         auto& item = items[realIndex];
-        item = dynamic_cast<typename PtrType<Item>::value>(DUChainItemSystem::self().create(itemData));
+        item = dynamic_cast<typename PtrType<Item>::value>(DUChainItemSystem::self().create(itemData, data->m_itemArena));
         if (!item) {
             //When this happens, the item has not been registered correctly.
             //We can stop here, because else we will get crashes later.
@@ -482,6 +483,7 @@ TopDUContextDynamicData::TopDUContextDynamicData(TopDUContext* topContext)
     , m_mappedData(nullptr)
     , m_mappedDataSize(0)
     , m_itemRetrievalForbidden(false)
+    , m_itemArena(nullptr)
 {
 }
 
@@ -495,6 +497,11 @@ void KDevelop::TopDUContextDynamicData::clear()
 TopDUContextDynamicData::~TopDUContextDynamicData()
 {
     unmap();
+
+    // items still alive keep their arena alive
+    if (m_itemArena) {
+        m_itemArena->deref();
+    }
 }
 
 void KDevelop::TopDUContextDynamicData::unmap()
@@ -569,6 +576,10 @@ void TopDUContextDynamicData::loadData() const
     m_declarations.loadData(file);
     m_problems.loadData(file);
 
+    if (!m_itemArena) {
+        m_itemArena = new DUChainItemArena;
+    }
+
 #ifdef USE_MMAP
 
     m_mappedData = file->map(file->pos(), file->size() - file->pos());
@@ -648,9 +659,10 @@ void TopDUContextDynamicData::deleteOnDisk()
 
     m_onDisk = false;
 
-    bool successfullyRemoved = QFile::remove(filePath());
-    Q_UNUSED(successfullyRemoved);
-    Q_ASSERT(successfullyRemoved);
+    //During a write, the file is moved into the journal of the repository, so it is restored if the write is interrupted
+    globalItemRepositoryRegistry().journalFile(filePath(), ItemRepositoryRegistry::MoveFile);
+    QFile::remove(filePath());
+    Q_ASSERT(!QFile::exists(filePath()));
     qCDebug(LANGUAGE) << "deletion ready";
 }
 
@@ -735,6 +747,8 @@ void TopDUContextDynamicData::store()
 
     QDir().mkpath(basePath());
 
+    globalItemRepositoryRegistry().journalFile(filePath(), ItemRepositoryRegistry::MoveFile);
+
     QFile file(filePath());
     if (file.open(QIODevice::WriteOnly)) {
         file.resize(0);
@@ -32,6 +32,7 @@ class Declaration;
 class IndexedString;
 class IndexedDUContext;
 class DUChainBaseData;
+class DUChainItemArena;
 
 ///This class contains dynamic data of a top-context, and also the repository that contains all the data within this top-context.
 class TopDUContextDynamicData
@@ -178,6 +179,9 @@ private:
     mutable uchar* m_mappedData;
     mutable size_t m_mappedDataSize;
     mutable bool m_itemRetrievalForbidden;
+
+    // the items loaded from disk are placed into this arena, so they are freed together on unload
+    mutable DUChainItemArena* m_itemArena;
 };
 }
 
@@ -314,6 +314,7 @@ protected:
     TYPE_DECLARE_DATA(AbstractType)
 
     friend class AbstractTypeDataRequest;
+    friend class TypeRepository;
 };
 
 /**
@@ -48,6 +48,8 @@ public:
     /**
      * Access the type.
      *
+     * The type may be shared with other users, clone() it before modifying it.
+     *
      * \returns the type pointer, or null if this index is invalid.
      */
     AbstractType::Ptr abstractType() const;
@@ -17,6 +17,7 @@
  */
 
 #include "typeregister.h"
+#include "typerepository.h"
 
 #include <debug.h>
 
@@ -93,6 +94,7 @@ void TypeSystem::registerTypeClassInternal(AbstractTypeFactory* repo, uint dataC
 void TypeSystem::unregisterTypeClassInternal(uint identity)
 {
     qCDebug(LANGUAGE) << "Unregistering type class" << identity;
+    TypeRepository::clearTypeCache();
     AbstractTypeFactory* repo = m_factories.take(identity);
     Q_ASSERT(repo);
     delete repo;
@@ -18,6 +18,7 @@
 
 #include "typerepository.h"
 
+#include <QCache>
 #include <QMutex>
 #include <QMutexLocker>
 
@@ -31,6 +32,33 @@
 #define ASSERT_ON_PROBLEM
 
 namespace KDevelop  {
+namespace {
+///Maximum count of decoded types kept in the type cache
+constexpr int typeCacheSize = 10000;
+
+/**
+ * Decoded types by repository index, so typeForIndex() does not need to allocate a new type every time.
+ *
+ * The cached types are shared by everyone who looked them up, so they must not be modified.
+ * Users that want to change a type clone() it first. A cached type that was modified anyway is
+ * thrown away on the next lookup.
+ *
+ * The cached types point into the repository, AbstractTypeDataRequest::destroy() removes them
+ * when the repository deletes the item.
+ */
+struct TypeCache
+{
+    QMutex mutex;
+    QCache<uint, AbstractType::Ptr> types{typeCacheSize};
+};
+
+TypeCache& typeCache()
+{
+    static TypeCache cache;
+    return cache;
+}
+}
+
 class AbstractTypeDataRequest
 {
 public:
@@ -72,8 +100,13 @@ public:
         item->inRepository = true;
     }
 
-    static void destroy(AbstractTypeData* item, KDevelop::AbstractItemRepository&)
+    static void destroy(AbstractTypeData* item, uint index, KDevelop::AbstractItemRepository&)
     {
+        {
+            auto& cache = typeCache();
+            QMutexLocker lock(&cache.mutex);
+            cache.types.remove(index);
+        }
         TypeSystem::self().callDestructor(item);
     }
 
@@ -140,8 +173,32 @@ AbstractType::Ptr TypeRepository::typeForIndex(uint index)
     if (index == 0)
         return AbstractType::Ptr();
 
-    return AbstractType::Ptr(TypeSystem::self().create(const_cast<AbstractTypeData*>(typeRepository()->itemFromIndex(
-                                                                                         index))));
+    auto& cache = typeCache();
+    {
+        QMutexLocker lock(&cache.mutex);
+        if (AbstractType::Ptr* cached = cache.types.object(index)) {
+            if (!(*cached)->d_ptr->m_dynamic)
+                return *cached;
+            //Someone modified the shared type instead of cloning it
+            cache.types.remove(index);
+        }
+    }
+
+    //Not under the cache mutex, destroy() locks it while the repository is locked
+    AbstractType::Ptr type(TypeSystem::self().create(const_cast<AbstractTypeData*>(typeRepository()->itemFromIndex(index))));
+
+    QMutexLocker lock(&cache.mutex);
+    if (AbstractType::Ptr* cached = cache.types.object(index))
+        return *cached;
+    cache.types.insert(index, new AbstractType::Ptr(type));
+    return type;
+}
+
+void TypeRepository::clearTypeCache()
+{
+    auto& cache = typeCache();
+    QMutexLocker lock(&cache.mutex);
+    cache.types.clear();
 }
 
 void TypeRepository::increaseReferenceCount(uint index, ReferenceCountManager* manager)
@@ -29,11 +29,14 @@ class TypeRepository
 {
 public:
     static uint indexForType(const AbstractType::Ptr& input);
+    ///The returned type may be shared with other users, clone() it before modifying it
     static AbstractType::Ptr typeForIndex(uint index);
     static void increaseReferenceCount(uint index);
     static void decreaseReferenceCount(uint index);
     static void increaseReferenceCount(uint index, ReferenceCountManager* manager);
     static void decreaseReferenceCount(uint index, ReferenceCountManager* manager);
+    ///Drops all shared types, so none of them outlives the type class it belongs to
+    static void clearTypeCache();
 };
 
 AbstractRepositoryManager* typeRepositoryManager();
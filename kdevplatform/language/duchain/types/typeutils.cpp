@@ -39,8 +39,11 @@ TypePtr<KDevelop::AbstractType> unAliasedType(const TypePtr<KDevelop::AbstractTy
 
         type = alias->type();
 
-        if (hadModifiers && type)
+        if (hadModifiers && type) {
+            //Types from the repository are shared, so modify a copy
+            type = TypePtr<KDevelop::AbstractType>(type->clone());
             type->setModifiers(type->modifiers() | hadModifiers);
+        }
 
         alias = type.cast<KDevelop::TypeAliasType>();
         ++depth;
@@ -68,8 +71,10 @@ AbstractType::Ptr targetType(const AbstractType::Ptr& _base, const TopDUContext*
         } else {
             base = alias->type();
         }
-        if ((alias || ref) && hadModifiers && base)
+        if ((alias || ref) && hadModifiers && base) {
+            base = AbstractType::Ptr(base->clone());
             base->setModifiers(base->modifiers() | hadModifiers);
+        }
 
         ref = base.cast<ReferenceType>();
         pnt = base.cast<PointerType>();
@@ -91,8 +96,10 @@ AbstractType::Ptr targetTypeKeepAliases(const AbstractType::Ptr& _base, const To
         if (ref) {
             uint hadModifiers = ref->modifiers();
             base = ref->baseType();
-            if (hadModifiers && base)
+            if (hadModifiers && base) {
+                base = AbstractType::Ptr(base->clone());
                 base->setModifiers(base->modifiers() | hadModifiers);
+            }
         } else if (pnt) {
             base = pnt->baseType();
         }
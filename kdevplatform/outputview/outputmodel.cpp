@@ -29,13 +29,18 @@
 #include <interfaces/idocumentcontroller.h>
 #include <util/kdevstringhandler.h>
 
+#include <QDataStream>
+#include <QDir>
 #include <QStringList>
+#include <QTemporaryFile>
 #include <QTimer>
 #include <QThread>
 #include <QFont>
 #include <QFontDatabase>
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <set>
 
 namespace KDevelop
@@ -55,6 +60,97 @@ static const int BATCH_SIZE = 50;
  */
 static const int BATCH_AGGREGATE_TIME_DELAY = 50;
 
+/**
+ * Default number of lines that are kept in memory. Older lines are moved
+ * to a temporary file and read back when they are needed again.
+ */
+static const int DEFAULT_MAX_LINES_IN_MEMORY = 100000;
+
+/**
+ * Number of lines that are written to and read from the spill file in one go.
+ */
+static const int SPILL_BLOCK_SIZE = 256;
+
+/**
+ * Number of spilled blocks that are kept decoded, enough to cover what a view
+ * shows at once while scrolling or searching through old output.
+ */
+static const int SPILL_CACHE_BLOCKS = 8;
+
+static QDataStream& operator<<(QDataStream& stream, const FilteredItem& item)
+{
+    return stream << item.originalLine << static_cast<qint8>(item.type) << item.isActivatable
+                  << item.url << item.lineNo << item.columnNo;
+}
+
+static QDataStream& operator>>(QDataStream& stream, FilteredItem& item)
+{
+    qint8 type;
+    stream >> item.originalLine >> type >> item.isActivatable >> item.url >> item.lineNo >> item.columnNo;
+    item.type = static_cast<FilteredItem::FilteredOutputItemType>(type);
+    return stream;
+}
+
+/**
+ * Append-only file holding the output lines that were evicted from memory,
+ * stored as compressed blocks of SPILL_BLOCK_SIZE items.
+ */
+class OutputSpillFile
+{
+public:
+    OutputSpillFile()
+        : m_file(QDir::tempPath() + QLatin1String("/kdevelop-output-XXXXXX"))
+    {
+    }
+
+    bool open()
+    {
+        return m_file.open();
+    }
+
+    bool appendBlock(const FilteredItem* items, int count)
+    {
+        QByteArray data;
+        {
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            for (int i = 0; i < count; ++i) {
+                stream << items[i];
+            }
+        }
+        data = qCompress(data, 1);
+
+        const qint64 offset = m_file.size();
+        if (!m_file.seek(offset) || m_file.write(data) != data.size()) {
+            return false;
+        }
+        m_blockOffsets << offset;
+        m_blockSizes << data.size();
+        return true;
+    }
+
+    QVector<FilteredItem> readBlock(int block)
+    {
+        QVector<FilteredItem> items;
+        if (!m_file.seek(m_blockOffsets.at(block))) {
+            return items;
+        }
+        const QByteArray data = qUncompress(m_file.read(m_blockSizes.at(block)));
+        QDataStream stream(data);
+        items.reserve(SPILL_BLOCK_SIZE);
+        while (!stream.atEnd()) {
+            FilteredItem item;
+            stream >> item;
+            items << item;
+        }
+        return items;
+    }
+
+private:
+    QTemporaryFile m_file;
+    QVector<qint64> m_blockOffsets;
+    QVector<int> m_blockSizes;
+};
+
 class ParseWorker : public QObject
 {
     Q_OBJECT
@@ -184,12 +280,25 @@ public:
     ~OutputModelPrivate();
     bool isValidIndex( const QModelIndex&, int currentRowCount ) const;
 
+    /// Returns the item in @p row, reading it back from the spill file if necessary
+    FilteredItem item(int row) const;
+    int rowCount() const { return m_spilledRows + m_filteredItems.size(); }
+
     OutputModel* model;
     ParseWorker* worker;
 
+    /// The most recent items, starting at row m_spilledRows
     QVector<FilteredItem> m_filteredItems;
+    /// Number of items that were moved to m_spillFile, always a multiple of SPILL_BLOCK_SIZE
+    int m_spilledRows = 0;
+    int m_maxLinesInMemory = DEFAULT_MAX_LINES_IN_MEMORY;
+    std::unique_ptr<OutputSpillFile> m_spillFile;
+    /// Recently read blocks of the spill file, most recently used first
+    mutable QVector<QPair<int, QVector<FilteredItem>>> m_spillCache;
+
     // We use std::set because that is ordered
     std::set<int> m_errorItems; // Indices of all items that we want to move to using previous and next
+    QVector<int> m_activatableItems; // Sorted indices of all activatable items, used when there are no errors
     QUrl m_buildDir;
 
     void linesParsed(const QVector<KDevelop::FilteredItem>& items)
@@ -199,15 +308,80 @@ public:
         m_filteredItems.reserve(m_filteredItems.size() + items.size());
         for (const FilteredItem& item : items) {
             if( item.type == FilteredItem::ErrorItem ) {
-                m_errorItems.insert(m_filteredItems.size());
+                m_errorItems.insert(rowCount());
+            }
+            if (item.isActivatable) {
+                m_activatableItems << rowCount();
             }
             m_filteredItems << item;
         }
 
         model->endInsertRows();
+
+        spillItems();
+    }
+
+    /// Moves the oldest items to the spill file once there are noticeably more than m_maxLinesInMemory
+    void spillItems()
+    {
+        if (m_maxLinesInMemory <= 0) {
+            return;
+        }
+        const int excess = m_filteredItems.size() - m_maxLinesInMemory;
+        if (excess < std::max(SPILL_BLOCK_SIZE, m_maxLinesInMemory / 4)) {
+            return;
+        }
+
+        if (!m_spillFile) {
+            m_spillFile.reset(new OutputSpillFile);
+            if (!m_spillFile->open()) {
+                qCWarning(OUTPUTVIEW) << "could not create a file for old output lines, keeping everything in memory";
+                m_spillFile.reset();
+                m_maxLinesInMemory = 0;
+                return;
+            }
+        }
+
+        const int blocks = excess / SPILL_BLOCK_SIZE;
+        int spilled = 0;
+        for (; spilled < blocks * SPILL_BLOCK_SIZE; spilled += SPILL_BLOCK_SIZE) {
+            if (!m_spillFile->appendBlock(m_filteredItems.constData() + spilled, SPILL_BLOCK_SIZE)) {
+                qCWarning(OUTPUTVIEW) << "failed to write old output lines, keeping the rest in memory";
+                m_maxLinesInMemory = 0;
+                break;
+            }
+        }
+        m_filteredItems.remove(0, spilled);
+        m_spilledRows += spilled;
     }
 };
 
+FilteredItem OutputModelPrivate::item(int row) const
+{
+    if (row >= m_spilledRows) {
+        return m_filteredItems.at(row - m_spilledRows);
+    }
+
+    const int block = row / SPILL_BLOCK_SIZE;
+    auto it = std::find_if(m_spillCache.begin(), m_spillCache.end(), [block](const QPair<int, QVector<FilteredItem>>& entry) {
+        return entry.first == block;
+    });
+    if (it == m_spillCache.end()) {
+        if (m_spillCache.size() >= SPILL_CACHE_BLOCKS) {
+            m_spillCache.removeLast();
+        }
+        m_spillCache.prepend(qMakePair(block, m_spillFile->readBlock(block)));
+    } else if (it != m_spillCache.begin()) {
+        auto entry = *it;
+        m_spillCache.erase(it);
+        m_spillCache.prepend(entry);
+    }
+
+    const QVector<FilteredItem>& items = m_spillCache.first().second;
+    const int offset = row % SPILL_BLOCK_SIZE;
+    return offset < items.size() ? items.at(offset) : FilteredItem();
+}
+
 OutputModelPrivate::OutputModelPrivate( OutputModel* model_, const QUrl& builddir)
 : model(model_)
 , worker(new ParseWorker )
@@ -259,9 +433,9 @@ QVariant OutputModel::data(const QModelIndex& idx , int role ) const
         switch( role )
         {
             case Qt::DisplayRole:
-                return d->m_filteredItems.at( idx.row() ).originalLine;
+                return d->item( idx.row() ).originalLine;
             case OutputModel::OutputItemTypeRole:
-                return static_cast<int>(d->m_filteredItems.at( idx.row() ).type);
+                return static_cast<int>(d->item( idx.row() ).type);
             case Qt::FontRole:
                 return QFontDatabase::systemFont(QFontDatabase::FixedFont);
         }
@@ -274,7 +448,7 @@ int OutputModel::rowCount( const QModelIndex& parent ) const
     Q_D(const OutputModel);
 
     if( !parent.isValid() )
-        return d->m_filteredItems.count();
+        return d->rowCount();
     return 0;
 }
 
@@ -294,7 +468,7 @@ void OutputModel::activate( const QModelIndex& index )
     qCDebug(OUTPUTVIEW) << "Model activated" << index.row();
 
 
-    FilteredItem item = d->m_filteredItems.at( index.row() );
+    FilteredItem item = d->item( index.row() );
     if( item.isActivatable )
     {
         qCDebug(OUTPUTVIEW) << "activating:" << item.lineNo << item.url;
@@ -323,10 +497,8 @@ QModelIndex OutputModel::firstHighlightIndex()
         return index( *d->m_errorItems.begin(), 0, QModelIndex() );
     }
 
-    for( int row = 0; row < rowCount(); ++row ) {
-        if( d->m_filteredItems.at( row ).isActivatable ) {
-            return index( row, 0, QModelIndex() );
-        }
+    if( !d->m_activatableItems.isEmpty() ) {
+        return index( d->m_activatableItems.first(), 0, QModelIndex() );
     }
 
     return QModelIndex();
@@ -349,13 +521,14 @@ QModelIndex OutputModel::nextHighlightIndex( const QModelIndex &currentIdx )
         return index( *next, 0, QModelIndex() );
     }
 
-    for( int row = 0; row < rowCount(); ++row )
+    if( !d->m_activatableItems.isEmpty() )
     {
-        int currow = (startrow + row) % rowCount();
-        if( d->m_filteredItems.at( currow ).isActivatable )
-        {
-            return index( currow, 0, QModelIndex() );
-        }
+        // Jump to the next activatable item, wrapping around at the end
+        auto next = std::lower_bound( d->m_activatableItems.constBegin(), d->m_activatableItems.constEnd(), startrow );
+        if( next == d->m_activatableItems.constEnd() )
+            next = d->m_activatableItems.constBegin();
+
+        return index( *next, 0, QModelIndex() );
     }
     return QModelIndex();
 }
@@ -364,8 +537,7 @@ QModelIndex OutputModel::previousHighlightIndex( const QModelIndex &currentIdx )
 {
     Q_D(OutputModel);
 
-    //We have to ensure that startrow is >= rowCount - 1 to get a positive value from the % operation.
-    int startrow = rowCount() + (d->isValidIndex(currentIdx, rowCount()) ? currentIdx.row() : rowCount()) - 1;
+    int startrow = (d->isValidIndex(currentIdx, rowCount()) ? currentIdx.row() : rowCount()) - 1;
 
     if(!d->m_errorItems.empty())
     {
@@ -382,13 +554,16 @@ QModelIndex OutputModel::previousHighlightIndex( const QModelIndex &currentIdx )
         return index( *previous, 0, QModelIndex() );
     }
 
-    for ( int row = 0; row < rowCount(); ++row )
+    if( !d->m_activatableItems.isEmpty() )
     {
-        int currow = (startrow - row) % rowCount();
-        if( d->m_filteredItems.at( currow ).isActivatable )
-        {
-            return index( currow, 0, QModelIndex() );
-        }
+        // Jump to the previous activatable item, wrapping around at the beginning
+        auto previous = std::upper_bound( d->m_activatableItems.constBegin(), d->m_activatableItems.constEnd(), startrow );
+        if( previous == d->m_activatableItems.constBegin() )
+            previous = d->m_activatableItems.constEnd();
+
+        --previous;
+
+        return index( *previous, 0, QModelIndex() );
     }
     return QModelIndex();
 }
@@ -401,10 +576,8 @@ QModelIndex OutputModel::lastHighlightIndex()
         return index( *d->m_errorItems.rbegin(), 0, QModelIndex() );
     }
 
-    for( int row = rowCount()-1; row >=0; --row ) {
-        if( d->m_filteredItems.at( row ).isActivatable ) {
-            return index( row, 0, QModelIndex() );
-        }
+    if( !d->m_activatableItems.isEmpty() ) {
+        return index( d->m_activatableItems.last(), 0, QModelIndex() );
     }
 
     return QModelIndex();
@@ -450,6 +623,21 @@ void OutputModel::setFilteringStrategy(IFilterStrategy* filterStrategy)
                               Q_ARG(KDevelop::IFilterStrategy*, filterStrategy));
 }
 
+void OutputModel::setMaxLinesInMemory(int lines)
+{
+    Q_D(OutputModel);
+
+    d->m_maxLinesInMemory = lines;
+    d->spillItems();
+}
+
+int OutputModel::maxLinesInMemory() const
+{
+    Q_D(const OutputModel);
+
+    return d->m_maxLinesInMemory;
+}
+
 void OutputModel::appendLines( const QStringList& lines )
 {
     Q_D(OutputModel);
@@ -480,6 +668,11 @@ void OutputModel::clear()
     ensureAllDone();
     beginResetModel();
     d->m_filteredItems.clear();
+    d->m_spilledRows = 0;
+    d->m_spillFile.reset();
+    d->m_spillCache.clear();
+    d->m_errorItems.clear();
+    d->m_activatableItems.clear();
     endResetModel();
 }
 
@@ -74,6 +74,15 @@ public:
     void setFilteringStrategy(const OutputFilterStrategy& currentStrategy);
     void setFilteringStrategy(IFilterStrategy* filterStrategy);
 
+    /**
+     * Limits the number of output lines kept in memory. Older lines are moved to a
+     * temporary file and read back when they are displayed or searched again.
+     *
+     * @param lines the number of lines to keep in memory, 0 to keep everything in memory
+     */
+    void setMaxLinesInMemory(int lines);
+    int maxLinesInMemory() const;
+
 public Q_SLOTS:
     void appendLine( const QString& );
     void appendLines( const QStringList& );
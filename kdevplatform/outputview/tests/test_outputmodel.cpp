@@ -19,6 +19,7 @@
 #include "test_outputmodel.h"
 #include "testlinebuilderfunctions.h"
 #include "../outputmodel.h"
+#include "../filtereditem.h"
 
 #include <QTest>
 #include <QStandardPaths>
@@ -124,4 +125,33 @@ void TestOutputModel::bench_data()
     QTest::newRow("static-analysis-filter-longline") << OutputModel::StaticAnalysisFilter << longLine;
 }
 
+void TestOutputModel::testSpilledLines()
+{
+    const QStringList lines = generateLines();
+
+    OutputModel testee(QUrl::fromLocalFile(QStringLiteral("/tmp/build-foo")));
+    testee.setFilteringStrategy(OutputModel::CompilerFilter);
+    testee.setMaxLinesInMemory(1000);
+
+    testee.appendLines(lines);
+    while(testee.rowCount() != lines.count()) {
+        QCoreApplication::instance()->processEvents();
+    }
+
+    // old lines are read back from disk, in random order to exercise the block cache
+    for (int row : {0, lines.count() - 1, 1, 5000, 257, 255, 9000, 42}) {
+        QCOMPARE(testee.data(testee.index(row)).toString(), lines.at(row));
+    }
+
+    // navigation through the errors works across the spilled lines
+    const QModelIndex first = testee.firstHighlightIndex();
+    QVERIFY(first.isValid());
+    const QModelIndex last = testee.lastHighlightIndex();
+    QVERIFY(last.isValid());
+    QVERIFY(first.row() < last.row());
+    QCOMPARE(testee.nextHighlightIndex(last), first);
+    QCOMPARE(testee.previousHighlightIndex(first), last);
+    QCOMPARE(testee.data(first, OutputModel::OutputItemTypeRole).toInt(), static_cast<int>(FilteredItem::ErrorItem));
+}
+
 }
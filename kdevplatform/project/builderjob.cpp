@@ -32,6 +32,9 @@
 #include <project/projectmodel.h>
 #include <project/interfaces/iprojectbuilder.h>
 #include <project/interfaces/ibuildsystemmanager.h>
+#include <util/path.h>
+
+#include <algorithm>
 
 using namespace KDevelop;
 
@@ -40,9 +43,84 @@ struct SubJobData
     BuilderJob::BuildType type;
     KJob* job;
     ProjectBaseItem* item;
+    /// further items built by the same job
+    QList<ProjectBaseItem*> coalescedItems;
 };
 Q_DECLARE_TYPEINFO(SubJobData, Q_MOVABLE_TYPE);
 
+namespace {
+
+/**
+ * Runs all its subjobs at the same time, failing if any of them failed.
+ *
+ * With @p abortOnError, the other subjobs are killed as soon as one of them failed.
+ */
+class ParallelBuildJob : public KCompositeJob
+{
+    Q_OBJECT
+
+public:
+    ParallelBuildJob(const QList<KJob*>& jobs, bool abortOnError)
+        : m_abortOnError(abortOnError)
+    {
+        setCapabilities(Killable);
+        for (KJob* job : jobs) {
+            addSubjob(job);
+        }
+    }
+
+    void start() override
+    {
+        const auto jobs = subjobs();
+        for (KJob* job : jobs) {
+            job->start();
+        }
+        if (jobs.isEmpty()) {
+            emitResult();
+        }
+    }
+
+protected Q_SLOTS:
+    void slotResult(KJob* job) override
+    {
+        if (job->error() && !error()) {
+            setError(job->error());
+            setErrorText(job->errorText());
+        }
+        removeSubjob(job);
+
+        if (job->error() && m_abortOnError) {
+            const auto jobs = subjobs();
+            for (KJob* sibling : jobs) {
+                removeSubjob(sibling);
+                sibling->kill();
+            }
+        }
+
+        if (!hasSubjobs()) {
+            emitResult();
+        }
+    }
+
+protected:
+    bool doKill() override
+    {
+        const auto jobs = subjobs();
+        for (KJob* job : jobs) {
+            if (!job->kill()) {
+                return false;
+            }
+            removeSubjob(job);
+        }
+        return true;
+    }
+
+private:
+    const bool m_abortOnError;
+};
+
+}
+
 namespace KDevelop
 {
 class BuilderJobPrivate
@@ -57,6 +135,8 @@ public:
     BuilderJob* q;
 
     void addJob( BuilderJob::BuildType, ProjectBaseItem* );
+    KJob* createJob( BuilderJob::BuildType, ProjectBaseItem* ) const;
+    void addBuildJobs( const QList<ProjectBaseItem*>& items );
     bool failOnFirstError;
 
     QString buildTypeToString( BuilderJob::BuildType type ) const;
@@ -100,7 +180,7 @@ QString BuilderJobPrivate::buildTypeToString(BuilderJob::BuildType type) const
     return QString();
 }
 
-void BuilderJobPrivate::addJob( BuilderJob::BuildType t, ProjectBaseItem* item )
+KJob* BuilderJobPrivate::createJob( BuilderJob::BuildType t, ProjectBaseItem* item ) const
 {
     Q_ASSERT(item);
     qCDebug(PROJECT) << "adding build job for item:" << item->text();
@@ -111,7 +191,7 @@ void BuilderJobPrivate::addJob( BuilderJob::BuildType t, ProjectBaseItem* item )
     if( !item->project()->buildSystemManager() )
     {
         qCWarning(PROJECT) << "no buildsystem manager for:" << item->text() << item->project()->name();
-        return;
+        return nullptr;
     }
     qCDebug(PROJECT) << "got build system manager";
     Q_ASSERT(item->project()->buildSystemManager()->builder());
@@ -138,12 +218,106 @@ void BuilderJobPrivate::addJob( BuilderJob::BuildType t, ProjectBaseItem* item )
             }
             break;
     }
+    return j;
+}
+
+void BuilderJobPrivate::addJob( BuilderJob::BuildType t, ProjectBaseItem* item )
+{
+    KJob* j = createJob( t, item );
     if( j )
     {
         q->addCustomJob( t, j, item );
     }
 }
 
+void BuilderJobPrivate::addBuildJobs( const QList<ProjectBaseItem*>& items )
+{
+    // Items sharing a build directory are handed to the builder at once, so it can build them
+    // with a single process. The order of first appearance is kept.
+    struct BuildGroup
+    {
+        IProject* project;
+        Path buildDirectory;
+        QList<ProjectBaseItem*> items;
+    };
+    QVector<BuildGroup> groups;
+    for (ProjectBaseItem* item : items) {
+        IBuildSystemManager* manager = item->project()->buildSystemManager();
+        const Path buildDirectory = manager ? manager->buildDirectory( item ) : Path();
+        auto it = std::find_if(groups.begin(), groups.end(), [&](const BuildGroup& group) {
+            return group.project == item->project() && group.buildDirectory == buildDirectory;
+        });
+        if (it == groups.end()) {
+            groups.append({item->project(), buildDirectory, {}});
+            it = groups.end() - 1;
+        }
+        it->items.append(item);
+    }
+
+    // Different projects are built at the same time, the jobs of one project one after another,
+    // as builders do not support running concurrently on the same project.
+    QVector<QPair<IProject*, QVector<SubJobData>>> projectJobs;
+    for (const BuildGroup& group : qAsConst(groups)) {
+        auto it = std::find_if(projectJobs.begin(), projectJobs.end(), [&](const QPair<IProject*, QVector<SubJobData>>& jobs) {
+            return jobs.first == group.project;
+        });
+        if (it == projectJobs.end()) {
+            projectJobs.append({group.project, {}});
+            it = projectJobs.end() - 1;
+        }
+
+        KJob* j = nullptr;
+        if (group.items.size() > 1 && group.project->buildSystemManager()) {
+            j = group.project->buildSystemManager()->builder()->buildItems( group.items );
+        }
+        if (j) {
+            qCDebug(PROJECT) << "building" << group.items.size() << "items in" << group.buildDirectory << "with a single job";
+            it->second.append({BuilderJob::Build, j, group.items.first(), group.items.mid(1)});
+            continue;
+        }
+        for (ProjectBaseItem* item : group.items) {
+            if ((j = createJob( BuilderJob::Build, item ))) {
+                it->second.append({BuilderJob::Build, j, item, {}});
+            }
+        }
+    }
+
+    if (projectJobs.size() < 2) {
+        for (const auto& jobs : qAsConst(projectJobs)) {
+            for (const SubJobData& data : jobs.second) {
+                q->addCustomJob( data.type, data.job, data.item );
+                if (!data.coalescedItems.isEmpty()) {
+                    m_metadata.last().coalescedItems += data.coalescedItems;
+                }
+            }
+        }
+        return;
+    }
+
+    QList<KJob*> parallelJobs;
+    SubJobData parallelData{BuilderJob::Build, nullptr, nullptr, {}};
+    for (const auto& jobs : qAsConst(projectJobs)) {
+        if (jobs.second.isEmpty()) {
+            continue;
+        }
+        QList<KJob*> sequentialJobs;
+        for (const SubJobData& data : jobs.second) {
+            sequentialJobs << data.job;
+            parallelData.coalescedItems << data.item;
+            parallelData.coalescedItems << data.coalescedItems;
+        }
+        parallelJobs << (sequentialJobs.size() == 1 ? sequentialJobs.first() : new ExecuteCompositeJob(nullptr, sequentialJobs));
+    }
+    if (parallelData.coalescedItems.isEmpty()) {
+        return;
+    }
+    parallelData.item = parallelData.coalescedItems.takeFirst();
+
+    auto* job = new ParallelBuildJob(parallelJobs, failOnFirstError);
+    q->addCustomJob( BuilderJob::Build, job, parallelData.item );
+    m_metadata.last().coalescedItems += parallelData.coalescedItems;
+}
+
 BuilderJob::BuilderJob()
     : d_ptr(new BuilderJobPrivate(this))
 {
@@ -155,6 +329,11 @@ void BuilderJob::addItems( BuildType t, const QList<ProjectBaseItem*>& items )
 {
     Q_D(BuilderJob);
 
+    if (t == Build && items.size() > 1) {
+        d->addBuildJobs( items );
+        return;
+    }
+
     for (ProjectBaseItem* item : items) {
         d->addJob( t, item );
     }
@@ -164,6 +343,16 @@ void BuilderJob::addProjects( BuildType t, const QList<IProject*>& projects )
 {
     Q_D(BuilderJob);
 
+    if (t == Build && projects.size() > 1) {
+        QList<ProjectBaseItem*> items;
+        items.reserve(projects.size());
+        for (IProject* project : projects) {
+            items << project->projectItem();
+        }
+        d->addBuildJobs( items );
+        return;
+    }
+
     for (IProject* project : projects) {
         d->addJob( t, project->projectItem() );
     }
@@ -228,6 +417,11 @@ void BuilderJob::updateJobName()
             if( !registeredItems.contains( subjob.item ) ) {
                 registeredItems.append( subjob.item );
             }
+            for (ProjectBaseItem* item : subjob.coalescedItems) {
+                if( !registeredItems.contains( item ) ) {
+                    registeredItems.append( item );
+                }
+            }
             if( !buildTypes.contains( subjob.type ) ) {
                 buildTypes.append( subjob.type );
             }
@@ -273,3 +467,4 @@ void BuilderJob::start()
     ExecuteCompositeJob::start();
 }
 
+#include "builderjob.moc"
@@ -25,6 +25,11 @@ IProjectBuilder::~IProjectBuilder()
 {
 }
 
+KJob* IProjectBuilder::buildItems(const QList<ProjectBaseItem*>& items)
+{
+    Q_UNUSED(items)
+    return nullptr;
+}
 
 KJob* IProjectBuilder::configure(IProject*)
 {
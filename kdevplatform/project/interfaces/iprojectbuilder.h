@@ -65,6 +65,21 @@ public:
      */
     virtual KJob* build(ProjectBaseItem *item) = 0;
 
+    /**
+     * Builds all the given @p items with a single job, if the builder supports it.
+     *
+     * All items belong to the same project and share the same build directory,
+     * so e.g. their targets can be passed to a single make invocation, which
+     * reads the build graph only once and keeps all its job slots busy.
+     *
+     * The job should keep going after errors, so one failing item does not keep
+     * the others from being built, and emit built() or failed() for each item.
+     *
+     * The default implementation returns nullptr, in which case the items
+     * are built one after another with build().
+     */
+    virtual KJob* buildItems(const QList<ProjectBaseItem*>& items);
+
     /**
      * Cleans the given project @p item, exact behaviour depends
      * on the implementation. The cleaning should only include
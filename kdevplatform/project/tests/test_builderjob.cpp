@@ -0,0 +1,220 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "test_builderjob.h"
+
+#include <QTest>
+#include <QTimer>
+
+#include <builderjob.h>
+#include <projectmodel.h>
+#include <interfaces/ibuildsystemmanager.h>
+#include <interfaces/iprojectbuilder.h>
+#include <tests/testproject.h>
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+
+using namespace KDevelop;
+
+namespace {
+
+class TestBuildJob : public KJob
+{
+public:
+    TestBuildJob(bool fails, bool finishes, bool* killed)
+        : m_fails(fails)
+        , m_finishes(finishes)
+        , m_killed(killed)
+    {
+    }
+
+    void start() override
+    {
+        if (m_finishes) {
+            QTimer::singleShot(0, this, [this]() {
+                setError(m_fails ? UserDefinedError : NoError);
+                emitResult();
+            });
+        }
+    }
+
+protected:
+    bool doKill() override
+    {
+        *m_killed = true;
+        return true;
+    }
+
+private:
+    const bool m_fails;
+    const bool m_finishes;
+    bool* const m_killed;
+};
+
+class TestBuilder : public IProjectBuilder
+{
+public:
+    KJob* install(ProjectBaseItem*, const QUrl&) override { return nullptr; }
+    KJob* clean(ProjectBaseItem*) override { return nullptr; }
+
+    KJob* build(ProjectBaseItem* item) override
+    {
+        jobItems << QList<ProjectBaseItem*>{item};
+        return createJob();
+    }
+
+    KJob* buildItems(const QList<ProjectBaseItem*>& items) override
+    {
+        if (!mergesItems) {
+            return nullptr;
+        }
+        jobItems << items;
+        return createJob();
+    }
+
+    bool mergesItems = true;
+    bool jobsFail = false;
+    bool jobsFinish = true;
+    bool jobKilled = false;
+    /// the items of each created job
+    QVector<QList<ProjectBaseItem*>> jobItems;
+
+private:
+    KJob* createJob()
+    {
+        return new TestBuildJob(jobsFail, jobsFinish, &jobKilled);
+    }
+};
+
+class TestBuildSystemManager : public IBuildSystemManager
+{
+public:
+    Features features() const override { return {}; }
+    QList<ProjectFolderItem*> parse(ProjectFolderItem*) override { return {}; }
+    ProjectFolderItem* import(IProject*) override { return nullptr; }
+    ProjectFolderItem* addFolder(const Path&, ProjectFolderItem*) override { return nullptr; }
+    ProjectFileItem* addFile(const Path&, ProjectFolderItem*) override { return nullptr; }
+    bool removeFilesAndFolders(const QList<ProjectBaseItem*>&) override { return false; }
+    bool moveFilesAndFolders(const QList<ProjectBaseItem*>&, ProjectFolderItem*) override { return false; }
+    bool copyFilesAndFolders(const Path::List&, ProjectFolderItem*) override { return false; }
+    bool renameFile(ProjectFileItem*, const Path&) override { return false; }
+    bool renameFolder(ProjectFolderItem*, const Path&) override { return false; }
+    bool reload(ProjectFolderItem*) override { return false; }
+
+    IProjectBuilder* builder() const override { return const_cast<TestBuilder*>(&testBuilder); }
+    Path::List includeDirectories(ProjectBaseItem*) const override { return {}; }
+    Path::List frameworkDirectories(ProjectBaseItem*) const override { return {}; }
+    QHash<QString, QString> defines(ProjectBaseItem*) const override { return {}; }
+    ProjectTargetItem* createTarget(const QString&, ProjectFolderItem*) override { return nullptr; }
+    bool removeTarget(ProjectTargetItem*) override { return false; }
+    QList<ProjectTargetItem*> targets(ProjectFolderItem*) const override { return {}; }
+    bool addFilesToTarget(const QList<ProjectFileItem*>&, ProjectTargetItem*) override { return false; }
+    bool removeFilesFromTargets(const QList<ProjectFileItem*>&) override { return false; }
+    bool hasBuildInfo(ProjectBaseItem*) const override { return false; }
+    Path buildDirectory(ProjectBaseItem* item) const override { return buildDirectories.value(item); }
+    QString extraArguments(ProjectBaseItem*) const override { return {}; }
+    Path compiler(ProjectTargetItem*) const override { return {}; }
+
+    TestBuilder testBuilder;
+    QHash<ProjectBaseItem*, Path> buildDirectories;
+};
+
+class TestBuildProject : public TestProject
+{
+public:
+    using TestProject::TestProject;
+
+    IBuildSystemManager* buildSystemManager() const override
+    {
+        return const_cast<TestBuildSystemManager*>(&manager);
+    }
+
+    ProjectTargetItem* addTarget(const QString& name, const QString& buildDirectory)
+    {
+        auto* target = new ProjectTargetItem(this, name, projectItem());
+        manager.buildDirectories.insert(target, Path(buildDirectory));
+        return target;
+    }
+
+    TestBuildSystemManager manager;
+};
+
+}
+
+QTEST_MAIN(TestBuilderJob)
+
+void TestBuilderJob::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+}
+
+void TestBuilderJob::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestBuilderJob::testGroupByBuildDirectory()
+{
+    TestBuildProject project(Path(QStringLiteral("/tmp/project")));
+    ProjectTargetItem* a1 = project.addTarget(QStringLiteral("a1"), QStringLiteral("/tmp/build/a"));
+    ProjectTargetItem* b = project.addTarget(QStringLiteral("b"), QStringLiteral("/tmp/build/b"));
+    ProjectTargetItem* a2 = project.addTarget(QStringLiteral("a2"), QStringLiteral("/tmp/build/a"));
+
+    BuilderJob job;
+    job.addItems(BuilderJob::Build, {a1, b, a2});
+
+    // the targets in the same build directory are built with one job, in the order they were added
+    const QVector<QList<ProjectBaseItem*>> expected{{a1, a2}, {b}};
+    QCOMPARE(project.manager.testBuilder.jobItems, expected);
+}
+
+void TestBuilderJob::testNoMerging()
+{
+    TestBuildProject project(Path(QStringLiteral("/tmp/project")));
+    project.manager.testBuilder.mergesItems = false;
+    ProjectTargetItem* a1 = project.addTarget(QStringLiteral("a1"), QStringLiteral("/tmp/build/a"));
+    ProjectTargetItem* b = project.addTarget(QStringLiteral("b"), QStringLiteral("/tmp/build/b"));
+    ProjectTargetItem* a2 = project.addTarget(QStringLiteral("a2"), QStringLiteral("/tmp/build/a"));
+
+    BuilderJob job;
+    job.addItems(BuilderJob::Build, {a1, b, a2});
+
+    // without support from the builder, each item gets its own job
+    const QVector<QList<ProjectBaseItem*>> expected{{a1}, {a2}, {b}};
+    QCOMPARE(project.manager.testBuilder.jobItems, expected);
+}
+
+void TestBuilderJob::testAbortOtherProjects()
+{
+    TestBuildProject failing(Path(QStringLiteral("/tmp/failing")));
+    failing.manager.testBuilder.jobsFail = true;
+    ProjectTargetItem* failingTarget = failing.addTarget(QStringLiteral("a"), QStringLiteral("/tmp/failing/build"));
+
+    TestBuildProject running(Path(QStringLiteral("/tmp/running")));
+    running.manager.testBuilder.jobsFinish = false;
+    ProjectTargetItem* runningTarget = running.addTarget(QStringLiteral("b"), QStringLiteral("/tmp/running/build"));
+
+    // the projects are built at the same time, a failure stops the build of the other one
+    auto* job = new BuilderJob;
+    job->addItems(BuilderJob::Build, {failingTarget, runningTarget});
+    QVERIFY(!job->exec());
+    QVERIFY(running.manager.testBuilder.jobKilled);
+    QVERIFY(!failing.manager.testBuilder.jobKilled);
+}
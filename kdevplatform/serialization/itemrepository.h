@@ -26,6 +26,8 @@
 #include <KMessageBox>
 #include <KLocalizedString>
 
+#include <type_traits>
+
 #include "referencecounting.h"
 #include "abstractitemrepository.h"
 #include "repositorymanager.h"
@@ -98,6 +100,16 @@ enum {
     ItemRepositoryBucketLimit = 1 << 16
 };
 
+///Whether the request offers destroy(item, index, repository), for requests that need the index of destroyed items
+template <class ItemRequest, class Item, class = void>
+struct DestroysWithIndex : std::false_type {};
+
+template <class ItemRequest, class Item>
+struct DestroysWithIndex<ItemRequest, Item,
+                         std::void_t<decltype(ItemRequest::destroy(std::declval<Item*>(), 0u,
+                                                                   std::declval<AbstractItemRepository&>()))>>
+    : std::true_type {};
+
 /**
  * Buckets are the memory-units that are used to store the data in an ItemRepository.
  *
@@ -519,8 +531,9 @@ public:
         return false;
     }
 
+    ///@param bucketIndex The number of this bucket in the repository, used to give the request the global index
     template <class Repository>
-    void deleteItem(unsigned short index, unsigned int hash, Repository& repository)
+    void deleteItem(unsigned short index, unsigned int hash, Repository& repository, unsigned short bucketIndex)
     {
         ifDebugLostSpace(Q_ASSERT(!lostSpace()); )
 
@@ -552,7 +565,10 @@ public:
 
         {
             const OptionalDUChainReferenceCountingEnabler<markForReferenceCounting> optionalRc(m_data, dataSize());
-            ItemRequest::destroy(item, repository);
+            if constexpr (DestroysWithIndex<ItemRequest, Item>::value)
+                ItemRequest::destroy(item, (static_cast<uint>(bucketIndex) << 16) + index, repository);
+            else
+                ItemRequest::destroy(item, repository);
         }
 
 #ifndef QT_NO_DEBUG
@@ -664,7 +680,7 @@ public:
 
     ///Returns whether something was changed
     template <class Repository>
-    int finalCleanup(Repository& repository)
+    int finalCleanup(Repository& repository, unsigned short bucketIndex)
     {
         int changed = 0;
 
@@ -681,7 +697,7 @@ public:
 
                     if (!ItemRequest::persistent(item)) {
                         changed += item->itemSize();
-                        deleteItem(currentIndex, item->hash(), repository);
+                        deleteItem(currentIndex, item->hash(), repository, bucketIndex);
                         m_dirty = true; //Set to dirty so we re-iterate
                         break;
                     }
@@ -1417,7 +1433,7 @@ public:
 
         --m_statItemCount;
 
-        bucketPtr->deleteItem(index, hash, *this);
+        bucketPtr->deleteItem(index, hash, *this, bucket);
 
         /**
          * Now check whether the link root/previousBucketNumber -> bucket is still needed.
@@ -1752,6 +1768,22 @@ public:
                 return;
             }
 
+            if (m_registry) {
+                //Journal everything that is overwritten below, so an interrupted store can be rolled back
+                for (int a = 0; a < m_buckets.size(); ++a) {
+                    if (m_buckets[a] && m_buckets[a]->changed()) {
+                        m_registry->journalFileRange(m_file->fileName(),
+                                                     BucketStartOffset + static_cast<qint64>(a - 1) * MyBucket::DataSize,
+                                                     static_cast<qint64>(1 + m_buckets[a]->monsterBucketExtent()) * MyBucket::DataSize);
+                    }
+                }
+                if (m_metaDataChanged) {
+                    m_registry->journalFileRange(m_file->fileName(), 0, BucketStartOffset);
+                    m_registry->journalFile(m_dynamicFile->fileName());
+                }
+                m_registry->syncJournal();
+            }
+
             for (int a = 0; a < m_buckets.size(); ++a) {
                 if (m_buckets[a]) {
                     if (m_buckets[a]->changed()) {
@@ -2157,7 +2189,7 @@ private:
         for (int a = 1; a <= m_currentBucket; ++a) {
             MyBucket* bucket = bucketForIndex(a);
             if (bucket && bucket->dirty()) { ///@todo Faster dirty check, without loading bucket
-                changed += bucket->finalCleanup(*this);
+                changed += bucket->finalCleanup(*this, a);
             }
             a += bucket->monsterBucketExtent(); //Skip buckets that are attached as tail to monster-buckets
         }
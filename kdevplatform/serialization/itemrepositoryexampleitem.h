@@ -83,6 +83,8 @@ class ExampleItemRequest
         Q_UNUSED(item);
     }
 
+    /// A request that needs the index of the destroyed item can offer
+    /// destroy(ExampleItem* item, uint index, AbstractItemRepository&) instead.
     static void destroy(ExampleItem* item, AbstractItemRepository&)
     {
         Q_UNUSED(item);
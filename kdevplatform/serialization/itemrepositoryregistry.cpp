@@ -29,6 +29,7 @@
 #include <util/shellutils.h>
 
 #include "abstractitemrepository.h"
+#include "repositoryjournal.h"
 #include "debug.h"
 
 using namespace KDevelop;
@@ -37,6 +38,13 @@ namespace {
 //If KDevelop crashed this many times consecutively, clean up the repository
 const int crashesBeforeCleanup = 1;
 
+void createWritingMark(const QString& path)
+{
+    QFile f(path + QLatin1String("/is_writing"));
+    f.open(QIODevice::WriteOnly);
+    f.close();
+}
+
 void setCrashCounter(QFile& crashesFile, int count)
 {
     crashesFile.close();
@@ -116,6 +124,8 @@ public:
     QMap<AbstractItemRepository*, AbstractRepositoryManager*> m_repositories;
     QMap<QString, QAtomicInt*> m_customCounters;
     mutable QMutex m_mutex;
+    RepositoryJournal m_journal;
+    int m_writeDepth = 0;
 
     explicit ItemRepositoryRegistryPrivate(ItemRepositoryRegistry* owner)
         : m_owner(owner)
@@ -235,10 +245,16 @@ QString ItemRepositoryRegistry::path() const
 void ItemRepositoryRegistryPrivate::lockForWriting()
 {
     QMutexLocker lock(&m_mutex);
-    //Create is_writing
-    QFile f(m_path + QLatin1String("/is_writing"));
-    f.open(QIODevice::WriteOnly);
-    f.close();
+    if (m_writeDepth++ > 0) {
+        return;
+    }
+
+    //Start the journal before creating is_writing, so an interrupted write can always be rolled back.
+    //If the journal can't be created, is_writing makes the repository be discarded as before.
+    if (!m_path.isEmpty()) {
+        m_journal.begin(m_path);
+    }
+    createWritingMark(m_path);
 }
 
 void ItemRepositoryRegistry::lockForWriting()
@@ -251,8 +267,14 @@ void ItemRepositoryRegistry::lockForWriting()
 void ItemRepositoryRegistryPrivate::unlockForWriting()
 {
     QMutexLocker lock(&m_mutex);
-    //Delete is_writing
+    Q_ASSERT(m_writeDepth > 0);
+    if (--m_writeDepth > 0) {
+        return;
+    }
+
+    //Delete is_writing. Until the journal is committed, the complete write would still be rolled back.
     QFile::remove(m_path + QLatin1String("/is_writing"));
+    m_journal.commit();
 }
 
 void ItemRepositoryRegistry::unlockForWriting()
@@ -262,6 +284,28 @@ void ItemRepositoryRegistry::unlockForWriting()
     d->unlockForWriting();
 }
 
+void ItemRepositoryRegistry::journalFile(const QString& fileName, JournalMode mode)
+{
+    Q_D(ItemRepositoryRegistry);
+
+    //Doesn't lock the mutex, as this is called with repositories locked, see path()
+    d->m_journal.journalFile(fileName, mode == MoveFile);
+}
+
+void ItemRepositoryRegistry::journalFileRange(const QString& fileName, qint64 offset, qint64 size)
+{
+    Q_D(ItemRepositoryRegistry);
+
+    d->m_journal.journalFileRange(fileName, offset, size);
+}
+
+void ItemRepositoryRegistry::syncJournal()
+{
+    Q_D(ItemRepositoryRegistry);
+
+    d->m_journal.sync();
+}
+
 void ItemRepositoryRegistry::unRegisterRepository(AbstractItemRepository* repository)
 {
     Q_D(ItemRepositoryRegistry);
@@ -277,9 +321,10 @@ void ItemRepositoryRegistryPrivate::deleteDataDirectory(const QString& path, boo
 {
     QMutexLocker lock(&m_mutex);
 
-    //lockForWriting creates a file, that prevents any other KDevelop instance from using the directory as it is.
+    //is_writing prevents any other KDevelop instance from using the directory as it is.
     //Instead, the other instance will try to delete the directory as well.
-    lockForWriting();
+    m_journal.discard();
+    createWritingMark(path);
 
     bool result = QDir(path).removeRecursively();
     Q_ASSERT(result);
@@ -297,6 +342,13 @@ bool ItemRepositoryRegistryPrivate::open(const QString& path)
         return true;
     }
 
+    // Restore the state before an interrupted write, instead of discarding the whole repository
+    if (RepositoryJournal::rollBack(path)) {
+        QFile::remove(path + QLatin1String("/is_writing"));
+        // the rolled back state is consistent, so the crash must not count towards clearing it
+        QFile::remove(path + QLatin1String("/crash_counter"));
+    }
+
     // Check if the repository shall be cleared
     if (shouldClear(path)) {
         qCWarning(SERIALIZATION) << QStringLiteral("The data-repository at %1 has to be cleared.").arg(path);
@@ -337,11 +389,14 @@ void ItemRepositoryRegistry::store()
     Q_D(ItemRepositoryRegistry);
 
     QMutexLocker lock(&d->m_mutex);
+    d->lockForWriting();
+
     for (auto it = d->m_repositories.constBegin(), end = d->m_repositories.constEnd(); it != end; ++it) {
         it.key()->store();
     }
 
     QFile versionFile(d->m_path + QStringLiteral("/version_%1").arg(staticItemRepositoryVersion()));
+    journalFile(versionFile.fileName());
     if (versionFile.open(QIODevice::WriteOnly)) {
         versionFile.close();
     } else {
@@ -350,6 +405,7 @@ void ItemRepositoryRegistry::store()
 
     //Store all custom counter values
     QFile f(d->m_path + QLatin1String("/Counters"));
+    journalFile(f.fileName(), MoveFile);
     if (f.open(QIODevice::WriteOnly)) {
         f.resize(0);
         QDataStream stream(&f);
@@ -362,6 +418,9 @@ void ItemRepositoryRegistry::store()
     } else {
         qCWarning(SERIALIZATION) << "Could not open counter file for writing";
     }
+    f.close();
+
+    d->unlockForWriting();
 }
 
 void ItemRepositoryRegistry::printAllStatistics() const
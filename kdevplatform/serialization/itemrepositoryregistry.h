@@ -66,6 +66,7 @@ public:
     QString path() const;
 
     /// Stores all repositories to disk, eventually unloading unused data to save memory.
+    /// The repositories are stored within a journaled write, see @ref lockForWriting().
     /// @note Should be called on a regular basis.
     void store();
 
@@ -80,13 +81,34 @@ public:
     /// Prints the statistics of all registered item-repositories to the command line using qDebug().
     void printAllStatistics() const;
 
-    /// Marks the directory as inconsistent, so it will be discarded
-    /// on next startup if the application crashes during the write process.
+    /// How @ref journalFile() saves a file.
+    enum JournalMode {
+        /// The file is copied into the journal, use this for files that are modified in place.
+        CopyFile,
+        /// The file may be moved into the journal, use this for files that are rewritten completely or removed.
+        MoveFile
+    };
+
+    /// Starts writing to the directory. Until @ref unlockForWriting(), the original state of all files
+    /// passed to the journal functions is kept, so a write that is interrupted by a crash is rolled back
+    /// on next startup. If the journal can't be written, the directory is discarded instead.
+    /// Calls may be nested, only the outermost pair of calls starts and completes the write.
     void lockForWriting();
 
-    /// Removes the inconsistency mark set by @ref lockForWriting().
+    /// Completes the write started by @ref lockForWriting(), and removes its journal.
     void unlockForWriting();
 
+    /// Saves the current state of @p fileName as a whole, before it is changed during a write.
+    /// Does nothing outside of @ref lockForWriting().
+    void journalFile(const QString& fileName, JournalMode mode = CopyFile);
+
+    /// Saves the current contents of the given range of @p fileName, before it is overwritten in place during a write.
+    /// Does nothing outside of @ref lockForWriting().
+    void journalFileRange(const QString& fileName, qint64 offset, qint64 size);
+
+    /// Makes sure everything journaled so far is on disk. Call this before modifying the journaled files.
+    void syncJournal();
+
     /// Returns a custom counter persistently stored as part of item-repositories in the
     /// same directory, possibly creating it.
     /// @param identity     The string used to identify a counter.
@@ -0,0 +1,472 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#include "repositoryjournal.h"
+
+#include "debug.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QUrl>
+#include <QVector>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace KDevelop;
+
+namespace {
+enum RecordType : qint8 {
+    SizeRecord,
+    RangeRecord
+};
+
+QString journalPath(const QString& directory)
+{
+    return directory + QLatin1String("/journal");
+}
+
+// the journal is uncommitted as long as this file exists
+QString openMarkerPath(const QString& directory)
+{
+    return journalPath(directory) + QLatin1String("/open");
+}
+
+// the journaled files are stored flat, named by their percent-encoded path relative to the directory
+QString encodedPath(const QString& path)
+{
+    return QString::fromLatin1(QUrl::toPercentEncoding(path));
+}
+
+QString decodedPath(const QString& name)
+{
+    return QUrl::fromPercentEncoding(name.toLatin1());
+}
+
+bool syncFile(QFile& file)
+{
+    if (!file.flush())
+        return false;
+#ifdef Q_OS_WIN
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#elif defined(Q_OS_LINUX)
+    // the size is still synced, only timestamps are left out
+    return fdatasync(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+void syncFile(const QString& fileName)
+{
+    QFile file(fileName);
+    // ReadWrite, as flushing requires write access on Windows
+    if (file.exists() && file.open(QIODevice::ReadWrite))
+        syncFile(file);
+}
+
+// new, removed or renamed entries of a directory only survive a power loss once the directory itself is synced
+void syncDirectory(const QString& path)
+{
+#ifdef Q_OS_WIN
+    // NTFS journals its metadata, and directories can't be flushed like files there
+    Q_UNUSED(path);
+#else
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY);
+    if (fd == -1)
+        return;
+    fsync(fd);
+    ::close(fd);
+#endif
+}
+
+QVector<QByteArray> readLog(const QString& directory)
+{
+    QVector<QByteArray> records;
+
+    QFile log(journalPath(directory) + QLatin1String("/ranges"));
+    if (!log.open(QIODevice::ReadOnly))
+        return records;
+
+    QDataStream stream(&log);
+    while (!stream.atEnd()) {
+        quint32 size;
+        stream >> size;
+        if (stream.status() != QDataStream::Ok || size > log.size() - log.pos())
+            break;
+
+        QByteArray record(size, Qt::Uninitialized);
+        if (stream.readRawData(record.data(), size) != static_cast<int>(size))
+            break;
+
+        quint16 checksum;
+        stream >> checksum;
+        if (stream.status() != QDataStream::Ok || checksum != qChecksum(record.constData(), size)) {
+            // written partially, so the file it belongs to was not touched yet
+            break;
+        }
+
+        records.append(record);
+    }
+
+    return records;
+}
+}
+
+RepositoryJournal::RepositoryJournal() = default;
+
+RepositoryJournal::~RepositoryJournal() = default;
+
+bool RepositoryJournal::begin(const QString& directory)
+{
+    QMutexLocker lock(&m_mutex);
+    Q_ASSERT(!m_active);
+
+    m_directory = directory;
+
+    // left over if the application died while removing a committed journal
+    const QString path = journalPath(directory);
+    QDir(path).removeRecursively();
+
+    if (!QDir().mkpath(path + QLatin1String("/files")) || !QDir().mkpath(path + QLatin1String("/created"))) {
+        qCWarning(SERIALIZATION) << "could not create the repository journal in" << path;
+        return false;
+    }
+
+    m_log.setFileName(path + QLatin1String("/ranges"));
+    QFile marker(openMarkerPath(directory));
+    if (!m_log.open(QIODevice::WriteOnly) || !marker.open(QIODevice::WriteOnly)) {
+        qCWarning(SERIALIZATION) << "could not create the repository journal in" << path;
+        m_log.close();
+        return false;
+    }
+
+    // the marker and the journal directory itself must be on disk before anything is modified
+    syncDirectory(path + QLatin1String("/files"));
+    syncDirectory(path + QLatin1String("/created"));
+    syncDirectory(path);
+    syncDirectory(directory);
+
+    m_active = true;
+    return true;
+}
+
+bool RepositoryJournal::isActive() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_active;
+}
+
+QString RepositoryJournal::relativePath(const QString& fileName) const
+{
+    const QString path = QDir(m_directory).relativeFilePath(fileName);
+    Q_ASSERT(!path.startsWith(QLatin1String("..")));
+    return path;
+}
+
+void RepositoryJournal::fail(const QString& reason)
+{
+    qCWarning(SERIALIZATION) << "repository journal failed:" << reason;
+
+    // an incomplete journal can't restore a consistent state, so don't let rollBack() use it
+    QFile::remove(openMarkerPath(m_directory));
+    reset();
+}
+
+bool RepositoryJournal::appendRecord(const QByteArray& record)
+{
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream << static_cast<quint32>(record.size());
+    stream.writeRawData(record.constData(), record.size());
+    stream << qChecksum(record.constData(), static_cast<uint>(record.size()));
+
+    // flushed right away, so the record survives the application dying while the file is modified
+    if (m_log.write(entry) != entry.size() || !m_log.flush()) {
+        fail(QStringLiteral("could not write to %1").arg(m_log.fileName()));
+        return false;
+    }
+
+    m_needsSync = true;
+    return true;
+}
+
+void RepositoryJournal::journalFile(const QString& fileName, bool mayMove)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_active)
+        return;
+
+    const QString path = relativePath(fileName);
+    if (m_files.contains(path))
+        return;
+
+    if (m_sizes.contains(path)) {
+        // already modified in place, so keep its current contents as one more range
+        journalRange(fileName, path, 0, QFileInfo(fileName).size());
+        return;
+    }
+
+    m_files.insert(path);
+
+    // the callers create or rewrite whole files right after journaling them, without calling sync() first
+    const QString name = encodedPath(path);
+    if (!QFile::exists(fileName)) {
+        const QString createdPath = journalPath(m_directory) + QLatin1String("/created");
+        QFile marker(createdPath + QLatin1Char('/') + name);
+        if (!marker.open(QIODevice::WriteOnly)) {
+            fail(QStringLiteral("could not create %1").arg(marker.fileName()));
+            return;
+        }
+        // the directory is synced once for all the markers, see sync()
+        m_unsyncedDirectories |= CreatedDirectory;
+        m_needsSync = true;
+        return;
+    }
+
+    const QString backup = journalPath(m_directory) + QLatin1String("/files/") + name;
+    if (mayMove && QFile::rename(fileName, backup)) {
+        m_unsyncedDirectories |= FilesDirectory;
+        m_needsSync = true;
+        return;
+    }
+
+    if (!QFile::copy(fileName, backup)) {
+        fail(QStringLiteral("could not copy %1").arg(fileName));
+        return;
+    }
+    m_unsyncedCopies.append(backup);
+    m_unsyncedDirectories |= FilesDirectory;
+    m_needsSync = true;
+}
+
+void RepositoryJournal::journalFileRange(const QString& fileName, qint64 offset, qint64 size)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_active)
+        return;
+
+    const QString path = relativePath(fileName);
+    if (m_files.contains(path))
+        return;
+
+    journalRange(fileName, path, offset, size);
+}
+
+void RepositoryJournal::journalRange(const QString& fileName, const QString& path, qint64 offset, qint64 size)
+{
+    auto sizeIt = m_sizes.find(path);
+    if (sizeIt == m_sizes.end()) {
+        const QFileInfo info(fileName);
+        const qint64 originalSize = info.exists() ? info.size() : -1;
+
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream << static_cast<qint8>(SizeRecord) << path << originalSize;
+        if (!appendRecord(record))
+            return;
+
+        sizeIt = m_sizes.insert(path, originalSize);
+    }
+
+    // data behind the original end of the file is dropped when restoring the size
+    const qint64 end = qMin(offset + size, *sizeIt);
+    if (offset >= end)
+        return;
+
+    // if the range was journaled before, the first record already restores it
+    auto& ranges = m_ranges[path];
+    if (ranges.contains({offset, end}))
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset)) {
+        fail(QStringLiteral("could not read %1").arg(fileName));
+        return;
+    }
+    const QByteArray data = file.read(end - offset);
+    if (data.size() != end - offset) {
+        fail(QStringLiteral("could not read %1").arg(fileName));
+        return;
+    }
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream << static_cast<qint8>(RangeRecord) << path << offset << data;
+    if (!appendRecord(record))
+        return;
+
+    ranges.insert({offset, end});
+}
+
+void RepositoryJournal::sync()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_active || !m_needsSync)
+        return;
+
+    if (!syncFile(m_log)) {
+        fail(QStringLiteral("could not sync %1").arg(m_log.fileName()));
+        return;
+    }
+
+    for (const QString& copy : qAsConst(m_unsyncedCopies)) {
+        syncFile(copy);
+    }
+    m_unsyncedCopies.clear();
+
+    // once per batch, however many files were moved into the journal or marked as created
+    if (m_unsyncedDirectories & FilesDirectory)
+        syncDirectory(journalPath(m_directory) + QLatin1String("/files"));
+    if (m_unsyncedDirectories & CreatedDirectory)
+        syncDirectory(journalPath(m_directory) + QLatin1String("/created"));
+    m_unsyncedDirectories = NoDirectory;
+
+    m_needsSync = false;
+}
+
+void RepositoryJournal::commit()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_active)
+        return;
+
+    // make sure all the written files are complete before dropping the journal
+    QSet<QString> directories;
+    for (auto it = m_sizes.constBegin(), end = m_sizes.constEnd(); it != end; ++it) {
+        syncFile(m_directory + QLatin1Char('/') + it.key());
+    }
+    for (const QString& path : qAsConst(m_files)) {
+        const QString fileName = m_directory + QLatin1Char('/') + path;
+        // files journaled as a whole may also have been removed
+        syncFile(fileName);
+        directories.insert(QFileInfo(fileName).path());
+    }
+    for (const QString& directory : qAsConst(directories)) {
+        syncDirectory(directory);
+    }
+
+    QFile::remove(openMarkerPath(m_directory));
+    syncDirectory(journalPath(m_directory));
+    reset();
+    QDir(journalPath(m_directory)).removeRecursively();
+}
+
+void RepositoryJournal::discard()
+{
+    QMutexLocker lock(&m_mutex);
+    reset();
+}
+
+void RepositoryJournal::reset()
+{
+    m_log.close();
+    m_active = false;
+    m_needsSync = false;
+    m_sizes.clear();
+    m_ranges.clear();
+    m_files.clear();
+    m_unsyncedCopies.clear();
+    m_unsyncedDirectories = NoDirectory;
+}
+
+bool RepositoryJournal::rollBack(const QString& directory)
+{
+    const QString path = journalPath(directory);
+    if (!QFile::exists(path))
+        return false;
+
+    const bool uncommitted = QFile::exists(openMarkerPath(directory));
+    if (uncommitted) {
+        qCWarning(SERIALIZATION) << "rolling back the interrupted write to" << directory;
+
+        QSet<QString> restored;
+
+        // undo the in-place modifications in reverse order, the first record of a range holds its original contents
+        const auto records = readLog(directory);
+        for (auto it = records.crbegin(), end = records.crend(); it != end; ++it) {
+            QDataStream stream(*it);
+            qint8 type;
+            QString filePath;
+            stream >> type >> filePath;
+
+            const QString fileName = directory + QLatin1Char('/') + filePath;
+            QFile file(fileName);
+            if (type == SizeRecord) {
+                qint64 size;
+                stream >> size;
+                if (size < 0) {
+                    QFile::remove(fileName);
+                    restored.remove(fileName);
+                    continue;
+                }
+                if (file.open(QIODevice::ReadWrite))
+                    file.resize(size);
+            } else {
+                qint64 offset;
+                QByteArray data;
+                stream >> offset >> data;
+                if (file.open(QIODevice::ReadWrite) && file.seek(offset))
+                    file.write(data);
+            }
+            restored.insert(fileName);
+        }
+
+        const auto files = QDir(path + QLatin1String("/files")).entryInfoList(QDir::Files);
+        for (const QFileInfo& backup : files) {
+            const QString fileName = directory + QLatin1Char('/') + decodedPath(backup.fileName());
+            QFile::remove(fileName);
+            QDir().mkpath(QFileInfo(fileName).path());
+            if (!QFile::rename(backup.filePath(), fileName))
+                QFile::copy(backup.filePath(), fileName);
+            restored.insert(fileName);
+        }
+
+        const auto created = QDir(path + QLatin1String("/created")).entryList(QDir::Files);
+        for (const QString& name : created) {
+            const QString fileName = directory + QLatin1Char('/') + decodedPath(name);
+            QFile::remove(fileName);
+            restored.remove(fileName);
+        }
+
+        QSet<QString> directories;
+        for (const QString& fileName : qAsConst(restored)) {
+            syncFile(fileName);
+            directories.insert(QFileInfo(fileName).path());
+        }
+        for (const QString& name : created) {
+            directories.insert(QFileInfo(directory + QLatin1Char('/') + decodedPath(name)).path());
+        }
+        for (const QString& restoredDirectory : qAsConst(directories)) {
+            syncDirectory(restoredDirectory);
+        }
+
+        // everything is restored, so applying the journal again would not change anything anymore
+        QFile::remove(openMarkerPath(directory));
+        syncDirectory(path);
+    }
+
+    QDir(path).removeRecursively();
+    return uncommitted;
+}
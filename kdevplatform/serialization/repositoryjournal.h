@@ -0,0 +1,128 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_REPOSITORYJOURNAL_H
+#define KDEVPLATFORM_REPOSITORYJOURNAL_H
+
+#include "serializationexport.h"
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace KDevelop {
+/**
+ * Undo journal for the files of an item-repository directory.
+ *
+ * Between begin() and commit(), the original state of every file is saved into the
+ * "journal" sub-directory before the file is modified. If the application dies before
+ * commit(), rollBack() restores the directory to the state of the last commit.
+ *
+ * Files are journaled either as a whole, by copying or moving them into the journal,
+ * or by the byte ranges which are overwritten in place, which are appended to a log.
+ * The log records are checksummed, so a record that was only partially written when
+ * the application died is ignored. The file it describes was not touched yet then.
+ *
+ * All functions are thread-safe.
+ */
+class KDEVPLATFORMSERIALIZATION_EXPORT RepositoryJournal
+{
+public:
+    RepositoryJournal();
+    ~RepositoryJournal();
+
+    RepositoryJournal(const RepositoryJournal&) = delete;
+    RepositoryJournal& operator=(const RepositoryJournal&) = delete;
+
+    /// Starts journaling changes to the files in @p directory.
+    /// @returns whether the journal could be created. If not, nothing is journaled until the next begin().
+    bool begin(const QString& directory);
+
+    /// @returns whether the journal was started and is usable.
+    bool isActive() const;
+
+    /**
+     * Saves the current state of @p fileName as a whole, so it is restored by rollBack().
+     * If the file does not exist yet, it is removed by rollBack().
+     *
+     * @param mayMove if true, the file may be moved into the journal instead of being copied.
+     *                Only use this if the file is going to be rewritten completely or removed.
+     * */
+    void journalFile(const QString& fileName, bool mayMove);
+
+    /**
+     * Saves the current contents of the given range of @p fileName, and its current size,
+     * so both are restored by rollBack(). Use this for files that are modified in place.
+     * */
+    void journalFileRange(const QString& fileName, qint64 offset, qint64 size);
+
+    /**
+     * Makes sure everything journaled so far is on disk, call this before modifying the journaled files.
+     *
+     * Files journaled as a whole are not synced one by one. Their journal directories are synced
+     * here, once for all files journaled since the last call.
+     * */
+    void sync();
+
+    /// Syncs the journaled files to disk, and removes the journal.
+    /// This may take a while, so avoid holding locks other threads are waiting for.
+    void commit();
+
+    /// Stops journaling without touching the journal on disk, used when the directory is going to be removed.
+    void discard();
+
+    /**
+     * Restores the files in @p directory from an uncommitted journal, and removes it.
+     * @returns whether an interrupted write was rolled back.
+     * */
+    static bool rollBack(const QString& directory);
+
+private:
+    QString relativePath(const QString& fileName) const;
+    void journalRange(const QString& fileName, const QString& path, qint64 offset, qint64 size);
+    bool appendRecord(const QByteArray& record);
+    void fail(const QString& reason);
+    void reset();
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    QFile m_log;
+    bool m_active = false;
+    bool m_needsSync = false;
+
+    // the original sizes of the files journaled by ranges, -1 if they did not exist
+    QHash<QString, qint64> m_sizes;
+    QHash<QString, QSet<QPair<qint64, qint64>>> m_ranges;
+    // files journaled as a whole
+    QSet<QString> m_files;
+    QStringList m_unsyncedCopies;
+
+    enum JournalDirectory {
+        NoDirectory = 0,
+        FilesDirectory = 1,
+        CreatedDirectory = 2
+    };
+    // the journal directories with entries that were not synced yet
+    int m_unsyncedDirectories = NoDirectory;
+};
+}
+
+#endif // KDEVPLATFORM_REPOSITORYJOURNAL_H
@@ -0,0 +1,106 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#include <QDataStream>
+#include <QTest>
+#include <QTemporaryDir>
+#include <serialization/abstractitemrepository.h>
+#include <serialization/itemrepositoryregistry.h>
+#include <serialization/repositoryjournal.h>
+
+using namespace KDevelop;
+
+namespace {
+void writeCounters(const QString& fileName, int value)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QDataStream stream(&file);
+    stream << QStringLiteral("test") << value;
+}
+
+void writeCrashCounter(const QString& fileName, int count)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QDataStream stream(&file);
+    stream << count;
+}
+
+int readCrashCounter(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    QDataStream stream(&file);
+    int count;
+    stream >> count;
+    return count;
+}
+}
+
+class TestItemRepositoryRegistryRollBack
+    : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testOpenRollsBack()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.path();
+        const QString versionFile = path + QStringLiteral("/version_%1").arg(staticItemRepositoryVersion());
+        const QString counters = path + QLatin1String("/Counters");
+        const QString crashCounter = path + QLatin1String("/crash_counter");
+
+        // the state of the last completed store
+        {
+            QFile version(versionFile);
+            QVERIFY(version.open(QIODevice::WriteOnly));
+        }
+        writeCounters(counters, 42);
+        // the session that was writing started, so it counts as crashed
+        writeCrashCounter(crashCounter, 1);
+
+        // the next store is interrupted while the counters are rewritten
+        {
+            RepositoryJournal journal;
+            QVERIFY(journal.begin(path));
+            QFile mark(path + QLatin1String("/is_writing"));
+            QVERIFY(mark.open(QIODevice::WriteOnly));
+            journal.journalFile(counters, true);
+            writeCounters(counters, 7);
+        }
+
+        ItemRepositoryRegistry::initialize(path);
+        QCOMPARE(globalItemRepositoryRegistry().path(), path);
+
+        // the directory was restored instead of being cleared
+        QVERIFY(QFile::exists(versionFile));
+        QVERIFY(!QFile::exists(path + QLatin1String("/is_writing")));
+        QVERIFY(!QFile::exists(path + QLatin1String("/journal")));
+        QCOMPARE(globalItemRepositoryRegistry().customCounter(QStringLiteral("test"), 0).loadAcquire(), 42);
+        // the rolled back crash did not count
+        QCOMPARE(readCrashCounter(crashCounter), 1);
+
+        globalItemRepositoryRegistry().shutdown();
+    }
+};
+
+#include "test_itemrepositoryregistry_rollback.moc"
+
+QTEST_GUILESS_MAIN(TestItemRepositoryRegistryRollBack)
@@ -0,0 +1,151 @@
+/* This file is part of KDevelop
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <serialization/repositoryjournal.h>
+
+using namespace KDevelop;
+
+namespace {
+void writeFile(const QString& fileName, const QByteArray& contents)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+void overwrite(const QString& fileName, qint64 offset, const QByteArray& contents)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(offset));
+    file.write(contents);
+}
+
+QByteArray readFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return "<missing>";
+    return file.readAll();
+}
+}
+
+class TestRepositoryJournal
+    : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRollBack()
+    {
+        QTemporaryDir dir;
+        const QString repository = dir.filePath(QStringLiteral("repository"));
+        const QString dynamic = dir.filePath(QStringLiteral("repository_dynamic"));
+        const QString topContext = dir.filePath(QStringLiteral("topcontexts/1"));
+        const QString created = dir.filePath(QStringLiteral("topcontexts/2"));
+        QDir(dir.path()).mkpath(QStringLiteral("topcontexts"));
+        writeFile(repository, "0123456789");
+        writeFile(dynamic, "dynamic");
+        writeFile(topContext, "context");
+
+        {
+            RepositoryJournal journal;
+            QVERIFY(journal.begin(dir.path()));
+
+            journal.journalFileRange(repository, 2, 3);
+            journal.journalFileRange(repository, 8, 5);
+            journal.sync();
+            overwrite(repository, 2, "abc");
+            overwrite(repository, 8, "xyz");
+
+            // journaling the same range again must not lose the original contents
+            journal.journalFileRange(repository, 2, 3);
+            overwrite(repository, 2, "ABC");
+
+            journal.journalFile(dynamic, false);
+            overwrite(dynamic, 0, "DYN");
+
+            journal.journalFile(topContext, true);
+            writeFile(topContext, "rewritten");
+
+            journal.journalFile(created, true);
+            writeFile(created, "new");
+
+            QCOMPARE(readFile(repository), QByteArray("01ABC567xyz"));
+            // the journal is dropped without committing, as if the application crashed
+        }
+
+        QVERIFY(RepositoryJournal::rollBack(dir.path()));
+
+        QCOMPARE(readFile(repository), QByteArray("0123456789"));
+        QCOMPARE(readFile(dynamic), QByteArray("dynamic"));
+        QCOMPARE(readFile(topContext), QByteArray("context"));
+        QVERIFY(!QFile::exists(created));
+        QVERIFY(!QFile::exists(dir.filePath(QStringLiteral("journal"))));
+
+        // nothing left to roll back
+        QVERIFY(!RepositoryJournal::rollBack(dir.path()));
+    }
+
+    void testCommit()
+    {
+        QTemporaryDir dir;
+        const QString repository = dir.filePath(QStringLiteral("repository"));
+        writeFile(repository, "0123456789");
+
+        RepositoryJournal journal;
+        QVERIFY(journal.begin(dir.path()));
+        journal.journalFileRange(repository, 0, 4);
+        journal.sync();
+        overwrite(repository, 0, "abcd");
+        journal.commit();
+        QVERIFY(!journal.isActive());
+
+        QVERIFY(!RepositoryJournal::rollBack(dir.path()));
+        QCOMPARE(readFile(repository), QByteArray("abcd456789"));
+    }
+
+    void testIncompleteRecord()
+    {
+        QTemporaryDir dir;
+        const QString repository = dir.filePath(QStringLiteral("repository"));
+        writeFile(repository, "0123456789");
+
+        {
+            RepositoryJournal journal;
+            QVERIFY(journal.begin(dir.path()));
+            journal.journalFileRange(repository, 0, 4);
+            overwrite(repository, 0, "abcd");
+            journal.journalFileRange(repository, 4, 4);
+        }
+
+        // cut off the last record, as if the application died while writing it
+        QFile log(dir.filePath(QStringLiteral("journal/ranges")));
+        QVERIFY(log.open(QIODevice::ReadWrite));
+        QVERIFY(log.resize(log.size() - 3));
+        log.close();
+
+        QVERIFY(RepositoryJournal::rollBack(dir.path()));
+        QCOMPARE(readFile(repository), QByteArray("0123456789"));
+    }
+};
+
+#include "test_repositoryjournal.moc"
+
+QTEST_GUILESS_MAIN(TestRepositoryJournal)
@@ -30,6 +30,8 @@
 
 #include <QAction>
 
+#include <utility>
+
 #include <KActionCollection>
 #include <KParts/MainWindow>
 #include <KTextEditor/Document>
@@ -42,6 +44,7 @@
 #include <language/duchain/duchain.h>
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchainutils.h>
+#include <language/duchain/topducontext.h>
 #include <language/duchain/types/identifiedtype.h>
 #include <language/duchain/types/typeutils.h>
 #include <documentation/documentationview.h>
@@ -50,6 +53,9 @@ using namespace KDevelop;
 
 namespace {
 
+/// Limits the number of declarations whose documentation is remembered
+constexpr int maxCachedDocumentation = 1000;
+
 /**
  * Return a "more useful" declaration that documentation providers can look-up
  *
@@ -118,6 +124,7 @@ private:
 
 DocumentationController::DocumentationController(Core* core)
     : m_factory(new DocumentationViewFactory)
+    , m_documentationCache(maxCachedDocumentation)
 {
     m_showDocumentation = core->uiController()->activeMainWindow()->actionCollection()->addAction(QStringLiteral("showDocumentation"));
     m_showDocumentation->setText(i18nc("@action", "Show Documentation"));
@@ -136,6 +143,28 @@ DocumentationController::~DocumentationController()
 
 void DocumentationController::initialize()
 {
+    // plugins may come with their own providers, or take them away
+    auto* pluginController = ICore::self()->pluginController();
+    connect(pluginController, &IPluginController::pluginLoaded,
+            this, &DocumentationController::clearDocumentationCache);
+    connect(pluginController, &IPluginController::pluginUnloaded,
+            this, &DocumentationController::clearDocumentationCache);
+
+    // the indices of the declarations of a reparsed file may now refer to different declarations
+    connect(DUChain::self(), &DUChain::updateReady, this,
+            [this](const IndexedString& /*url*/, const ReferencedTopDUContext& topContext) {
+        if (!topContext) {
+            return;
+        }
+        const uint topContextIndex = topContext->ownIndex();
+        QMutexLocker lock(&m_cacheMutex);
+        const auto keys = m_documentationCache.keys();
+        for (const IndexedDeclaration& declaration : keys) {
+            if (declaration.topContextIndex() == topContextIndex) {
+                m_documentationCache.remove(declaration);
+            }
+        }
+    });
 }
 
 
@@ -180,6 +209,79 @@ IDocumentation::Ptr DocumentationController::documentationForDeclaration(Declara
     if (!decl)
         return {};
 
+    const IndexedDeclaration indexedDecl(decl);
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        if (const auto* cached = m_documentationCache.object(indexedDecl)) {
+            return *cached;
+        }
+    }
+
+    auto ret = lookupDocumentation(decl);
+    cacheDocumentation(indexedDecl, ret);
+    return ret;
+}
+
+IDocumentation::Ptr DocumentationController::cachedDocumentationForDeclaration(Declaration* decl, bool* pending)
+{
+    *pending = false;
+    if (!decl)
+        return {};
+
+    const IndexedDeclaration indexedDecl(decl);
+    QMutexLocker lock(&m_cacheMutex);
+    if (const auto* cached = m_documentationCache.object(indexedDecl)) {
+        return *cached;
+    }
+
+    *pending = true;
+    if (!m_pendingLookups.contains(indexedDecl)) {
+        if (m_pendingLookups.isEmpty()) {
+            // queued, as the caller may be in another thread
+            QMetaObject::invokeMethod(this, "lookupPendingDocumentation", Qt::QueuedConnection);
+        }
+        m_pendingLookups.append(indexedDecl);
+    }
+    return {};
+}
+
+void DocumentationController::lookupPendingDocumentation()
+{
+    {
+        DUChainReadLocker lock;
+
+        QVector<IndexedDeclaration> pendingLookups;
+        {
+            QMutexLocker cacheLock(&m_cacheMutex);
+            pendingLookups = std::exchange(m_pendingLookups, {});
+        }
+
+        for (const IndexedDeclaration& indexedDecl : qAsConst(pendingLookups)) {
+            // the declaration may have been deleted in the meantime
+            if (Declaration* decl = indexedDecl.data()) {
+                {
+                    QMutexLocker cacheLock(&m_cacheMutex);
+                    if (m_documentationCache.contains(indexedDecl)) {
+                        continue;
+                    }
+                }
+                cacheDocumentation(indexedDecl, lookupDocumentation(decl));
+            }
+        }
+    }
+
+    emit documentationReady();
+}
+
+void DocumentationController::cacheDocumentation(const IndexedDeclaration& declaration,
+                                                 const IDocumentation::Ptr& documentation)
+{
+    QMutexLocker lock(&m_cacheMutex);
+    m_documentationCache.insert(declaration, new IDocumentation::Ptr(documentation));
+}
+
+IDocumentation::Ptr DocumentationController::lookupDocumentation(Declaration* decl) const
+{
     const auto documentationProviders = this->documentationProviders();
     for (IDocumentationProvider* doc : documentationProviders) {
         qCDebug(SHELL) << "Documentation provider found:" << doc;
@@ -252,6 +354,14 @@ void KDevelop::DocumentationController::showDocumentation(const IDocumentation::
 
 void DocumentationController::changedDocumentationProviders()
 {
+    clearDocumentationCache();
+
     emit providersChanged();
 }
 
+void DocumentationController::clearDocumentationCache()
+{
+    QMutexLocker lock(&m_cacheMutex);
+    m_documentationCache.clear();
+}
+
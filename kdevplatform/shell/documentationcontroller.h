@@ -21,6 +21,11 @@
 #define KDEVPLATFORM_DOCUMENTATIONCONTROLLER_H
 
 #include <interfaces/idocumentationcontroller.h>
+#include <language/duchain/indexeddeclaration.h>
+
+#include <QCache>
+#include <QMutex>
+#include <QVector>
 
 class DocumentationViewFactory;
 
@@ -44,6 +49,7 @@ public:
 
     QList<IDocumentationProvider*> documentationProviders() const override;
     IDocumentation::Ptr documentationForDeclaration(Declaration* declaration) override;
+    IDocumentation::Ptr cachedDocumentationForDeclaration(Declaration* declaration, bool* pending) override;
     IDocumentation::Ptr documentation(const QUrl& url) const override;
     void showDocumentation(const IDocumentation::Ptr& doc) override;
     ContextMenuExtension contextMenuExtension(Context* context, QWidget* parent);
@@ -53,10 +59,22 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void doShowDocumentation();
+    void lookupPendingDocumentation();
+
+private:
+    IDocumentation::Ptr lookupDocumentation(Declaration* declaration) const;
+    void cacheDocumentation(const IndexedDeclaration& declaration, const IDocumentation::Ptr& documentation);
+    void clearDocumentationCache();
 
 private:
     DocumentationViewFactory* m_factory;
     QAction* m_showDocumentation;
+
+    // guards the cache and the pending lookups, the providers are asked without holding it
+    mutable QMutex m_cacheMutex;
+    // results of the providers, including the declarations they have no documentation for
+    QCache<IndexedDeclaration, IDocumentation::Ptr> m_documentationCache;
+    QVector<IndexedDeclaration> m_pendingLookups;
 };
 
 }
@@ -500,6 +500,12 @@ public:
                 }
             }
 
+            // a view restored from a working set may not have loaded the document yet,
+            // but whoever opens it explicitly expects textDocument() to be there
+            if (auto* textView = qobject_cast<TextView*>(partView)) {
+                textView->setLoadDeferred(false);
+            }
+
             if (!activationParams.testFlag(IDocumentController::DoNotActivate))
             {
                 uiController->activeSublimeWindow()->activateView(
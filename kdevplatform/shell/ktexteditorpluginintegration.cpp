@@ -42,6 +42,8 @@
 
 #include <util/objectlist.h>
 
+#include <memory>
+
 using namespace KDevelop;
 
 namespace {
@@ -216,7 +218,10 @@ QList<KTextEditor::Document *> Application::documents()
     const auto openDocuments = Core::self()->documentControllerInternal()->openDocuments();
     l.reserve(openDocuments.size());
     for (auto* d : openDocuments) {
-        l << d->textDocument();
+        // documents restored from a working set are only loaded once shown
+        if (auto* textDocument = d->textDocument()) {
+            l << textDocument;
+        }
     }
     return l;
 }
@@ -238,6 +243,15 @@ MainWindow::MainWindow(KDevelop::MainWindow *mainWindow)
     connect(mainWindow, &Sublime::MainWindow::viewAdded, this, [this] (Sublime::View *view) {
         if (auto kteView = toKteView(view)) {
             emit m_interface->viewCreated(kteView);
+        } else if (qobject_cast<KDevelop::TextView*>(view)) {
+            // the editor view of a restored document is only created when it is shown first
+            auto connection = std::make_shared<QMetaObject::Connection>();
+            *connection = connect(view, &Sublime::View::widgetChanged, this, [this, connection] (Sublime::View *changedView) {
+                if (auto kteView = toKteView(changedView)) {
+                    disconnect(*connection);
+                    emit m_interface->viewCreated(kteView);
+                }
+            });
         }
     });
     connect(mainWindow, &Sublime::MainWindow::activeViewChanged, this, [this] (Sublime::View *view) {
@@ -22,8 +22,11 @@
 #include <QHash>
 #include <QMimeDatabase>
 #include <QMutexLocker>
+#include <QRegularExpression>
 #include <QThread>
 
+#include <memory>
+
 #include <interfaces/idocument.h>
 #include <interfaces/idocumentcontroller.h>
 #include <interfaces/iplugin.h>
@@ -51,6 +54,108 @@ namespace KDevelop {
 using LanguageHash = QHash<QString, ILanguageSupport*>;
 using LanguageCache = QHash<QString, QList<ILanguageSupport*>>;
 
+/**
+ * Maps file names to languages, based on the glob patterns of their mimetypes.
+ *
+ * The table is immutable once built, so it can be read from any thread.
+ */
+class LanguageLookupTable
+{
+public:
+    void addPattern(const QString& pattern, ILanguageSupport* language);
+    QList<ILanguageSupport*> languagesForFileName(const QString& fileName) const;
+
+private:
+    using Languages = QVector<ILanguageSupport*>;
+    /// "*.ext" patterns, keyed by ".ext"
+    QHash<QString, Languages> m_suffixes;
+    /// patterns without any wildcards
+    QHash<QString, Languages> m_fileNames;
+    /// everything else, these are rare
+    QVector<QPair<QRegularExpression, ILanguageSupport*>> m_patterns;
+};
+
+static bool hasWildcards(const QStringRef& pattern)
+{
+    return pattern.contains(QLatin1Char('*')) || pattern.contains(QLatin1Char('?'))
+        || pattern.contains(QLatin1Char('['));
+}
+
+static QString globToRegularExpression(const QString& glob)
+{
+    QString regexp;
+    regexp.reserve(glob.size() * 2);
+    for (int i = 0; i < glob.size(); ++i) {
+        const QChar c = glob.at(i);
+        if (c == QLatin1Char('*')) {
+            regexp += QLatin1String(".*");
+        } else if (c == QLatin1Char('?')) {
+            regexp += QLatin1Char('.');
+        } else if (c == QLatin1Char('[') && glob.indexOf(QLatin1Char(']'), i + 1) != -1) {
+            const int end = glob.indexOf(QLatin1Char(']'), i + 1);
+            QString set = glob.mid(i, end - i + 1);
+            if (set.startsWith(QLatin1String("[!"))) {
+                set[1] = QLatin1Char('^');
+            }
+            regexp += set;
+            i = end;
+        } else {
+            regexp += QRegularExpression::escape(QString(c));
+        }
+    }
+    return QLatin1String("\\A(?:") + regexp + QLatin1String(")\\z");
+}
+
+void LanguageLookupTable::addPattern(const QString& pattern, ILanguageSupport* language)
+{
+    Languages* languages;
+    if (pattern.startsWith(QLatin1String("*.")) && !hasWildcards(pattern.midRef(1))) {
+        languages = &m_suffixes[pattern.mid(1)];
+    } else if (!hasWildcards(QStringRef(&pattern))) {
+        languages = &m_fileNames[pattern];
+    } else {
+        m_patterns.append({QRegularExpression(globToRegularExpression(pattern),
+                                              QRegularExpression::CaseInsensitiveOption), language});
+        return;
+    }
+    if (!languages->contains(language)) {
+        languages->append(language);
+    }
+}
+
+QList<ILanguageSupport*> LanguageLookupTable::languagesForFileName(const QString& fileName) const
+{
+    QList<ILanguageSupport*> languages;
+    const auto addLanguages = [&languages](const Languages& matches) {
+        for (ILanguageSupport* language : matches) {
+            if (!languages.contains(language)) {
+                languages << language;
+            }
+        }
+    };
+
+    const auto fileNameIt = m_fileNames.constFind(fileName);
+    if (fileNameIt != m_fileNames.constEnd()) {
+        addLanguages(*fileNameIt);
+    }
+
+    // try every suffix, so that e.g. "*.tar.gz" matches as well as "*.gz"
+    for (int dot = fileName.indexOf(QLatin1Char('.')); dot != -1; dot = fileName.indexOf(QLatin1Char('.'), dot + 1)) {
+        const auto suffixIt = m_suffixes.constFind(fileName.mid(dot));
+        if (suffixIt != m_suffixes.constEnd()) {
+            addLanguages(*suffixIt);
+        }
+    }
+
+    for (const auto& pattern : m_patterns) {
+        if (!languages.contains(pattern.second) && pattern.first.match(fileName).hasMatch()) {
+            languages << pattern.second;
+        }
+    }
+
+    return languages;
+}
+
 class LanguageControllerPrivate
 {
 public:
@@ -81,6 +186,11 @@ public:
     using MimeTypeCache = QMultiHash<QMimeType, ILanguageSupport*>;
     MimeTypeCache mimeTypeCache; //Maps mimetypes to languages
 
+    /// Built from mimeTypeCache whenever a language is added, null after cleanup.
+    /// Only access it through std::atomic_load/std::atomic_store, it is read without dataMutex.
+    std::shared_ptr<const LanguageLookupTable> lookupTable = std::make_shared<LanguageLookupTable>();
+    void updateLookupTable();
+
     BackgroundParser* const backgroundParser;
     StaticAssistantsManager* staticAssistantsManager;
     bool m_cleanedUp;
@@ -110,6 +220,24 @@ void LanguageControllerPrivate::addLanguageSupport(ILanguageSupport* languageSup
             qCWarning(SHELL) << "could not create mime-type" << mimeTypeName;
         }
     }
+
+    updateLookupTable();
+}
+
+void LanguageControllerPrivate::updateLookupTable()
+{
+    if (m_cleanedUp) {
+        return;
+    }
+
+    auto table = std::make_shared<LanguageLookupTable>();
+    for (auto it = mimeTypeCache.constBegin(); it != mimeTypeCache.constEnd(); ++it) {
+        const auto globPatterns = it.key().globPatterns();
+        for (const QString& pattern : globPatterns) {
+            table->addPattern(pattern, it.value());
+        }
+    }
+    std::atomic_store(&lookupTable, std::shared_ptr<const LanguageLookupTable>(std::move(table)));
 }
 
 void LanguageControllerPrivate::addLanguageSupport(KDevelop::ILanguageSupport* languageSupport)
@@ -153,6 +281,7 @@ void LanguageController::cleanup()
 
     QMutexLocker lock(&d->dataMutex);
     d->m_cleanedUp = true;
+    std::atomic_store(&d->lookupTable, std::shared_ptr<const LanguageLookupTable>());
 }
 
 QList<ILanguageSupport*> LanguageController::activeLanguages()
@@ -248,42 +377,16 @@ QList<ILanguageSupport*> LanguageController::languagesForUrl(const QUrl &url)
 {
     Q_D(LanguageController);
 
-    QMutexLocker lock(&d->dataMutex);
-
-    QList<ILanguageSupport*> languages;
-
-    if(d->m_cleanedUp)
-        return languages;
-
-    const QString fileName = url.fileName();
+    // this is called for every file of a project, by the background parser too,
+    // so don't block on dataMutex here
+    const auto lookupTable = std::atomic_load(&d->lookupTable);
+    if (!lookupTable) {
+        // cleaned up
+        return {};
+    }
 
-    ///TODO: cache regexp or simple string pattern for endsWith matching
-    QRegExp exp(QString(), Qt::CaseInsensitive, QRegExp::Wildcard);
     ///non-crashy part: Use the mime-types of known languages
-    for(LanguageControllerPrivate::MimeTypeCache::const_iterator it = d->mimeTypeCache.constBegin();
-        it != d->mimeTypeCache.constEnd(); ++it)
-    {
-        const auto globPatterns = it.key().globPatterns();
-        for (const QString& pattern : globPatterns) {
-            if(pattern.startsWith(QLatin1Char('*'))) {
-                const QStringRef subPattern = pattern.midRef(1);
-                if (!subPattern.contains(QLatin1Char('*'))) {
-                    //optimize: we can skip the expensive QRegExp in this case
-                    //and do a simple string compare (much faster)
-                    if (fileName.endsWith(subPattern)) {
-                        languages << *it;
-                    }
-                    continue;
-                }
-            }
-
-            exp.setPattern(pattern);
-            if(int position = exp.indexIn(fileName)) {
-                if(position != -1 && exp.matchedLength() + position == fileName.length())
-                    languages << *it;
-            }
-        }
-    }
+    QList<ILanguageSupport*> languages = lookupTable->languagesForFileName(url.fileName());
 
     //Never use findByUrl from within a background thread, and never load a language support
     //from within the backgruond thread. Both is unsafe, and can lead to crashes
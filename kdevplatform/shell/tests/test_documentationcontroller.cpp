@@ -0,0 +1,112 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "test_documentationcontroller.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <interfaces/idocumentationcontroller.h>
+#include <language/duchain/declaration.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/topducontext.h>
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+
+using namespace KDevelop;
+
+QTEST_MAIN(TestDocumentationController)
+
+void TestDocumentationController::initTestCase()
+{
+    // no documentation providers, so every lookup is a miss, which is cached as well
+    AutoTestShell::init({{}});
+    TestCore::initialize();
+
+    DUChainWriteLocker lock;
+    m_topContext = new TopDUContext(IndexedString(QStringLiteral("/documentation/test.cpp")), RangeInRevision(0, 0, 1, 0));
+    DUChain::self()->addDocumentChain(m_topContext);
+    auto* declaration = new Declaration(RangeInRevision(0, 0, 0, 3), m_topContext);
+    declaration->setIdentifier(Identifier(QStringLiteral("foo")));
+    m_declaration = IndexedDeclaration(declaration);
+}
+
+void TestDocumentationController::cleanupTestCase()
+{
+    {
+        DUChainWriteLocker lock;
+        DUChain::self()->removeDocumentChain(m_topContext);
+    }
+
+    TestCore::shutdown();
+}
+
+void TestDocumentationController::cachedDocumentation()
+{
+    IDocumentationController* controller = ICore::self()->documentationController();
+    QSignalSpy spy(controller, &IDocumentationController::documentationReady);
+
+    DUChainReadLocker lock;
+    bool pending = false;
+    QVERIFY(!controller->cachedDocumentationForDeclaration(m_declaration.data(), &pending));
+    QVERIFY(pending);
+    // asking again before the lookup ran neither answers nor schedules another lookup
+    QVERIFY(!controller->cachedDocumentationForDeclaration(m_declaration.data(), &pending));
+    QVERIFY(pending);
+    QVERIFY(!controller->cachedDocumentationForDeclaration(nullptr, &pending));
+    QVERIFY(!pending);
+    lock.unlock();
+
+    // the lookup is deferred to the event loop
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+
+    lock.lock();
+    QVERIFY(!controller->cachedDocumentationForDeclaration(m_declaration.data(), &pending));
+    QVERIFY(!pending);
+    QVERIFY(!controller->documentationForDeclaration(m_declaration.data()));
+    lock.unlock();
+
+    // nothing left to look up
+    QTest::qWait(0);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestDocumentationController::reparseDropsCachedDocumentation()
+{
+    IDocumentationController* controller = ICore::self()->documentationController();
+
+    DUChainReadLocker lock;
+    QVERIFY(!controller->documentationForDeclaration(m_declaration.data()));
+    bool pending = true;
+    controller->cachedDocumentationForDeclaration(m_declaration.data(), &pending);
+    QVERIFY(!pending);
+    lock.unlock();
+
+    // the declaration indices of the reparsed file may now refer to other declarations
+    DUChain::self()->emitUpdateReady(IndexedString(QStringLiteral("/documentation/test.cpp")),
+                                     ReferencedTopDUContext(m_topContext));
+
+    lock.lock();
+    controller->cachedDocumentationForDeclaration(m_declaration.data(), &pending);
+    QVERIFY(pending);
+    lock.unlock();
+
+    QSignalSpy spy(controller, &IDocumentationController::documentationReady);
+    QVERIFY(spy.wait());
+}
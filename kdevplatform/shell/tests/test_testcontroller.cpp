@@ -28,6 +28,11 @@
 #include <itestsuite.h>
 #include <iproject.h>
 #include <language/duchain/indexeddeclaration.h>
+#include <util/projecttestjob.h>
+
+#include <KJob>
+
+#include <QTimer>
 
 using namespace KDevelop;
 
@@ -55,12 +60,63 @@ public:
     KJob* launchCase(const QString& testCase, TestJobVerbosity verbosity) override;
     KJob* launchCases(const QStringList& testCases, TestJobVerbosity verbosity) override;
 
+    bool runSerial() const override {return m_runSerial;}
+    QStringList resourceLocks() const override {return m_resourceLocks;}
+
+    bool m_runSerial = false;
+    QStringList m_resourceLocks;
+
 private:
     QString m_name;
     IProject* m_project;
     QStringList m_cases;
 };
 
+/// Keeps track of how many suites are running at once
+struct FakeTestRunState
+{
+    QList<FakeTestSuite*> running;
+    int maxRunning = 0;
+    bool serialViolated = false;
+    bool lockViolated = false;
+};
+
+static FakeTestRunState fakeTestRunState;
+
+class FakeTestSuiteJob : public KJob
+{
+public:
+    explicit FakeTestSuiteJob(FakeTestSuite* suite) : m_suite(suite) {}
+
+    void start() override
+    {
+        auto& state = fakeTestRunState;
+        for (FakeTestSuite* other : qAsConst(state.running)) {
+            if (other->m_runSerial || m_suite->m_runSerial) {
+                state.serialViolated = true;
+            }
+            for (const QString& lock : qAsConst(m_suite->m_resourceLocks)) {
+                if (other->m_resourceLocks.contains(lock)) {
+                    state.lockViolated = true;
+                }
+            }
+        }
+        state.running.append(m_suite);
+        state.maxRunning = qMax(state.maxRunning, state.running.size());
+
+        QTimer::singleShot(10, this, [this]() {
+            fakeTestRunState.running.removeOne(m_suite);
+            TestResult result;
+            result.suiteResult = TestResult::Passed;
+            ICore::self()->testController()->notifyTestRunFinished(m_suite, result);
+            emitResult();
+        });
+    }
+
+private:
+    FakeTestSuite* m_suite;
+};
+
 IndexedDeclaration FakeTestSuite::declaration() const
 {
     return IndexedDeclaration();
@@ -75,7 +131,7 @@ IndexedDeclaration FakeTestSuite::caseDeclaration(const QString& testCase) const
 KJob* FakeTestSuite::launchAllCases(ITestSuite::TestJobVerbosity verbosity)
 {
     Q_UNUSED(verbosity);
-    return nullptr;
+    return new FakeTestSuiteJob(this);
 }
 
 KJob* FakeTestSuite::launchCase(const QString& testCase, ITestSuite::TestJobVerbosity verbosity)
@@ -237,5 +293,41 @@ void TestTestController::testResults()
     delete suiteTwo;
 }
 
+void TestTestController::projectTestJob()
+{
+    QList<FakeTestSuite*> suites;
+    for (int i = 0; i < 8; ++i) {
+        suites << new FakeTestSuite(QStringLiteral("ParallelSuite%1").arg(i), m_project);
+    }
+    suites[1]->m_runSerial = true;
+    suites[2]->m_resourceLocks = QStringList{QStringLiteral("database")};
+    suites[3]->m_resourceLocks = QStringList{QStringLiteral("network"), QStringLiteral("database")};
+    suites[4]->m_resourceLocks = QStringList{QStringLiteral("database")};
+    for (FakeTestSuite* suite : qAsConst(suites)) {
+        m_testController->addTestSuite(suite);
+    }
+
+    fakeTestRunState = FakeTestRunState();
+
+    auto* job = new ProjectTestJob(m_project, this);
+    job->setAutoDelete(false);
+    job->setMaxParallelSuites(3);
+    QSignalSpy spy(job, &KJob::finished);
+    job->start();
+    QVERIFY(spy.wait());
+
+    QCOMPARE(job->testResult().total, suites.size());
+    QCOMPARE(job->testResult().passed, suites.size());
+    QVERIFY(fakeTestRunState.maxRunning > 1);
+    QVERIFY(fakeTestRunState.maxRunning <= 3);
+    QVERIFY(!fakeTestRunState.serialViolated);
+    QVERIFY(!fakeTestRunState.lockViolated);
+    delete job;
+
+    for (FakeTestSuite* suite : qAsConst(suites)) {
+        m_testController->removeTestSuite(suite);
+        delete suite;
+    }
+}
 
 QTEST_GUILESS_MAIN(TestTestController)
@@ -43,6 +43,7 @@ private Q_SLOTS:
 
     void findByProject();
     void testResults();
+    void projectTestJob();
 
     void cleanupTestCase();
 
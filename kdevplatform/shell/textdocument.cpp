@@ -19,13 +19,20 @@
 #include "textdocument.h"
 
 #include <QAction>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QLabel>
 #include <QMenu>
 #include <QMimeDatabase>
 #include <QPointer>
+#include <QTimer>
 #include <QWidget>
 
+#include <algorithm>
+#include <functional>
+
 #include <KActionCollection>
+#include <KConfig>
 #include <KConfigGroup>
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -263,6 +270,35 @@ public:
     QPointer<QMenu> currentContextMenu;
 };
 
+/**
+ * Stands in for the editor view of a TextView with deferred loading,
+ * until it is shown for the first time.
+ */
+class TextViewPlaceholder : public QLabel
+{
+public:
+    TextViewPlaceholder(const QString& text, QWidget* parent, const std::function<void()>& onShown)
+        : QLabel(text, parent)
+        , m_onShown(onShown)
+    {
+        setAlignment(Qt::AlignCenter);
+        setFocusPolicy(Qt::StrongFocus);
+    }
+
+protected:
+    void showEvent(QShowEvent* event) override
+    {
+        QLabel::showEvent(event);
+        if (m_onShown) {
+            m_onShown();
+            m_onShown = nullptr;
+        }
+    }
+
+private:
+    std::function<void()> m_onShown;
+};
+
 class TextViewPrivate
 {
 public:
@@ -270,7 +306,11 @@ public:
 
     TextView* const q;
     QPointer<KTextEditor::View> view;
-    KTextEditor::Range initialRange;
+    KTextEditor::Range initialRange = KTextEditor::Range::invalid();
+    bool loadDeferred = false;
+    QPointer<QWidget> placeholder;
+    /// session config read while there was no editor view yet
+    QMap<QString, QString> pendingSessionConfig;
 };
 
 TextDocument::TextDocument(const QUrl &url, ICore* core, const QString& encoding)
@@ -290,6 +330,16 @@ bool TextDocument::isTextDocument() const
 
     if( !d->document )
     {
+        // not loaded yet, as none of its views was shown so far
+        const auto views = this->views();
+        const bool loadDeferred = std::any_of(views.begin(), views.end(), [](Sublime::View* view) {
+            auto textView = qobject_cast<TextView*>(view);
+            return textView && textView->isLoadDeferred();
+        });
+        if (loadDeferred) {
+            return false;
+        }
+
         /// @todo Somehow it can happen that d->document is zero, which makes
         /// code relying on "isTextDocument() == (bool)textDocument()" crash
         qCWarning(SHELL) << "Broken text-document: " << url();
@@ -496,9 +546,14 @@ void TextDocument::setCursorPosition(const KTextEditor::Cursor &cursor)
 {
     Q_D(TextDocument);
 
-    if (!cursor.isValid() || !d->document)
+    if (!cursor.isValid())
         return;
 
+    if (!d->document) {
+        setInitialRangeOfViews({cursor, cursor});
+        return;
+    }
+
     KTextEditor::View *view = activeTextView();
 
     // Rodda: Cursor must be accurate here, to the definition of accurate for KTextEditor::Cursor.
@@ -596,9 +651,14 @@ void TextDocument::setTextSelection(const KTextEditor::Range &range)
 {
     Q_D(TextDocument);
 
-    if (!range.isValid() || !d->document)
+    if (!range.isValid())
         return;
 
+    if (!d->document) {
+        setInitialRangeOfViews(range);
+        return;
+    }
+
     KTextEditor::View *view = activeTextView();
 
     if (view) {
@@ -606,6 +666,17 @@ void TextDocument::setTextSelection(const KTextEditor::Range &range)
     }
 }
 
+void TextDocument::setInitialRangeOfViews(const KTextEditor::Range& range)
+{
+    // the views were not shown yet, apply the range once they are
+    const auto views = this->views();
+    for (auto view : views) {
+        if (auto textView = qobject_cast<TextView*>(view)) {
+            textView->setInitialRange(range);
+        }
+    }
+}
+
 Sublime::View* TextDocument::newView(Sublime::Document* doc)
 {
     Q_UNUSED(doc);
@@ -628,6 +699,17 @@ QWidget * KDevelop::TextView::createWidget(QWidget * parent)
 
     auto textDocument = qobject_cast<TextDocument*>(document());
     Q_ASSERT(textDocument);
+
+    if (d->loadDeferred && !textDocument->textDocument()) {
+        auto placeholder = new TextViewPlaceholder(document()->title(), parent, [this] {
+            Q_D(TextView);
+            // not from within the show event, the placeholder gets replaced
+            QTimer::singleShot(0, d->placeholder.data(), [this] { createEditorView(); });
+        });
+        d->placeholder = placeholder;
+        return placeholder;
+    }
+
     QWidget* widget = textDocument->createViewWidget(parent);
     d->view = qobject_cast<KTextEditor::View*>(widget);
     Q_ASSERT(d->view);
@@ -635,6 +717,58 @@ QWidget * KDevelop::TextView::createWidget(QWidget * parent)
     return widget;
 }
 
+void KDevelop::TextView::setLoadDeferred(bool deferred)
+{
+    Q_D(TextView);
+
+    d->loadDeferred = deferred;
+    if (!deferred) {
+        createEditorView();
+    }
+}
+
+bool KDevelop::TextView::isLoadDeferred() const
+{
+    Q_D(const TextView);
+
+    return d->loadDeferred;
+}
+
+void KDevelop::TextView::createEditorView()
+{
+    Q_D(TextView);
+
+    if (d->view || !d->placeholder) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    d->loadDeferred = false;
+    QWidget* widget = createWidget(d->placeholder->parentWidget());
+
+    if (!d->pendingSessionConfig.isEmpty()) {
+        KConfig config(QString(), KConfig::SimpleConfig);
+        KConfigGroup group(&config, "View");
+        for (auto it = d->pendingSessionConfig.constBegin(), end = d->pendingSessionConfig.constEnd(); it != end; ++it) {
+            group.writeEntry(it.key(), it.value());
+        }
+        d->view->readSessionConfig(group);
+        d->pendingSessionConfig.clear();
+    }
+    if (d->initialRange.isValid()) {
+        selectAndReveal(d->view, d->initialRange);
+        d->initialRange = KTextEditor::Range::invalid();
+    }
+
+    setWidget(widget);
+    d->placeholder.clear();
+
+    qCDebug(SHELL) << "created deferred editor view for" << document()->documentSpecifier()
+                   << "in" << timer.elapsed() << "ms";
+}
+
 void KDevelop::TextView::setInitialRange(const KTextEditor::Range& range)
 {
     Q_D(TextView);
@@ -658,6 +792,9 @@ void KDevelop::TextView::readSessionConfig(KConfigGroup& config)
     Q_D(TextView);
 
     if (!d->view) {
+        if (d->loadDeferred) {
+            d->pendingSessionConfig = config.entryMap();
+        }
         return;
     }
     d->view->readSessionConfig(config);
@@ -668,6 +805,10 @@ void KDevelop::TextView::writeSessionConfig(KConfigGroup& config)
     Q_D(TextView);
 
     if (!d->view) {
+        // keep the state of views which were never shown
+        for (auto it = d->pendingSessionConfig.constBegin(), end = d->pendingSessionConfig.constEnd(); it != end; ++it) {
+            config.writeEntry(it.key(), it.value());
+        }
         return;
     }
     d->view->writeSessionConfig(config);
@@ -95,6 +95,7 @@ private:
     void slotDocumentLoaded();
     void documentSaved(KTextEditor::Document*,bool);
     void repositoryCheckFinished(bool);
+    void setInitialRangeOfViews(const KTextEditor::Range& range);
 
 private:
     const QScopedPointer<class TextDocumentPrivate> d_ptr;
@@ -121,8 +122,22 @@ public:
     void setInitialRange(const KTextEditor::Range& range);
     KTextEditor::Range initialRange() const;
 
+    /**
+     * Defer loading the document until this view is shown for the first time.
+     *
+     * Until then, a lightweight placeholder is shown instead of the editor view,
+     * so neither the KTextEditor document nor its view are created. This is used
+     * for views restored from a working set, where most of them are never looked at.
+     *
+     * Has to be set before the widget of this view is created. Turning it off
+     * once the placeholder was created replaces it with the editor view right away.
+     */
+    void setLoadDeferred(bool deferred);
+    bool isLoadDeferred() const;
+
 private:
     void sendStatusChanged();
+    void createEditorView();
 
 private:
     const QScopedPointer<class TextViewPrivate> d_ptr;
@@ -22,6 +22,7 @@
 #include <sublime/area.h>
 #include <sublime/mainwindow.h>
 
+#include <QElapsedTimer>
 #include <QPainter>
 
 #include <KProtocolInfo>
@@ -261,6 +262,9 @@ void WorkingSet::loadToArea(Sublime::Area* area, Sublime::AreaIndex* areaIndex)
 
     qCDebug(SHELL) << "loading working-set" << m_id << "into area" << area;
 
+    QElapsedTimer timer;
+    timer.start();
+
     QMultiMap<QString, Sublime::View*> recycle;
 
     const auto viewsBefore = area->views();
@@ -306,6 +310,8 @@ void WorkingSet::loadToArea(Sublime::Area* area, Sublime::AreaIndex* areaIndex)
                 }
         }
     }
+
+    qCDebug(SHELL) << "loaded working-set" << m_id << "with" << area->views().size() << "views in" << timer.elapsed() << "ms";
 }
 
 void WorkingSet::loadToArea(Sublime::Area* area, Sublime::AreaIndex* areaIndex, const KConfigGroup& setGroup, const KConfigGroup& areaGroup, QMultiMap<QString, Sublime::View*>& recycle)
@@ -358,6 +364,10 @@ void WorkingSet::loadToArea(Sublime::Area* area, Sublime::AreaIndex* areaIndex,
             auto *document = dynamic_cast<Sublime::Document*>(doc);
             if (document) {
                 Sublime::View* view = document->createView();
+                // only load the documents which are actually shown
+                if (auto textView = qobject_cast<TextView*>(view)) {
+                    textView->setLoadDeferred(true);
+                }
                 area->addView(view, areaIndex, previousView);
                 createdViews[i] = view;
             } else {
@@ -461,6 +461,7 @@ void Container::addWidget(View *view, int position)
     d->tabBar->setMinimumHeight(d->tabBar->sizeHint().height());
 
     connect(view, &View::statusChanged, this, &Container::statusChanged);
+    connect(view, &View::widgetChanged, this, &Container::viewWidgetChanged);
     connect(view->document(), &Document::statusIconChanged, this, &Container::statusIconChanged);
     connect(view->document(), &Document::titleChanged, this, &Container::documentTitleChanged);
 }
@@ -474,6 +475,27 @@ void Container::statusChanged(Sublime::View* view)
     d->statusCorner->setVisible(!statusText.isEmpty());
 }
 
+void Container::viewWidgetChanged(Sublime::View* view, QWidget* oldWidget)
+{
+    Q_D(Container);
+
+    const int idx = d->stack->indexOf(oldWidget);
+    if (idx == -1) {
+        return;
+    }
+
+    // swap the widget in place, the tab stays as it is
+    const bool isCurrent = (d->stack->currentIndex() == idx);
+    QWidget* w = view->widget(this);
+    d->stack->insertWidget(idx, w);
+    d->stack->removeWidget(oldWidget);
+    if (isCurrent) {
+        d->stack->setCurrentIndex(idx);
+    }
+    d->viewForWidget.remove(oldWidget);
+    d->viewForWidget[w] = view;
+}
+
 void Container::statusIconChanged(Document* doc)
 {
     Q_D(Container);
@@ -595,6 +617,7 @@ void Container::removeWidget(QWidget *w)
             disconnect(view->document(), &Document::titleChanged, this, &Container::documentTitleChanged);
             disconnect(view->document(), &Document::statusIconChanged, this, &Container::statusIconChanged);
             disconnect(view, &View::statusChanged, this, &Container::statusChanged);
+            disconnect(view, &View::widgetChanged, this, &Container::viewWidgetChanged);
 
             // Update document list context menu
             Q_ASSERT(d->documentListActionForView.contains(view));
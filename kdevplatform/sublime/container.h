@@ -102,6 +102,7 @@ private Q_SLOTS:
     void documentTitleChanged(Sublime::Document* doc);
     void statusIconChanged(Sublime::Document*);
     void statusChanged(Sublime::View *view);
+    void viewWidgetChanged(Sublime::View* view, QWidget* oldWidget);
     void requestClose(int idx);
     void tabMoved(int from, int to);
     void contextMenu(const QPoint&);
@@ -426,6 +426,8 @@ Area::WalkerMode MainWindowPrivate::ViewCreator::operator() (AreaIndex *index)
                     container->addWidget(view, position);
                     d->viewContainers[view] = container;
                     d->widgetToView[widget] = view;
+                    connect(view, &View::widgetChanged,
+                            d, &MainWindowPrivate::viewWidgetChanged, Qt::UniqueConnection);
                 }
                 if(activeView == view)
                 {
@@ -783,6 +785,25 @@ void MainWindowPrivate::widgetCloseRequest(QWidget* widget)
     }
 }
 
+void MainWindowPrivate::viewWidgetChanged(Sublime::View* view, QWidget* oldWidget)
+{
+    if (widgetToView.value(oldWidget) != view) {
+        return;
+    }
+
+    widgetToView.remove(oldWidget);
+    QWidget* widget = view->widget();
+    widgetToView[widget] = view;
+
+    if (activeView == view) {
+        // let everybody pick up the actual widget, e.g. the GUI client of an editor view
+        emit m_mainWindow->activeViewChanged(view);
+        if (oldWidget->hasFocus()) {
+            widget->setFocus();
+        }
+    }
+}
+
 
 void MainWindowPrivate::setTabBarLeftCornerWidget(QWidget* widget)
 {
@@ -130,6 +130,7 @@ private Q_SLOTS:
     void updateAreaSwitcher(Sublime::Area *area);
     void slotDockShown(Sublime::View*, Sublime::Position, bool);
     void widgetCloseRequest(QWidget* widget);
+    void viewWidgetChanged(Sublime::View* view, QWidget* oldWidget);
 
     void showLeftDock(bool b);
     void showRightDock(bool b);
@@ -18,11 +18,17 @@
  ***************************************************************************/
 #include "test_view.h"
 
+#include <QLabel>
+#include <QPointer>
+#include <QSignalSpy>
 #include <QTextEdit>
 #include <QTest>
 #include <QStandardPaths>
 
+#include <sublime/area.h>
+#include <sublime/container.h>
 #include <sublime/controller.h>
+#include <sublime/mainwindow.h>
 #include <sublime/tooldocument.h>
 #include <sublime/view.h>
 
@@ -61,6 +67,26 @@ protected:
     View *newView(Document *doc) override { return new Test(doc); }
 };
 
+class PlaceholderView: public View {
+Q_OBJECT
+public:
+    explicit PlaceholderView(Document *doc): View(doc) {}
+    void load() { setWidget(new QTextEdit(widget()->parentWidget())); }
+protected:
+    QWidget *createWidget(QWidget *parent) override { return new QLabel(QStringLiteral("placeholder"), parent); }
+};
+
+class PlaceholderDocument: public Document {
+Q_OBJECT
+public:
+    PlaceholderDocument(const QString &title, Controller *controller): Document(title, controller) {}
+    QString documentType() const override { return QStringLiteral("Placeholder"); }
+    QString documentSpecifier() const override { return QString(); }
+protected:
+    QWidget *createViewWidget(QWidget *parent = nullptr) override { return new QWidget(parent); }
+    View *newView(Document *doc) override { return new PlaceholderView(doc); }
+};
+
 void TestView::initTestCase()
 {
     QStandardPaths::setTestModeEnabled(true);
@@ -74,6 +100,72 @@ void TestView::viewReimplementation()
     QVERIFY(dynamic_cast<Test*>(view) != nullptr);
 }
 
+void TestView::widgetReplacement()
+{
+    Controller controller;
+    auto *area = new Area(&controller, QStringLiteral("Area"));
+    auto *doc1 = new PlaceholderDocument(QStringLiteral("doc1"), &controller);
+    auto *doc2 = new PlaceholderDocument(QStringLiteral("doc2"), &controller);
+    auto *view1 = static_cast<PlaceholderView*>(doc1->createView());
+    area->addView(view1);
+    auto *view2 = static_cast<PlaceholderView*>(doc2->createView());
+    area->addView(view2);
+
+    // deleted by the controller
+    auto *mw = new MainWindow(&controller);
+    controller.addDefaultArea(area);
+    controller.addMainWindow(mw);
+    controller.showArea(area, mw);
+    mw->resize(800, 600);
+    mw->show();
+    QVERIFY(QTest::qWaitForWindowExposed(mw));
+    mw->activateView(view2);
+    QCOMPARE(mw->activeView(), view2);
+
+    QCOMPARE(mw->containers().size(), 1);
+    Container *container = mw->containers().first();
+    QCOMPARE(container->count(), 2);
+    QPointer<QWidget> placeholder1 = view1->widget();
+    QPointer<QWidget> placeholder2 = view2->widget();
+    QVERIFY(qobject_cast<QLabel*>(placeholder1.data()));
+    QCOMPARE(container->currentWidget(), placeholder2.data());
+
+    QSignalSpy widgetChangedSpy(view2, &View::widgetChanged);
+    QSignalSpy activeViewSpy(mw, &MainWindow::activeViewChanged);
+
+    // replace the widget of the current view
+    view2->load();
+    QCOMPARE(widgetChangedSpy.count(), 1);
+    QCOMPARE(widgetChangedSpy.first().at(1).value<QWidget*>(), placeholder2.data());
+    QVERIFY(qobject_cast<QTextEdit*>(view2->widget()));
+    QCOMPARE(container->count(), 2);
+    QCOMPARE(container->indexOf(view2->widget()), 1);
+    QCOMPARE(container->indexOf(placeholder2), -1);
+    QCOMPARE(container->currentWidget(), view2->widget());
+    QCOMPARE(container->viewForWidget(view2->widget()), view2);
+    QVERIFY(!container->viewForWidget(placeholder2));
+    QCOMPARE(activeViewSpy.count(), 1);
+    QCOMPARE(activeViewSpy.first().at(0).value<View*>(), view2);
+    const QPoint center = container->mapToGlobal(container->rect().center());
+    QCOMPARE(mw->viewForPosition(center), view2);
+
+    // the placeholder is deleted later, without unsetting the new widget
+    QTRY_VERIFY(!placeholder2);
+    QVERIFY(view2->hasWidget());
+    QVERIFY(qobject_cast<QTextEdit*>(view2->widget()));
+
+    // replace the widget of a view in the background
+    view1->load();
+    QCOMPARE(activeViewSpy.count(), 1);
+    QCOMPARE(container->indexOf(view1->widget()), 0);
+    QCOMPARE(container->currentWidget(), view2->widget());
+    QCOMPARE(container->viewForWidget(view1->widget()), view1);
+    QTRY_VERIFY(!placeholder1);
+
+    container->setCurrentWidget(view1->widget());
+    QCOMPARE(mw->viewForPosition(center), view1);
+}
+
 QTEST_MAIN(TestView)
 
 #include "test_view.moc"
@@ -27,6 +27,7 @@ private Q_SLOTS:
     void initTestCase();
     void widgetDeletion();
     void viewReimplementation();
+    void widgetReplacement();
 };
 
 #endif
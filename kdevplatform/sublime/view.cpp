@@ -34,6 +34,7 @@ public:
     ViewPrivate(Document* doc, View::WidgetOwnership ws);
 
     void unsetWidget();
+    void watchWidget(View* view);
 
     QWidget* widget = nullptr;
     Document* const doc;
@@ -51,6 +52,22 @@ void ViewPrivate::unsetWidget()
     widget = nullptr;
 }
 
+void ViewPrivate::watchWidget(View* view)
+{
+    // if we own this widget, we will also delete it and ideally would disconnect
+    // the following connect before doing that. For that though we would need to store
+    // a reference to the connection.
+    // As the d object still exists in the destructor when we delete the widget
+    // this lambda method though can be still safely executed, so we spare ourselves such disconnect.
+    QObject::connect(widget, &QWidget::destroyed,
+                     view, [this](QObject* object) {
+        // a replaced widget might be destroyed only after its successor was set
+        if (widget == object) {
+            unsetWidget();
+        }
+    });
+}
+
 View::View(Document *doc, WidgetOwnership ws )
     : QObject(doc)
     , d_ptr(new ViewPrivate(doc, ws))
@@ -82,17 +99,32 @@ QWidget *View::widget(QWidget *parent)
     if (!d->widget)
     {
         d->widget = createWidget(parent);
-        // if we own this widget, we will also delete it and ideally would disconnect
-        // the following connect before doing that. For that though we would need to store
-        // a reference to the connection.
-        // As the d object still exists in the destructor when we delete the widget
-        // this lambda method though can be still safely executed, so we spare ourselves such disconnect.
-        connect(d->widget, &QWidget::destroyed,
-                this, [this] { Q_D(View); d->unsetWidget(); });
+        d->watchWidget(this);
     }
     return d->widget;
 }
 
+void View::setWidget(QWidget* widget)
+{
+    Q_D(View);
+
+    QWidget* const oldWidget = d->widget;
+    if (!widget || widget == oldWidget) {
+        return;
+    }
+
+    d->widget = widget;
+    d->watchWidget(this);
+
+    if (oldWidget) {
+        emit widgetChanged(this, oldWidget);
+        if (d->ws == View::TakeOwnership) {
+            oldWidget->hide();
+            oldWidget->deleteLater();
+        }
+    }
+}
+
 QWidget *View::createWidget(QWidget *parent)
 {
     Q_D(View);
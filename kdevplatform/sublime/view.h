@@ -95,6 +95,11 @@ Q_SIGNALS:
     /// Notify that the status for this document has changed
     void statusChanged(Sublime::View*);
     void positionChanged(Sublime::View*, int);
+    /**
+     * Emitted when the widget of this view was replaced, see setWidget().
+     * @p oldWidget is deleted later on.
+     */
+    void widgetChanged(Sublime::View* view, QWidget* oldWidget);
 
 public Q_SLOTS:
     void requestRaise();
@@ -108,6 +113,15 @@ protected:
      */
     virtual QWidget *createWidget(QWidget *parent);
 
+    /**
+     * Replaces the widget of this view with @p widget.
+     *
+     * This allows views to show a lightweight placeholder at first and only create
+     * their actual widget when it is needed, e.g. when being shown for the first time.
+     * Containers showing the view pick up the new widget via widgetChanged().
+     */
+    void setWidget(QWidget* widget);
+
 private:
     //copy is not allowed, create a new view from the document instead
     View(const View &v);
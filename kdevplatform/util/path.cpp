@@ -25,6 +25,9 @@
 
 #include <QStringList>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
 
 #include <language/util/kdevhash.h>
 
@@ -42,6 +45,78 @@ inline bool isWindowsDriveLetter(const QString& segment)
 #endif
 }
 
+/**
+ * Global pool of path segments, so that equal segments share their data.
+ *
+ * The pool is split into shards with a mutex each, so paths can be created
+ * concurrently from multiple threads, e.g. by project importers, with little contention.
+ *
+ * Segments which are only referenced by the pool anymore are released whenever a shard
+ * has doubled its size since it was last purged. A segment is only ever shared by handing
+ * out the pooled copy, so once it is released no path can refer to its old data anymore.
+ */
+class SegmentPool
+{
+public:
+    QString intern(const QString& segment)
+    {
+        if (segment.isEmpty()) {
+            // also turns empty strings into null ones, so they share the same data
+            return QString();
+        }
+
+        Shard& shard = m_shards[qHash(segment) % shardCount];
+        QMutexLocker lock(&shard.mutex);
+        auto it = shard.segments.constFind(segment);
+        if (it == shard.segments.constEnd()) {
+            if (shard.segments.size() >= shard.purgeThreshold) {
+                purge(shard);
+            }
+            // always store a deep copy: static data, e.g. from QStringLiteral, has no reference count
+            // and would be released while still in use, a copy of a larger string would keep it alive
+            it = shard.segments.insert(QString(segment.constData(), segment.size()));
+        }
+        return *it;
+    }
+
+    static SegmentPool& self()
+    {
+        // intentionally leaked, so paths can still be created during static destruction
+        static auto* pool = new SegmentPool;
+        return *pool;
+    }
+
+private:
+    static constexpr uint shardCount = 16;
+    static constexpr int minPurgeThreshold = 1024;
+
+    struct Shard
+    {
+        QMutex mutex;
+        QSet<QString> segments;
+        int purgeThreshold = minPurgeThreshold;
+    };
+
+    /// the shard mutex must be locked, it also protects new references to the pooled segments
+    static void purge(Shard& shard)
+    {
+        for (auto it = shard.segments.begin(); it != shard.segments.end();) {
+            if (it->isDetached()) {
+                it = shard.segments.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        shard.purgeThreshold = qMax(minPurgeThreshold, shard.segments.size() * 2);
+    }
+    Shard m_shards[shardCount];
+};
+
+inline QString internSegment(const QString& segment)
+{
+    return SegmentPool::self().intern(segment);
+}
+
 inline bool isAbsolutePath(const QString& path)
 {
     if (path.startsWith(QLatin1Char('/'))) {
@@ -108,7 +183,7 @@ Path::Path(const QUrl& url)
         if (url.port() != -1) {
             urlPrefix += QLatin1Char(':') + QString::number(url.port());
         }
-        m_data << urlPrefix;
+        m_data << internSegment(urlPrefix);
     }
 
     addPath(url.isLocalFile() ? url.toLocalFile() : url.path());
@@ -347,10 +422,10 @@ void Path::setLastPathSegment(const QString& name)
     // remote Paths are offset by one, thus never return the first item of them as file name
     if (m_data.isEmpty() || (!isLocalFile() && m_data.size() == 1)) {
         // append the name to empty Paths or remote Paths only containing the Path prefix
-        m_data.append(name);
+        m_data.append(internSegment(name));
     } else {
         // overwrite the last data member
-        m_data.last() = name;
+        m_data.last() = internSegment(name);
     }
 }
 
@@ -385,7 +460,7 @@ static void cleanPath(QVector<QString>* data, const bool isRemote)
     }
 }
 
-// Optimized QString::split code for the specific Path use-case
+// Optimized QString::split code for the specific Path use-case, also interning the segments
 static QVarLengthArray<QString, 16> splitPath(const QString& source)
 {
     QVarLengthArray<QString, 16> list;
@@ -393,12 +468,12 @@ static QVarLengthArray<QString, 16> splitPath(const QString& source)
     int end = 0;
     while ((end = source.indexOf(QLatin1Char('/'), start)) != -1) {
         if (start != end) {
-            list.append(source.mid(start, end - start));
+            list.append(internSegment(source.mid(start, end - start)));
         }
         start = end + 1;
     }
     if (start != source.size()) {
-        list.append(source.mid(start, -1));
+        list.append(internSegment(source.mid(start, -1)));
     }
     return list;
 }
@@ -471,6 +546,8 @@ Path Path::cd(const QString& dir) const
 namespace KDevelop {
 uint qHash(const Path& path)
 {
+    // hashes the contents rather than the interned data, the result is used e.g.
+    // for the colors of the projects, which must not change between sessions
     KDevHash hash;
     for (const QString& segment : path.segments()) {
         hash << qHash(segment);
@@ -65,13 +65,16 @@ QString KDEVPLATFORMUTIL_EXPORT toUrlOrLocalFile(const QUrl& url,
  * Path asdf(foo, "asdf.txt");
  * @endcode
  *
- * @note Just as with QString e.g. you won't share any data implicitly when
- * you do something like this:
+ * @note The segments themselves are interned in a global pool, so equal segments
+ * share their data even between paths that were created independently, like here:
  *
  * @code
  * Path foo1("/foo");
  * Path foo2("/foo");
  * @endcode
+ *
+ * Only the list of segments is not shared in this case. Interning also allows
+ * comparing paths for equality by comparing the data pointers of their segments.
  */
 class KDEVPLATFORMUTIL_EXPORT Path
 {
@@ -141,7 +144,14 @@ public:
             return false;
         // Optimization: compare in reverse order as often the mismatch is at the end,
         // while the first few path segments are usually the same in different paths.
-        return std::equal(m_data.rbegin(), m_data.rend(), other.m_data.rbegin());
+        // All segments are interned, so equal segments share the same data.
+        return std::equal(m_data.rbegin(), m_data.rend(), other.m_data.rbegin(),
+                          [](const QString& segment, const QString& otherSegment) {
+            const bool equal = segment.constData() == otherSegment.constData();
+            Q_ASSERT_X(equal == (segment == otherSegment), "Path::operator==",
+                       "path segments must be interned");
+            return equal;
+        });
     }
 
     /**
@@ -23,66 +23,172 @@
 #include <interfaces/icore.h>
 #include <interfaces/itestcontroller.h>
 #include <interfaces/iproject.h>
+#include <interfaces/isession.h>
 #include <interfaces/itestsuite.h>
+#include <KConfigGroup>
 #include <KLocalizedString>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+
 using namespace KDevelop;
 
+namespace {
+
+KConfigGroup durationsGroup(IProject* project)
+{
+    ISession* session = ICore::self()->activeSession();
+    if (!session) {
+        return KConfigGroup();
+    }
+    return session->config()->group("Test Durations").group(project->name());
+}
+
+}
+
 class KDevelop::ProjectTestJobPrivate
 {
 public:
     explicit ProjectTestJobPrivate(ProjectTestJob* q)
         : q(q)
-        , m_currentJob(nullptr)
-        , m_currentSuite(nullptr)
+        , m_maxParallelSuites(qMax(1, QThread::idealThreadCount()))
     {}
 
+    struct RunningSuite
+    {
+        KJob* job;
+        QElapsedTimer timer;
+    };
+
+    void sortByDuration();
+    bool canStart(const ITestSuite* suite) const;
     void runNext();
     void gotResult(ITestSuite* suite, const TestResult& result);
 
     ProjectTestJob* q;
 
+    IProject* m_project = nullptr;
+    int m_maxParallelSuites;
+    /// Suites still to be launched, the slowest ones first
     QList<ITestSuite*> m_suites;
-    KJob* m_currentJob;
-    ITestSuite* m_currentSuite;
+    QHash<ITestSuite*, RunningSuite> m_running;
+    QSet<QString> m_heldLocks;
+    bool m_serialRunning = false;
     ProjectTestResult m_result;
 };
 
+void ProjectTestJobPrivate::sortByDuration()
+{
+    // Start the slowest suites first, so a long running one is not left for the end
+    // while all the other workers are idle. Suites without a recorded duration
+    // go first, nothing is known about them yet.
+    const KConfigGroup durations = durationsGroup(m_project);
+    if (!durations.isValid()) {
+        return;
+    }
+
+    QHash<ITestSuite*, qint64> suiteDurations;
+    for (ITestSuite* suite : qAsConst(m_suites)) {
+        suiteDurations.insert(suite, durations.readEntry(suite->name(), qint64(-1)));
+    }
+
+    std::stable_sort(m_suites.begin(), m_suites.end(), [&suiteDurations](ITestSuite* a, ITestSuite* b) {
+        const qint64 durationA = suiteDurations.value(a);
+        const qint64 durationB = suiteDurations.value(b);
+        if ((durationA < 0) != (durationB < 0)) {
+            return durationA < 0;
+        }
+        return durationA > durationB;
+    });
+}
+
+bool ProjectTestJobPrivate::canStart(const ITestSuite* suite) const
+{
+    if (suite->runSerial()) {
+        return m_running.isEmpty();
+    }
+
+    const auto locks = suite->resourceLocks();
+    return std::none_of(locks.begin(), locks.end(), [this](const QString& lock) {
+        return m_heldLocks.contains(lock);
+    });
+}
+
 void ProjectTestJobPrivate::runNext()
 {
-    m_currentSuite = m_suites.takeFirst();
-    m_currentJob = m_currentSuite->launchAllCases(ITestSuite::Silent);
-    m_currentJob->start();
+    for (auto it = m_suites.begin(); it != m_suites.end() && !m_serialRunning
+                                     && m_running.size() < m_maxParallelSuites;) {
+        ITestSuite* suite = *it;
+        if (!canStart(suite)) {
+            ++it;
+            continue;
+        }
+        it = m_suites.erase(it);
+
+        m_serialRunning = suite->runSerial();
+        const auto locks = suite->resourceLocks();
+        for (const QString& lock : locks) {
+            m_heldLocks.insert(lock);
+        }
+
+        RunningSuite& running = m_running[suite];
+        running.job = suite->launchAllCases(ITestSuite::Silent);
+        running.timer.start();
+        // this might finish the job synchronously and modify the containers
+        running.job->start();
+        it = m_suites.begin();
+    }
 }
 
 void ProjectTestJobPrivate::gotResult(ITestSuite* suite, const TestResult& result)
 {
-    if (suite == m_currentSuite) {
-        m_result.total++;
-        q->emitPercent(m_result.total, m_result.total + m_suites.size());
+    const auto it = m_running.find(suite);
+    if (it == m_running.end()) {
+        return;
+    }
 
-        switch (result.suiteResult) {
-        case TestResult::Passed:
-            m_result.passed++;
-            break;
+    KConfigGroup durations = durationsGroup(m_project);
+    if (durations.isValid()) {
+        durations.writeEntry(suite->name(), it->timer.elapsed());
+    }
+    m_running.erase(it);
 
-        case TestResult::Failed:
-            m_result.failed++;
-            break;
+    if (suite->runSerial()) {
+        m_serialRunning = false;
+    }
+    const auto locks = suite->resourceLocks();
+    for (const QString& lock : locks) {
+        m_heldLocks.remove(lock);
+    }
 
-        case TestResult::Error:
-            m_result.error++;
-            break;
+    m_result.total++;
+    q->emitPercent(m_result.total, m_result.total + m_running.size() + m_suites.size());
 
-        default:
-            break;
-        }
+    switch (result.suiteResult) {
+    case TestResult::Passed:
+        m_result.passed++;
+        break;
 
-        if (m_suites.isEmpty()) {
-            q->emitResult();
-        } else {
-            runNext();
-        }
+    case TestResult::Failed:
+        m_result.failed++;
+        break;
+
+    case TestResult::Error:
+        m_result.error++;
+        break;
+
+    default:
+        break;
+    }
+
+    if (m_suites.isEmpty() && m_running.isEmpty()) {
+        q->emitResult();
+    } else {
+        runNext();
     }
 }
 
@@ -95,6 +201,7 @@ ProjectTestJob::ProjectTestJob(IProject* project, QObject* parent)
     setCapabilities(Killable);
     setObjectName(i18n("Run all tests in %1", project->name()));
 
+    d->m_project = project;
     d->m_suites = ICore::self()->testController()->testSuitesForProject(project);
     connect(ICore::self()->testController(), &ITestController::testRunFinished,
             this, [this](ITestSuite* suite, const TestResult& result) {
@@ -111,16 +218,34 @@ ProjectTestJob::~ProjectTestJob()
 void ProjectTestJob::start()
 {
     Q_D(ProjectTestJob);
+    if (d->m_suites.isEmpty()) {
+        emitResult();
+        return;
+    }
+    d->sortByDuration();
     d->runNext();
 }
 
+void ProjectTestJob::setMaxParallelSuites(int count)
+{
+    Q_D(ProjectTestJob);
+    d->m_maxParallelSuites = qMax(1, count);
+}
+
+int ProjectTestJob::maxParallelSuites() const
+{
+    Q_D(const ProjectTestJob);
+    return d->m_maxParallelSuites;
+}
+
 bool ProjectTestJob::doKill()
 {
     Q_D(ProjectTestJob);
-    if (d->m_currentJob) {
-        d->m_currentJob->kill();
-    } else {
-        d->m_suites.clear();
+    d->m_suites.clear();
+    // killing a job might emit its result and modify m_running
+    const auto running = d->m_running;
+    for (const auto& suite : running) {
+        suite.job->kill();
     }
     return true;
 }
@@ -64,6 +64,7 @@ struct KDEVPLATFORMUTIL_EXPORT ProjectTestResult
  *
  * Launches all test suites in the specified project without raising the output window.
  * Instead of providing individual test results, it combines and simplifies them.
+ * Multiple suites are run in parallel, see setMaxParallelSuites().
  *
  **/
 class KDEVPLATFORMUTIL_EXPORT ProjectTestJob : public KJob
@@ -101,6 +102,22 @@ public:
      **/
     ProjectTestResult testResult();
 
+    /**
+     * Set the maximum number of test suites that are run concurrently.
+     *
+     * Defaults to the number of CPU cores. Suites which request to be run serially
+     * or share a resource lock (see ITestSuite) are never run at the same time.
+     * Suites are started slowest first, based on the durations recorded in the session.
+     *
+     * Must be called before start().
+     **/
+    void setMaxParallelSuites(int count);
+
+    /**
+     * @return the maximum number of test suites that are run concurrently
+     **/
+    int maxParallelSuites() const;
+
 protected:
     bool doKill() override;
 
@@ -68,6 +68,12 @@ QStringList childUrl(const QStringList& parent, const QString& child)
     return ret;
 }
 
+template<>
+QString childUrl(const QString& parent, const QString& child)
+{
+    return parent + QLatin1Char('/') + child;
+}
+
 template<>
 QUrl childUrl(const QUrl& parent, const QString& child)
 {
@@ -173,6 +179,46 @@ void TestPath::bench_hash()
     }
 }
 
+void TestPath::bench_compare()
+{
+    QFETCH(QString, otherInput);
+
+    // built independently, so the paths share no segment lists
+    const Path path(QStringLiteral("/my/very/long/path/to/a/file.cpp"));
+    const Path other(otherInput);
+    const int repeat = 1000;
+    int equal = 0;
+    QBENCHMARK {
+        for (int i = 0; i < repeat; ++i) {
+            equal += path == other;
+        }
+    }
+    QCOMPARE(equal > 0, path.pathOrUrl() == otherInput);
+}
+
+void TestPath::bench_compare_data()
+{
+    QTest::addColumn<QString>("otherInput");
+
+    QTest::newRow("equal") << QStringLiteral("/my/very/long/path/to/a/file.cpp");
+    QTest::newRow("different-file") << QStringLiteral("/my/very/long/path/to/a/file.h");
+    QTest::newRow("different-directory") << QStringLiteral("/my/very/long/path/to/b/file.cpp");
+}
+
+void TestPath::bench_independentPaths()
+{
+    // like a project importer, which creates a path for every file from its string
+    const QVector<QString> files = generateData<QString>(QStringLiteral("/tmp/foo/bar"), 0);
+    QBENCHMARK {
+        Path::List paths;
+        paths.reserve(files.size());
+        for (const QString& file : files) {
+            paths << Path(file);
+        }
+        QCOMPARE(paths.size(), files.size());
+    }
+}
+
 /// Invoke @p op on URL @p base, but preserve drive letter if @p op removes it
 template<typename Func>
 QUrl preserveWindowsDriveLetter(const QUrl& base, Func op)
@@ -637,6 +683,50 @@ void TestPath::testHasParent()
     QTEST(path.hasParent(), "hasParent");
 }
 
+void TestPath::testSegmentSharing()
+{
+    const Path a(QStringLiteral("/tmp/shared/dir/a.cpp"));
+    const Path b(QStringLiteral("/tmp/shared/dir/b.cpp"));
+    const Path c(Path(QStringLiteral("/tmp/shared")), QStringLiteral("dir/a.cpp"));
+
+    QCOMPARE(a.segments().size(), 4);
+    QCOMPARE(b.segments().size(), 4);
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(a.segments().at(i).constData(), b.segments().at(i).constData());
+    }
+    QVERIFY(a.segments().last().constData() != b.segments().last().constData());
+
+    QCOMPARE(a, c);
+    QCOMPARE(qHash(a), qHash(c));
+    QVERIFY(a != b);
+
+    Path d(a);
+    d.setLastPathSegment(QStringLiteral("b.cpp"));
+    QCOMPARE(d, b);
+    QCOMPARE(d.lastPathSegment().constData(), b.lastPathSegment().constData());
+
+    // root paths with an empty segment compare equal, however they were created
+    QCOMPARE(Path(QStringLiteral("/")), Path(QStringLiteral("/tmp")).parent());
+}
+
+void TestPath::testSegmentRelease()
+{
+    const Path kept(QStringLiteral("/tmp/kept/file.cpp"));
+
+    // enough distinct segments to purge every shard of the segment pool a few times
+    for (int i = 0; i < 100000; ++i) {
+        const Path temporary(QStringLiteral("/tmp/released/file%1.cpp").arg(i));
+        QCOMPARE(temporary.lastPathSegment(), QStringLiteral("file%1.cpp").arg(i));
+    }
+
+    // segments still in use stay pooled, released ones are pooled again on demand
+    const Path again(QStringLiteral("/tmp/kept/file.cpp"));
+    QCOMPARE(again, kept);
+    QCOMPARE(again.lastPathSegment().constData(), kept.lastPathSegment().constData());
+    QCOMPARE(Path(QStringLiteral("/tmp/released/file0.cpp")), Path(QStringLiteral("/tmp/released/file0.cpp")));
+    QVERIFY(Path(QStringLiteral("/tmp/released/file0.cpp")) != Path(QStringLiteral("/tmp/released/file1.cpp")));
+}
+
 void TestPath::QUrl_acceptance()
 {
     const QUrl baseLocal = QUrl(QStringLiteral("file:///foo.h"));
@@ -37,6 +37,9 @@ private Q_SLOTS:
     void bench_fromLocalPath();
     void bench_fromLocalPath_data();
     void bench_hash();
+    void bench_compare();
+    void bench_compare_data();
+    void bench_independentPaths();
 
     void testPath();
     void testPath_data();
@@ -52,6 +55,8 @@ private Q_SLOTS:
     void testPathCd_data();
     void testHasParent_data();
     void testHasParent();
+    void testSegmentSharing();
+    void testSegmentRelease();
 
     void QUrl_acceptance();
 };
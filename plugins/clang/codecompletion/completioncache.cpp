@@ -0,0 +1,71 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "completioncache.h"
+
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
+#include <language/duchain/topducontext.h>
+
+using namespace KDevelop;
+
+bool ClangCompletionCache::Key::operator==(const Key& other) const
+{
+    return url == other.url && position == other.position
+        && precedingTextRevision == other.precedingTextRevision
+        && modificationRevision == other.modificationRevision
+        && allModificationRevisions == other.allModificationRevisions;
+}
+
+ClangCompletionCache::Key ClangCompletionCache::key(const QUrl& url, const KTextEditor::Cursor& position,
+                                                    quint64 precedingTextRevision, const TopDUContext* top)
+{
+    ENSURE_CHAIN_READ_LOCKED
+
+    Key key;
+    key.url = url;
+    key.position = position;
+    key.precedingTextRevision = precedingTextRevision;
+    if (const auto file = top->parsingEnvironmentFile()) {
+        key.modificationRevision = file->modificationRevision();
+        key.allModificationRevisions = file->allModificationRevisions().index();
+    }
+    return key;
+}
+
+QList<CompletionTreeElementPointer> ClangCompletionCache::find(const Key& key) const
+{
+    if (m_tree.isEmpty() || !(m_key == key)) {
+        return {};
+    }
+    return m_tree;
+}
+
+void ClangCompletionCache::insert(const Key& key, const QList<CompletionTreeElementPointer>& tree)
+{
+    m_key = key;
+    m_tree = tree;
+}
+
+void ClangCompletionCache::clear()
+{
+    m_key = {};
+    m_tree.clear();
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLANGCOMPLETIONCACHE_H
+#define CLANGCOMPLETIONCACHE_H
+
+#include "clangprivateexport.h"
+
+#include <language/codecompletion/codecompletionitem.h>
+#include <language/editor/modificationrevision.h>
+
+#include <KTextEditor/Cursor>
+
+#include <QUrl>
+
+namespace KDevelop {
+class TopDUContext;
+}
+
+/**
+ * Keeps the completion results of the last run of the clang completion worker.
+ *
+ * What clang proposes only depends on the text in front of the completion start,
+ * the text typed behind it is used by the model to filter the proposals.
+ * So as long as the preceding text stays the same, the last results can be reused
+ * when the completion is restarted while typing, instead of asking clang again.
+ * A reparse of the document or of one of its includes invalidates the results.
+ */
+class KDEVCLANGPRIVATE_EXPORT ClangCompletionCache
+{
+public:
+    struct Key
+    {
+        QUrl url;
+        KTextEditor::Cursor position;
+        /// Changes whenever the text in front of @c position was modified, see ClangCodeCompletionModel
+        quint64 precedingTextRevision = 0;
+        KDevelop::ModificationRevision modificationRevision;
+        uint allModificationRevisions = 0;
+
+        bool operator==(const Key& other) const;
+    };
+
+    /**
+     * @return the key for a completion at @p position in @p top
+     *
+     * @note The DUChain must be read-locked.
+     */
+    static Key key(const QUrl& url, const KTextEditor::Cursor& position, quint64 precedingTextRevision,
+                   const KDevelop::TopDUContext* top);
+
+    /// @return the results stored for @p key, or an empty list if there are none
+    QList<KDevelop::CompletionTreeElementPointer> find(const Key& key) const;
+
+    /// Replaces the stored results with @p tree
+    void insert(const Key& key, const QList<KDevelop::CompletionTreeElementPointer>& tree);
+
+    void clear();
+
+private:
+    Key m_key;
+    QList<KDevelop::CompletionTreeElementPointer> m_tree;
+};
+
+#endif // CLANGCOMPLETIONCACHE_H
@@ -872,7 +872,18 @@ ClangCodeCompletionContext::ClangCodeCompletionContext(const DUContextPointer& c
                                                        const QString& text,
                                                        const QString& followingText
                                                       )
-    : CodeCompletionContext(context, text + followingText, CursorInRevision::castFromSimpleCursor(position), 0)
+    : ClangCodeCompletionContext(context, sessionData, url, position, text + followingText, text.size())
+{
+}
+
+ClangCodeCompletionContext::ClangCodeCompletionContext(const DUContextPointer& context,
+                                                       const ParseSessionData::Ptr& sessionData,
+                                                       const QUrl& url,
+                                                       const KTextEditor::Cursor& position,
+                                                       const QString& contents,
+                                                       int offset
+                                                      )
+    : CodeCompletionContext(context, contents, CursorInRevision::castFromSimpleCursor(position), 0)
     , m_results(nullptr, clang_disposeCodeCompleteResults)
     , m_parseSessionData(sessionData)
 {
@@ -940,11 +951,11 @@ ClangCodeCompletionContext::ClangCodeCompletionContext(const DUContextPointer& c
     }
 
     if (!m_results->NumResults) {
-        const auto trimmedText = text.trimmed();
+        const auto trimmedText = contents.leftRef(offset).trimmed();
         if (trimmedText.endsWith(QLatin1Char('.'))) {
             // TODO: This shouldn't be needed if Clang provided diagnostic.
             // But it doesn't always do it, so let's try to manually determine whether '.' is used instead of '->'
-            m_text = trimmedText.leftRef(trimmedText.size() - 1) + QLatin1String("->");
+            m_text = trimmedText.left(trimmedText.size() - 1) + QLatin1String("->");
 
             CXUnsavedFile unsaved;
             unsaved.Filename = file.constData();
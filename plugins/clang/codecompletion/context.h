@@ -52,6 +52,16 @@ public:
                                const KTextEditor::Cursor& position,
                                const QString& text,
                                const QString& followingText = {});
+    /**
+     * @p contents is the whole text of the document, and @p offset is the position of @p position in it.
+     * The text is shared with the caller, it is not copied.
+     */
+    ClangCodeCompletionContext(const KDevelop::DUContextPointer& context,
+                               const ParseSessionData::Ptr& sessionData,
+                               const QUrl& url,
+                               const KTextEditor::Cursor& position,
+                               const QString& contents,
+                               int offset);
     ~ClangCodeCompletionContext() override;
 
     QList<KDevelop::CompletionTreeItemPointer> completionItems(bool& abort, bool fullCompletion = true) override;
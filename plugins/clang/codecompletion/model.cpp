@@ -22,6 +22,7 @@
 #include "model.h"
 
 #include "util/clangdebug.h"
+#include "completioncache.h"
 #include "context.h"
 #include "includepathcompletioncontext.h"
 
@@ -33,6 +34,7 @@
 #include <language/duchain/topducontext.h>
 #include <language/duchain/duchainutils.h>
 #include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
 
 #include <KTextEditor/View>
 #include <KTextEditor/Document>
@@ -54,17 +56,32 @@ bool includePathCompletionRequired(const QString& text)
     return properties.valid;
 }
 
+int offsetForPosition(const QString& contents, const KTextEditor::Cursor& position)
+{
+    int offset = 0;
+    for (int line = 0; line < position.line(); ++line) {
+        offset = contents.indexOf(QLatin1Char('\n'), offset) + 1;
+        if (offset == 0) {
+            return contents.size();
+        }
+    }
+    return qMin(offset + position.column(), contents.size());
+}
+
 QSharedPointer<CodeCompletionContext> createCompletionContext(const DUContextPointer& context,
                                                               const ParseSessionData::Ptr& session,
                                                               const QUrl& url,
                                                               const KTextEditor::Cursor& position,
-                                                              const QString& text,
-                                                              const QString& followingText)
+                                                              const QString& contents,
+                                                              int offset)
 {
-    if (includePathCompletionRequired(text)) {
-        return QSharedPointer<IncludePathCompletionContext>::create(context, session, url, position, text);
+    // include paths are only looked for in the line of the completion start
+    const int lineStart = offset > 0 ? contents.lastIndexOf(QLatin1Char('\n'), offset - 1) + 1 : 0;
+    const QString line = contents.mid(lineStart, offset - lineStart);
+    if (includePathCompletionRequired(line)) {
+        return QSharedPointer<IncludePathCompletionContext>::create(context, session, url, position, line);
     } else {
-        return QSharedPointer<ClangCodeCompletionContext>::create(context, session, url, position, text, followingText);
+        return QSharedPointer<ClangCodeCompletionContext>::create(context, session, url, position, contents, offset);
     }
 }
 
@@ -79,13 +96,14 @@ public:
     ~ClangCodeCompletionWorker() override = default;
 
 public Q_SLOTS:
-    void completionRequested(const QUrl &url, const KTextEditor::Cursor& position, const QString& text, const QString& followingText)
+    void completionRequested(const QUrl &url, const KTextEditor::Cursor& position, const QString& contents,
+                             quint64 precedingTextRevision)
     {
         // group requests and only handle the latest one
         m_url = url;
         m_position = position;
-        m_text = text;
-        m_followingText = followingText;
+        m_contents = contents;
+        m_precedingTextRevision = precedingTextRevision;
 
         if (!m_timer) {
             // lazy-load the timer to initialize it in the background thread
@@ -114,6 +132,16 @@ private:
             return;
         }
 
+        const auto cacheKey = ClangCompletionCache::key(m_url, m_position, m_precedingTextRevision, top);
+        const auto cachedTree = m_cache.find(cacheKey);
+        if (!cachedTree.isEmpty()) {
+            clangDebug() << "Reusing completion results for" << m_url << m_position;
+            lock.unlock();
+            foundDeclarations(cachedTree, {});
+            return;
+        }
+        m_cache.clear();
+
         ParseSessionData::Ptr sessionData(ClangIntegration::DUChainUtils::findParseSessionData(top->url(), m_index->translationUnitForUrl(top->url())));
 
         if (!sessionData) {
@@ -130,8 +158,8 @@ private:
         // We hold DUChain lock, and ask for ParseSession, but TUDUChain indirectly holds ParseSession lock.
         lock.unlock();
 
-        auto completionContext = ::createCompletionContext(DUContextPointer(top), sessionData, m_url,
-                                                           m_position, m_text, m_followingText);
+        auto completionContext = ::createCompletionContext(DUContextPointer(top), sessionData, m_url, m_position,
+                                                           m_contents, offsetForPosition(m_contents, m_position));
 
         lock.lock();
         if (aborting()) {
@@ -159,6 +187,8 @@ private:
 
         tree += completionContext->ungroupedElements();
 
+        m_cache.insert(cacheKey, tree);
+
         foundDeclarations( tree, {} );
     }
 private:
@@ -166,8 +196,9 @@ private:
     QTimer* m_timer = nullptr;
     QUrl m_url;
     KTextEditor::Cursor m_position;
-    QString m_text;
-    QString m_followingText;
+    QString m_contents;
+    quint64 m_precedingTextRevision = 0;
+    ClangCompletionCache m_cache;
 };
 }
 
@@ -242,9 +273,38 @@ CodeCompletionWorker* ClangCodeCompletionModel::createCompletionWorker()
 void ClangCodeCompletionModel::completionInvokedInternal(KTextEditor::View* view, const KTextEditor::Range& range,
                                                          CodeCompletionModel::InvocationType /*invocationType*/, const QUrl &url)
 {
-    auto text = view->document()->text({0, 0, range.start().line(), range.start().column()});
-    auto followingText = view->document()->text({{range.start().line(), range.start().column()}, view->document()->documentEnd()});
-    emit requestCompletion(url, KTextEditor::Cursor(range.start()), text, followingText);
+    auto* document = view->document();
+    const KTextEditor::Cursor start = range.start();
+
+    // The text is only copied out of the document again when the text in front of the completion start
+    // may have changed since the last invocation. The edits behind it, like the typed prefix, only
+    // matter for filtering, so the worker keeps its cached results for the same preceding text revision.
+    if (m_snapshotDocument != document) {
+        if (m_snapshotDocument) {
+            disconnect(m_snapshotDocument, nullptr, this, nullptr);
+        }
+        connect(document, &KTextEditor::Document::textInserted,
+                this, [this](KTextEditor::Document*, const KTextEditor::Cursor& position, const QString&) {
+            if (position < m_snapshotStart) {
+                m_precedingTextChanged = true;
+            }
+        });
+        connect(document, &KTextEditor::Document::textRemoved,
+                this, [this](KTextEditor::Document*, const KTextEditor::Range& range, const QString&) {
+            if (range.start() < m_snapshotStart) {
+                m_precedingTextChanged = true;
+            }
+        });
+        m_snapshotDocument = document;
+        m_precedingTextChanged = true;
+    }
+    if (m_precedingTextChanged || m_snapshotStart != start) {
+        m_snapshot = document->text();
+        m_snapshotStart = start;
+        m_precedingTextChanged = false;
+        ++m_precedingTextRevision;
+    }
+    emit requestCompletion(url, start, m_snapshot, m_precedingTextRevision);
 }
 
 #include "model.moc"
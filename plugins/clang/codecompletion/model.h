@@ -26,6 +26,14 @@
 
 #include "clangprivateexport.h"
 
+#include <KTextEditor/Cursor>
+
+#include <QPointer>
+
+namespace KTextEditor {
+class Document;
+}
+
 class ClangIndex;
 
 class KDEVCLANGPRIVATE_EXPORT ClangCodeCompletionModel : public KDevelop::CodeCompletionModel
@@ -44,7 +52,12 @@ public:
     bool shouldAbortCompletion(KTextEditor::View* view, const KTextEditor::Range& range, const QString& currentCompletion) override;
 
 Q_SIGNALS:
-    void requestCompletion(const QUrl &url, const KTextEditor::Cursor& cursor, const QString& text, const QString& followingText);
+    /**
+     * @p contents is the whole text of the document. @p precedingTextRevision is increased
+     * whenever the text in front of @p cursor may have changed since the last request.
+     */
+    void requestCompletion(const QUrl &url, const KTextEditor::Cursor& cursor, const QString& contents,
+                           quint64 precedingTextRevision);
 
 protected:
     KDevelop::CodeCompletionWorker* createCompletionWorker() override;
@@ -54,6 +67,12 @@ protected:
 
 private:
     ClangIndex* m_index;
+    // the text of the document the completion was last invoked in, taken for m_snapshotStart
+    QPointer<KTextEditor::Document> m_snapshotDocument;
+    QString m_snapshot;
+    KTextEditor::Cursor m_snapshotStart = KTextEditor::Cursor::invalid();
+    bool m_precedingTextChanged = true;
+    quint64 m_precedingTextRevision = 0;
 };
 
 #endif // CLANGCODECOMPLETIONMODEL_H
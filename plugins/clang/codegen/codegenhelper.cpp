@@ -110,7 +110,7 @@ uint buildIdentifierForType(const AbstractType::Ptr& type, IndexedTypeIdentifier
     AbstractType::Ptr useTypeText = type;
     if (type->modifiers() & AbstractType::ConstModifier) {
         //Remove the 'const' modifier, as it will be added to the type-identifier below
-        useTypeText = IndexedType(type).abstractType();
+        useTypeText = AbstractType::Ptr(type->clone());
         useTypeText->setModifiers(useTypeText->modifiers() & (~AbstractType::ConstModifier));
     }
     id.setIdentifier(QualifiedIdentifier(useTypeText->toString(), true));
@@ -168,7 +168,7 @@ IndexedTypeIdentifier removeTemplateParameters(const IndexedTypeIdentifier& iden
 
 IndexedType removeConstModifier(const IndexedType& indexedType)
 {
-    AbstractType::Ptr type = indexedType.abstractType();
+    AbstractType::Ptr type(indexedType.abstractType()->clone());
     type->setModifiers(type->modifiers() & (~AbstractType::ConstModifier));
     return type->indexed();
 }
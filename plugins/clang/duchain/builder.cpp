@@ -834,6 +834,7 @@ struct Visitor
         auto type = decl->abstractType();
         if (type) {
             if (clang_CXXMethod_isConst(cursor)) {
+                type = AbstractType::Ptr(type->clone());
                 type->setModifiers(type->modifiers() | AbstractType::ConstModifier);
                 decl->setAbstractType(type);
             }
@@ -464,8 +464,29 @@ ClangFixits forwardDeclarations(const QVector<Declaration*>& matchingDeclaration
     return fixits;
 }
 
+/**
+ * Append the declarations of @p identifier in the persistent symbol table to @p matchingDeclarations
+ */
+void appendDeclarations(const IndexedQualifiedIdentifier& identifier, QVector<Declaration*>& matchingDeclarations)
+{
+    const IndexedDeclaration* declarations;
+    uint declarationCount;
+    PersistentSymbolTable::self().declarations( identifier, declarationCount, declarations );
+
+    for (uint i = 0; i < declarationCount; ++i) {
+        // Skip if the declaration is invalid or if it is an alias declaration -
+        // we want the actual declaration (and its file)
+        if (auto decl = declarations[i].declaration()) {
+            matchingDeclarations << decl;
+        }
+    }
+}
+
 /**
  * Search the persistent symbol table for matching declarations for identifiers @p identifiers
+ *
+ * If none of them is declared and the first one is unqualified, the declarations with its name
+ * in any other scope are suggested instead, e.g. std::string for string
  */
 QVector<Declaration*> findMatchingDeclarations(const QVector<QualifiedIdentifier>& identifiers)
 {
@@ -475,16 +496,27 @@ QVector<Declaration*> findMatchingDeclarations(const QVector<QualifiedIdentifier
     matchingDeclarations.reserve(identifiers.size());
     for (const auto& declaration : identifiers) {
         clangDebug() << "Considering candidate declaration" << declaration;
-        const IndexedDeclaration* declarations;
-        uint declarationCount;
-        PersistentSymbolTable::self().declarations( declaration , declarationCount, declarations );
-
-        for (uint i = 0; i < declarationCount; ++i) {
-            // Skip if the declaration is invalid or if it is an alias declaration -
-            // we want the actual declaration (and its file)
-            if (auto decl = declarations[i].declaration()) {
-                matchingDeclarations << decl;
-            }
+        appendDeclarations(IndexedQualifiedIdentifier(declaration), matchingDeclarations);
+    }
+
+    if (!matchingDeclarations.isEmpty() || identifiers.isEmpty() || identifiers.first().count() != 1) {
+        return matchingDeclarations;
+    }
+
+    const auto name = identifiers.first().last().identifier().str();
+    const auto otherScopes = PersistentSymbolTable::self().findIdentifiers(name, PersistentSymbolTable::PrefixMatch,
+                                                                            Qt::CaseSensitive);
+    int scopeCount = 0;
+    for (const auto& identifier : otherScopes) {
+        // the prefix search also finds longer names
+        const auto qid = identifier.identifier();
+        if (qid.last().identifier().str() != name) {
+            continue;
+        }
+        clangDebug() << "Considering declaration in other scope" << qid;
+        appendDeclarations(identifier, matchingDeclarations);
+        if (++scopeCount == maxSuggestions) {
+            break;
         }
     }
     return matchingDeclarations;
@@ -583,6 +583,8 @@ void TestAssistants::testUnknownDeclarationAssistant_data()
         << UnknownDeclarationActions(ForwardDecls | MissingInclude);
     QTest::newRow("forward_declared_struct") << "struct test{};" << "struct test;" << "test *f; f->"
         << UnknownDeclarationActions(MissingInclude);
+    QTest::newRow("struct_in_other_namespace") << "namespace ns { struct test{}; }" << "" << "test"
+        << UnknownDeclarationActions(MissingInclude);
     QTest::newRow("unknown_struct") << "" << "" << "test"
         << UnknownDeclarationActions();
     QTest::newRow("not a class type") << "void test();" << "" << "test"
@@ -39,6 +39,7 @@
 #include <language/codecompletion/codecompletiontesthelper.h>
 #include <language/duchain/types/functiontype.h>
 
+#include "codecompletion/completioncache.h"
 #include "codecompletion/completionhelper.h"
 #include "codecompletion/context.h"
 #include "codecompletion/includepathcompletioncontext.h"
@@ -1566,3 +1567,35 @@ void TestCodeCompletion::testIgnoreGccBuiltins()
         executeCompletionTest(file.topContext(), {});
     }
 }
+
+void TestCodeCompletion::testCompletionCache()
+{
+    TestFile file(QStringLiteral("int foo;\nint main() { f }\n"), QStringLiteral("cpp"));
+    QVERIFY(file.parseAndWait(TopDUContext::AllDeclarationsContextsUsesAndAST));
+
+    const auto url = file.url().toUrl();
+    const KTextEditor::Cursor position(1, 13);
+    const QList<CompletionTreeElementPointer> tree = {CompletionTreeElementPointer(new CompletionTreeElement)};
+
+    ClangCompletionCache cache;
+    {
+        DUChainReadLocker lock;
+        cache.insert(ClangCompletionCache::key(url, position, 1, file.topContext()), tree);
+
+        // restarted with the same preceding text, e.g. after typing behind the completion start
+        QCOMPARE(cache.find(ClangCompletionCache::key(url, position, 1, file.topContext())), tree);
+
+        // the text in front of the completion start was modified
+        QVERIFY(cache.find(ClangCompletionCache::key(url, position, 2, file.topContext())).isEmpty());
+        QVERIFY(cache.find(ClangCompletionCache::key(url, {1, 12}, 1, file.topContext())).isEmpty());
+    }
+
+    // a reparse invalidates the results, even if the text in front of the completion start is the same
+    auto view = createView(url);
+    view->document()->insertText({2, 0}, QStringLiteral("int bar;\n"));
+    QVERIFY(file.parseAndWait(TopDUContext::AllDeclarationsContextsUsesAndAST | TopDUContext::ForceUpdate));
+    {
+        DUChainReadLocker lock;
+        QVERIFY(cache.find(ClangCompletionCache::key(url, position, 1, file.topContext())).isEmpty());
+    }
+}
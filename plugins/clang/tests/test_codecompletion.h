@@ -62,6 +62,8 @@ private Q_SLOTS:
     void testCompleteFunction();
 
     void testIgnoreGccBuiltins();
+
+    void testCompletionCache();
 };
 
 #endif // TESTCODECOMPLETION_H
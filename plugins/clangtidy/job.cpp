@@ -88,6 +88,10 @@ Job::Job(const Parameters& params, QObject* parent)
     setCommand(commandLine.join(QLatin1Char(' ')), false);
     setToolDisplayName(QStringLiteral("Clang-Tidy"));
     setSources(m_parameters.filePaths);
+    // a .clang-tidy file is not part of the cache key, and fixes change the sources
+    if (!m_parameters.useConfigFile && !m_parameters.additionalParameters.contains(QLatin1String("-fix"))) {
+        setResultCacheEnabled(m_parameters.executablePath);
+    }
 
     connect(&m_parser, &ClangTidyParser::problemsDetected,
             this, &Job::problemsDetected);
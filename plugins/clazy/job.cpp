@@ -123,6 +123,10 @@ Job::Job(const JobParameters& params, QSharedPointer<const ChecksDB> db)
     setCommand(commandLineString(params), params.verboseOutput);
     setToolDisplayName(QStringLiteral("Clazy"));
     setSources(params.filePaths);
+    // fix-its change the sources while being analyzed
+    if (!params.enableAllFixits) {
+        setResultCacheEnabled(params.executablePath);
+    }
 }
 
 Job::~Job()
@@ -0,0 +1,291 @@
+/*  This file is part of KDevelop
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "ctestcasescanner.h"
+#include <debug.h>
+
+#include <QCache>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+using namespace KDevelop;
+
+namespace {
+
+/**
+ * Replaces comments, string and character literals and preprocessor lines with
+ * spaces, keeping the newlines, so that only actual code is matched later on.
+ */
+QByteArray stripNonCode(QByteArray code)
+{
+    const int size = code.size();
+    bool lineStart = true;
+    int i = 0;
+    while (i < size) {
+        const char c = code.at(i);
+        const char next = i + 1 < size ? code.at(i + 1) : '\0';
+
+        if (c == '\n') {
+            lineStart = true;
+            ++i;
+        } else if (lineStart && c == '#') {
+            while (i < size && code.at(i) != '\n') {
+                if (code.at(i) == '\\' && i + 1 < size && code.at(i + 1) == '\n') {
+                    // line continuation
+                    code[i] = ' ';
+                    i += 2;
+                } else {
+                    code[i++] = ' ';
+                }
+            }
+        } else if (c == '/' && next == '/') {
+            while (i < size && code.at(i) != '\n') {
+                code[i++] = ' ';
+            }
+        } else if (c == '/' && next == '*') {
+            while (i < size && !(code.at(i) == '*' && i + 1 < size && code.at(i + 1) == '/')) {
+                if (code.at(i) != '\n') {
+                    code[i] = ' ';
+                }
+                ++i;
+            }
+            for (int end = qMin(i + 2, size); i < end; ++i) {
+                code[i] = ' ';
+            }
+        } else if (c == '"' || c == '\'') {
+            lineStart = false;
+            ++i;
+            while (i < size && code.at(i) != c && code.at(i) != '\n') {
+                if (code.at(i) == '\\' && i + 1 < size) {
+                    code[i++] = ' ';
+                }
+                code[i++] = ' ';
+            }
+            ++i;
+        } else {
+            if (c != ' ' && c != '\t' && c != '\r') {
+                lineStart = false;
+            }
+            ++i;
+        }
+    }
+    return code;
+}
+
+bool isTestCase(const QString& name)
+{
+    return !name.endsWith(QLatin1String("_data"))
+        && name != QLatin1String("initTestCase") && name != QLatin1String("cleanupTestCase")
+        && name != QLatin1String("init") && name != QLatin1String("cleanup");
+}
+
+/**
+ * Collects the test cases declared in a class body.
+ *
+ * @p bodyStart points behind the opening brace of the class body.
+ */
+QStringList testCasesInClass(const QString& code, int bodyStart, bool isStruct)
+{
+    static const QRegularExpression accessLabel(QStringLiteral(
+        "\\b(public|protected|private|Q_SLOTS|slots|Q_SIGNALS|signals)\\b\\s*(Q_SLOTS|slots)?\\s*:(?!:)"));
+    static const QRegularExpression function(QStringLiteral("\\b(\\w+)\\s*\\([^()]*\\)[\\w\\s]*$"));
+
+    QStringList cases;
+    bool privateAccess = !isStruct;
+    bool inSlots = false;
+
+    int depth = 1;
+    int statementStart = bodyStart;
+    for (int i = bodyStart; i < code.size() && depth > 0; ++i) {
+        const QChar c = code.at(i);
+        if (depth > 1) {
+            // skip inline function bodies and nested types
+            if (c == QLatin1Char('{')) {
+                ++depth;
+            } else if (c == QLatin1Char('}') && --depth == 1) {
+                statementStart = i + 1;
+            }
+            continue;
+        }
+
+        if (c != QLatin1Char(';') && c != QLatin1Char('{') && c != QLatin1Char('}')) {
+            continue;
+        }
+
+        QStringRef statement = code.midRef(statementStart, i - statementStart);
+        // access labels are not terminated by a semicolon, so they prefix the next declaration
+        auto labels = accessLabel.globalMatch(statement.toString());
+        while (labels.hasNext()) {
+            const auto label = labels.next();
+            const QString kind = label.captured(1);
+            if (kind == QLatin1String("Q_SIGNALS") || kind == QLatin1String("signals")) {
+                inSlots = false;
+            } else if (kind == QLatin1String("Q_SLOTS") || kind == QLatin1String("slots")) {
+                inSlots = true;
+            } else {
+                privateAccess = (kind == QLatin1String("private"));
+                inSlots = !label.captured(2).isEmpty();
+            }
+            statement = code.midRef(statementStart + label.capturedEnd(), i - statementStart - label.capturedEnd());
+        }
+
+        if (privateAccess && inSlots) {
+            const auto match = function.match(statement.toString());
+            if (match.hasMatch()) {
+                const QString name = match.captured(1);
+                if (isTestCase(name) && !cases.contains(name)) {
+                    cases << name;
+                }
+            }
+        }
+
+        if (c == QLatin1Char('{')) {
+            ++depth;
+        } else if (c == QLatin1Char('}')) {
+            --depth;
+        }
+        statementStart = i + 1;
+    }
+
+    return cases;
+}
+
+/// Maximum count of files whose scan results are kept, the least recently used ones are dropped first
+constexpr int maxCachedScans = 2000;
+
+struct ScanCache
+{
+    struct Entry
+    {
+        QByteArray hash;
+        CTestCaseScanner::FileScan scan;
+    };
+
+    QMutex mutex;
+    QCache<Path, Entry> entries{maxCachedScans};
+};
+
+ScanCache& scanCache()
+{
+    static ScanCache cache;
+    return cache;
+}
+
+bool cachedScan(const Path& file, CTestCaseScanner::FileScan* scan)
+{
+    QFile f(file.toLocalFile());
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray contents = f.readAll();
+    const QByteArray hash = QCryptographicHash::hash(contents, QCryptographicHash::Md5);
+
+    auto& cache = scanCache();
+    {
+        QMutexLocker lock(&cache.mutex);
+        const auto* entry = cache.entries.object(file);
+        if (entry && entry->hash == hash) {
+            *scan = entry->scan;
+            return true;
+        }
+    }
+
+    *scan = CTestCaseScanner::scanContents(QString::fromUtf8(contents), file);
+
+    QMutexLocker lock(&cache.mutex);
+    cache.entries.insert(file, new ScanCache::Entry{hash, *scan});
+    return true;
+}
+
+}
+
+CTestCaseScanner::FileScan CTestCaseScanner::scanContents(const QString& contents, const Path& file)
+{
+    static const QRegularExpression includeDirective(QStringLiteral("^\\s*#\\s*include\\s*\"([^\"]+)\""),
+                                                     QRegularExpression::MultilineOption);
+    static const QRegularExpression testMain(QStringLiteral(
+        "\\bQTEST_(?:GUILESS_|APPLESS_)?MAIN\\s*\\(\\s*([\\w:]+)\\s*\\)"));
+    static const QRegularExpression classDefinition(QStringLiteral(
+        "\\b(class|struct)\\s+(?:\\w+\\s+)*?(\\w+)\\s*(?:final\\s*)?(?::[^;{}]*)?\\{"));
+
+    FileScan scan;
+
+    auto includes = includeDirective.globalMatch(contents);
+    const Path directory = file.parent();
+    while (includes.hasNext()) {
+        scan.localIncludes << Path(directory, includes.next().captured(1));
+    }
+
+    const QString code = QString::fromUtf8(stripNonCode(contents.toUtf8()));
+
+    const auto mainMatch = testMain.match(code);
+    if (mainMatch.hasMatch()) {
+        const QString testClass = mainMatch.captured(1);
+        scan.testClass = testClass.mid(testClass.lastIndexOf(QLatin1Char(':')) + 1);
+    }
+
+    auto classes = classDefinition.globalMatch(code);
+    while (classes.hasNext()) {
+        const auto match = classes.next();
+        const bool isStruct = match.captured(1) == QLatin1String("struct");
+        scan.testCases.insert(match.captured(2), testCasesInClass(code, match.capturedEnd(), isStruct));
+    }
+
+    return scan;
+}
+
+QStringList CTestCaseScanner::findTestCases(const QList<Path>& sourceFiles)
+{
+    QStringList cases;
+    for (const Path& file : sourceFiles) {
+        FileScan scan;
+        if (!cachedScan(file, &scan) || scan.testClass.isEmpty()) {
+            continue;
+        }
+
+        auto it = scan.testCases.constFind(scan.testClass);
+        if (it == scan.testCases.constEnd()) {
+            for (const Path& include : qAsConst(scan.localIncludes)) {
+                FileScan includeScan;
+                if (cachedScan(include, &includeScan)) {
+                    const auto includeIt = includeScan.testCases.constFind(scan.testClass);
+                    if (includeIt != includeScan.testCases.constEnd()) {
+                        scan.testCases.insert(scan.testClass, *includeIt);
+                        it = scan.testCases.constFind(scan.testClass);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (it == scan.testCases.constEnd()) {
+            qCDebug(CMAKE) << "Test class" << scan.testClass << "not found for" << file;
+            continue;
+        }
+
+        for (const QString& testCase : *it) {
+            if (!cases.contains(testCase)) {
+                cases << testCase;
+            }
+        }
+    }
+    return cases;
+}
@@ -0,0 +1,62 @@
+/*  This file is part of KDevelop
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CTESTCASESCANNER_H
+#define CTESTCASESCANNER_H
+
+#include <util/path.h>
+
+#include <QHash>
+#include <QStringList>
+
+/**
+ * Finds QtTest test cases with a purely lexical scan of the sources,
+ * without parsing them into the DUChain.
+ *
+ * The test class is taken from the QTEST_MAIN() family of macros, its
+ * definition is looked up in the file itself and in the headers it includes
+ * with quotes. All functions declared in its private slots sections, except
+ * for the init/cleanup functions and the _data functions, are test cases.
+ */
+namespace CTestCaseScanner
+{
+struct FileScan
+{
+    /// The class passed to QTEST_MAIN() and friends, if any
+    QString testClass;
+    /// Files included with quotes, resolved relative to the scanned file
+    QList<KDevelop::Path> localIncludes;
+    /// Test cases of every class defined in the file, by class name
+    QHash<QString, QStringList> testCases;
+};
+
+/**
+ * Scans the contents of a single file.
+ */
+FileScan scanContents(const QString& contents, const KDevelop::Path& file);
+
+/**
+ * @return the test cases found in @p sourceFiles and their local includes.
+ *
+ * Scan results of the most recently scanned files are cached by the hash of the file contents.
+ * This function is thread-safe.
+ */
+QStringList findTestCases(const QList<KDevelop::Path>& sourceFiles);
+}
+
+#endif // CTESTCASESCANNER_H
@@ -18,17 +18,15 @@
 */
 
 #include "ctestfindjob.h"
+#include "ctestcasescanner.h"
 #include "ctestsuite.h"
 #include <debug.h>
 
-#include <interfaces/icore.h>
-#include <interfaces/ilanguagecontroller.h>
-#include <language/duchain/duchain.h>
-#include <language/backgroundparser/backgroundparser.h>
-
 #include <kcoreaddons_version.h>
 #include <KLocalizedString>
 
+#include <QtConcurrentRun>
+
 CTestFindJob::CTestFindJob(CTestSuite* suite, QObject* parent)
 : KJob(parent)
 , m_suite(suite)
@@ -36,6 +34,8 @@ CTestFindJob::CTestFindJob(CTestSuite* suite, QObject* parent)
     qCDebug(CMAKE) << "Created a CTestFindJob";
     setObjectName(i18n("Parse test suite %1", suite->name()));
     setCapabilities(Killable);
+
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &CTestFindJob::testCasesFound);
 }
 
 void CTestFindJob::start()
@@ -51,28 +51,25 @@ void CTestFindJob::findTestCases()
         return;
     }
 
-    m_pendingFiles.clear();
+    QList<KDevelop::Path> files;
     const auto& sourceFiles = m_suite->sourceFiles();
     for (const auto& file : sourceFiles) {
         if (!file.isEmpty())
         {
-            m_pendingFiles << file;
+            files << file;
         }
     }
-    qCDebug(CMAKE) << "Source files to update:" << m_pendingFiles;
+    qCDebug(CMAKE) << "Source files to scan:" << files;
 
-    if (m_pendingFiles.isEmpty()) {
+    if (files.isEmpty()) {
         emitResult();
         return;
     }
 
-    const auto currentPendingFiles = m_pendingFiles;
-    for (const KDevelop::Path& file : currentPendingFiles) {
-        KDevelop::DUChain::self()->updateContextForUrl(KDevelop::IndexedString(file.toUrl()), KDevelop::TopDUContext::AllDeclarationsAndContexts, this);
-    }
+    m_watcher.setFuture(QtConcurrent::run(&CTestCaseScanner::findTestCases, files));
 }
 
-void CTestFindJob::updateReady(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context)
+void CTestFindJob::testCasesFound()
 {
 #if KCOREADDONS_VERSION >= QT_VERSION_CHECK(5, 75, 0)
     if (Q_UNLIKELY(isFinished())) {
@@ -90,17 +87,14 @@ void CTestFindJob::updateReady(const KDevelop::IndexedString& document, const KD
         return;
     }
 
-    qCDebug(CMAKE) << "context update ready" << m_pendingFiles << document.str();
-    m_suite->loadDeclarations(document, context);
-    m_pendingFiles.removeAll(KDevelop::Path(document.toUrl()));
-
-    if (m_pendingFiles.isEmpty()) {
-        emitResult();
-    }
+    const QStringList cases = m_watcher.result();
+    qCDebug(CMAKE) << "found test cases" << cases;
+    m_suite->setTestCases(cases);
+    emitResult();
 }
 
 bool CTestFindJob::doKill()
 {
-    KDevelop::ICore::self()->languageController()->backgroundParser()->revertAllRequests(this);
+    // the scan itself cannot be canceled, its result is ignored
     return true;
 }
@@ -23,13 +23,17 @@
 #include <KJob>
 #include <util/path.h>
 
-namespace KDevelop {
-class IndexedString;
-class ReferencedTopDUContext;
-}
+#include <QFutureWatcher>
+#include <QStringList>
 
 class CTestSuite;
 
+/**
+ * Finds the test cases of a CTest suite.
+ *
+ * This only does a lexical scan of the suite's sources, see CTestCaseScanner.
+ * The DUChain is only consulted once declarations are needed for navigation.
+ */
 class CTestFindJob : public KJob
 {
     Q_OBJECT
@@ -40,13 +44,13 @@ public:
     
 private Q_SLOTS:
     void findTestCases();
-    void updateReady(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+    void testCasesFound();
 
 protected:
     bool doKill() override;
 private:
     CTestSuite* m_suite;
-    QList<KDevelop::Path> m_pendingFiles;
+    QFutureWatcher<QStringList> m_watcher;
 };
 
 #endif // CTESTFINDJOB_H
@@ -90,6 +90,39 @@ CTestSuite::~CTestSuite()
 
 }
 
+CTestSuiteUpdateReceiver::CTestSuiteUpdateReceiver(CTestSuite* suite)
+    : m_suite(suite)
+{
+    // keep the declarations up to date when the sources are parsed again
+    connect(DUChain::self(), &DUChain::updateReady, this, &CTestSuiteUpdateReceiver::updateReady);
+}
+
+void CTestSuiteUpdateReceiver::updateReady(const IndexedString& document, const ReferencedTopDUContext& context)
+{
+    if (context && m_suite->m_files.contains(Path(document.toUrl()))) {
+        m_suite->loadDeclarations(document, context);
+    }
+}
+
+void CTestSuite::requestDeclarations() const
+{
+    // Only QtTest suites have declarations to show, and these always have cases
+    if (m_updateReceiver || m_cases.isEmpty()) {
+        return;
+    }
+    auto* suite = const_cast<CTestSuite*>(this);
+    m_updateReceiver.reset(new CTestSuiteUpdateReceiver(suite));
+
+    // the caller wants to show the declarations right away, so wait for sources that are not parsed yet
+    for (const Path& file : m_files) {
+        const IndexedString document(file.toUrl());
+        const auto context = DUChain::self()->waitForUpdate(document, TopDUContext::AllDeclarationsAndContexts);
+        if (context) {
+            suite->loadDeclarations(document, context);
+        }
+    }
+}
+
 void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop::ReferencedTopDUContext& ref)
 {
     DUChainReadLocker locker(DUChain::lock());
@@ -165,10 +198,8 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
         return;
     }
 
-    if (!m_suiteDeclaration.data())
-    {
-        m_suiteDeclaration = IndexedDeclaration(testClass);
-    }
+    // the previous declarations may be gone with the last parse of the document
+    m_suiteDeclaration = IndexedDeclaration(testClass);
 
     const auto testClassDeclarations = testClass->internalContext()->localDeclarations(topContext);
     for (Declaration* decl : testClassDeclarations) {
@@ -185,11 +216,6 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
                     continue;
                 }
 
-                if (name != QLatin1String("initTestCase") && name != QLatin1String("cleanupTestCase")
-                    && name != QLatin1String("init") && name != QLatin1String("cleanup"))
-                {
-                    m_cases << name;
-                }
                 qCDebug(CMAKE) << "Found test case function declaration" << function->identifier().toString();
 
                 auto* def = FunctionDefinition::definition(decl);
@@ -244,17 +270,24 @@ QStringList CTestSuite::arguments() const
 
 IndexedDeclaration CTestSuite::declaration() const
 {
+    requestDeclarations();
     return m_suiteDeclaration;
 }
 
 IndexedDeclaration CTestSuite::caseDeclaration(const QString& testCase) const
 {
+    requestDeclarations();
     return m_declarations.value(testCase, IndexedDeclaration(nullptr));
 }
 
 void CTestSuite::setTestCases(const QStringList& cases)
 {
     m_cases = cases;
+
+    // the declarations belong to the previous cases, look them up again on the next request
+    m_updateReceiver.reset();
+    m_declarations.clear();
+    m_suiteDeclaration = IndexedDeclaration();
 }
 
 QList<KDevelop::Path> CTestSuite::sourceFiles() const
@@ -266,3 +299,26 @@ QHash<QString, QString> CTestSuite::properties() const
 {
     return m_properties;
 }
+
+bool CTestSuite::runSerial() const
+{
+    // CMake's notion of a true constant
+    const QString value = m_properties.value(QStringLiteral("RUN_SERIAL")).toUpper();
+    bool isNumber = false;
+    const int number = value.toInt(&isNumber);
+    if (isNumber) {
+        return number != 0;
+    }
+    return value == QLatin1String("ON") || value == QLatin1String("YES")
+        || value == QLatin1String("TRUE") || value == QLatin1String("Y");
+}
+
+QStringList CTestSuite::resourceLocks() const
+{
+    const QString locks = m_properties.value(QStringLiteral("RESOURCE_LOCK"));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    return locks.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+#else
+    return locks.split(QLatin1Char(';'), QString::SkipEmptyParts);
+#endif
+}
@@ -22,13 +22,32 @@
 
 #include <interfaces/itestsuite.h>
 #include <language/duchain/indexeddeclaration.h>
+#include <language/duchain/topducontext.h>
 #include <util/path.h>
 #include <QHash>
+#include <QObject>
 #include <QPointer>
 
-namespace KDevelop {
-class ReferencedTopDUContext;
-}
+#include <memory>
+
+class CTestSuite;
+
+/**
+ * Receives the DUChain updates of the sources of a CTestSuite, and loads its declarations from them.
+ */
+class CTestSuiteUpdateReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CTestSuiteUpdateReceiver(CTestSuite* suite);
+
+public Q_SLOTS:
+    void updateReady(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+
+private:
+    CTestSuite* m_suite;
+};
 
 class CTestSuite : public KDevelop::ITestSuite
 {
@@ -45,17 +64,29 @@ public:
     QString name() const override;
     KDevelop::IProject* project() const override;
 
+    /**
+     * The declarations are looked up on first use, which waits for the sources to be parsed if they
+     * are not yet. Afterwards the declarations are kept up to date whenever the sources are parsed again.
+     *
+     * The DUChain must not be locked when calling this.
+     */
     KDevelop::IndexedDeclaration declaration() const override;
     KDevelop::IndexedDeclaration caseDeclaration(const QString& testCase) const override;
 
     virtual QHash<QString, QString> properties() const;
+    bool runSerial() const override;
+    QStringList resourceLocks() const override;
 
     QStringList arguments() const;
     void setTestCases(const QStringList& cases);
     QList<KDevelop::Path> sourceFiles() const;
-    void loadDeclarations(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
 
 private:
+    friend class CTestSuiteUpdateReceiver;
+
+    void requestDeclarations() const;
+    void loadDeclarations(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+
     KDevelop::Path m_executable;
     QString m_name;
     QStringList m_cases;
@@ -63,8 +94,11 @@ private:
     QList<KDevelop::Path> m_files;
     QPointer<KDevelop::IProject> m_project;
 
-    QHash<QString, KDevelop::IndexedDeclaration> m_declarations;
     QHash<QString, QString> m_properties;
+
+    // created once the declarations were requested
+    mutable std::unique_ptr<CTestSuiteUpdateReceiver> m_updateReceiver;
+    QHash<QString, KDevelop::IndexedDeclaration> m_declarations;
     KDevelop::IndexedDeclaration m_suiteDeclaration;
 };
 
@@ -28,12 +28,14 @@
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchain.h>
 #include <language/duchain/topducontext.h>
+#include <language/duchain/indexeddeclaration.h>
 #include <interfaces/itestcontroller.h>
 #include <interfaces/itestsuite.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iproject.h>
 #include <interfaces/ibuildsystemmanager.h>
 #include <interfaces/iprojectbuilder.h>
+#include <testing/ctestcasescanner.h>
 #include <testing/ctestsuite.h>
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
@@ -88,8 +90,6 @@ void TestCTestFindSuites::testCTestSuite()
 
     QCOMPARE(suites.size(), 5);
 
-    DUChainReadLocker locker(DUChain::lock());
-
     for (auto suite : suites) {
         QCOMPARE(suite->cases(), QStringList());
         QVERIFY(!suite->declaration().isValid());
@@ -136,17 +136,64 @@ void TestCTestFindSuites::testQtTestCases()
         QStringLiteral("skippedTestCase"),
     };
 
-    DUChainReadLocker locker(DUChain::lock());
-
     for (auto suite : suites) {
         QCOMPARE(suite->cases(), cases);
-        QVERIFY(suite->declaration().isValid());
 
+        // the declarations are looked up on first use without the DUChain lock, and must be valid right away
+        QVector<IndexedDeclaration> declarations = {suite->declaration()};
         const auto caseNames = suite->cases();
         for (const auto& caseName : caseNames) {
-            QVERIFY(suite->caseDeclaration(caseName).isValid());
+            declarations << suite->caseDeclaration(caseName);
+        }
+
+        DUChainReadLocker locker(DUChain::lock());
+        for (const auto& declaration : qAsConst(declarations)) {
+            QVERIFY(declaration.isValid());
         }
     }
 }
 
+void TestCTestFindSuites::testScanTestCases()
+{
+    const QString contents = QStringLiteral(
+        "#include \"test_foo.h\"\n"
+        "// class Commented : public QObject { private slots: void nope(); };\n"
+        "class FOO_EXPORT TestFoo : public QObject\n"
+        "{\n"
+        "    Q_OBJECT\n"
+        "public:\n"
+        "    void helper();\n"
+        "private Q_SLOTS:\n"
+        "    void initTestCase();\n"
+        "    void testOne();\n"
+        "    void testTwo_data();\n"
+        "    void testTwo() { QString s = \"void bogus();\"; Q_UNUSED(s); }\n"
+        "#ifdef SOMETHING\n"
+        "    /* void commentedOut(); */\n"
+        "#endif\n"
+        "    void testThree() const;\n"
+        "Q_SIGNALS:\n"
+        "    void changed();\n"
+        "private:\n"
+        "    int m_member;\n"
+        "    void privateHelper();\n"
+        "private slots:\n"
+        "    void testFour();\n"
+        "    void cleanup();\n"
+        "};\n"
+        "QTEST_GUILESS_MAIN(Foo::TestFoo)\n");
+
+    const auto scan = CTestCaseScanner::scanContents(contents, Path(QStringLiteral("/tmp/test_foo.cpp")));
+    QCOMPARE(scan.testClass, QStringLiteral("TestFoo"));
+    QCOMPARE(scan.localIncludes, QList<Path>{Path(QStringLiteral("/tmp/test_foo.h"))});
+    QCOMPARE(scan.testCases.keys(), QList<QString>{QStringLiteral("TestFoo")});
+    const QStringList expected = {
+        QStringLiteral("testOne"),
+        QStringLiteral("testTwo"),
+        QStringLiteral("testThree"),
+        QStringLiteral("testFour"),
+    };
+    QCOMPARE(scan.testCases.value(QStringLiteral("TestFoo")), expected);
+}
+
 QTEST_MAIN(TestCTestFindSuites)
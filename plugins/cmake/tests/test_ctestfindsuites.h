@@ -36,6 +36,7 @@ private Q_SLOTS:
 
     void testCTestSuite();
     void testQtTestCases();
+    void testScanTestCases();
 };
 
 #endif
@@ -143,6 +143,39 @@ KJob* CMakeBuilder::build(KDevelop::ProjectBaseItem *dom)
     return new ErrorJob(this, i18n("Could not find a builder for %1", p->name()));
 }
 
+KJob* CMakeBuilder::buildItems(const QList<KDevelop::ProjectBaseItem*>& items)
+{
+    KDevelop::ProjectBaseItem* dom = items.first();
+    IProjectBuilder* builder = builderForProject(dom->project());
+    if (!builder) {
+        return nullptr;
+    }
+    // files are built through their object file targets, see build()
+    for (KDevelop::ProjectBaseItem* item : items) {
+        if (item->file()) {
+            return nullptr;
+        }
+    }
+
+    KJob* build = builder->buildItems(items);
+    if (!build) {
+        return nullptr;
+    }
+    qCDebug(KDEV_CMAKEBUILDER) << "Building" << items.size() << "items at once with" << builder;
+
+    bool valid;
+    KJob* configure = checkConfigureJob(dom->project(), valid);
+    if( configure )
+    {
+        auto* builderJob = new KDevelop::BuilderJob;
+        builderJob->addCustomJob( KDevelop::BuilderJob::Configure, configure, dom );
+        builderJob->addCustomJob( KDevelop::BuilderJob::Build, build, dom );
+        builderJob->updateJobName();
+        build = builderJob;
+    }
+    return build;
+}
+
 KJob* CMakeBuilder::clean(KDevelop::ProjectBaseItem *dom)
 {
     IProjectBuilder* builder = builderForProject(dom->project());
@@ -47,6 +47,7 @@ public:
     ~CMakeBuilder() override;
 
     KJob* build(KDevelop::ProjectBaseItem *dom) override;
+    KJob* buildItems(const QList<KDevelop::ProjectBaseItem*>& items) override;
     KJob* install(KDevelop::ProjectBaseItem *dom, const QUrl &installPrefix) override;
     KJob* clean(KDevelop::ProjectBaseItem *dom) override;
     KJob* configure(KDevelop::IProject*) override;
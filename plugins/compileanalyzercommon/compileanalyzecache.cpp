@@ -0,0 +1,292 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "compileanalyzecache.h"
+
+// lib
+#include <debug.h>
+// KF
+#include <KShell>
+// Qt
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+// Std
+#include <algorithm>
+
+namespace KDevelop
+{
+
+namespace {
+
+/// Limits the number of entries per tool, the oldest ones are removed first
+constexpr int maxCacheEntries = 20000;
+
+struct CompileCommand
+{
+    QString directory;
+    QStringList arguments;
+};
+
+QHash<QString, CompileCommand> compileCommands(const QString& buildDir)
+{
+    QHash<QString, CompileCommand> result;
+
+    QFile commandsFile(buildDir + QLatin1String("/compile_commands.json"));
+    if (!commandsFile.open(QFile::ReadOnly | QFile::Text)) {
+        return result;
+    }
+
+    const auto commandsDocument = QJsonDocument::fromJson(commandsFile.readAll());
+    const auto fileDataArray = commandsDocument.array();
+    for (const auto& value : fileDataArray) {
+        const auto entry = value.toObject();
+        const auto file = entry.value(QLatin1String("file")).toString();
+        if (file.isEmpty()) {
+            continue;
+        }
+
+        CompileCommand command;
+        command.directory = entry.value(QLatin1String("directory")).toString();
+        const auto arguments = entry.value(QLatin1String("arguments"));
+        if (arguments.isArray()) {
+            const auto argumentArray = arguments.toArray();
+            for (const auto& argument : argumentArray) {
+                command.arguments << argument.toString();
+            }
+        } else {
+            command.arguments = KShell::splitArgs(entry.value(QLatin1String("command")).toString());
+        }
+        if (!command.arguments.isEmpty()) {
+            result.insert(file, command);
+        }
+    }
+
+    return result;
+}
+
+QByteArray toolIdentity(const QString& toolExecutable, const QString& toolCommand)
+{
+    QProcess process;
+    process.setProgram(toolExecutable);
+    process.setArguments({QStringLiteral("--version")});
+    process.start();
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit) {
+        return {};
+    }
+
+    const QByteArray version = process.readAllStandardOutput();
+    if (version.isEmpty()) {
+        return {};
+    }
+    return version + '\0' + toolCommand.toUtf8();
+}
+
+QString entryKey(const QByteArray& toolIdentity, const CompileCommand& command)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(toolIdentity);
+    hash.addData(command.directory.toUtf8());
+    for (const auto& argument : command.arguments) {
+        hash.addData(argument.toUtf8() + '\0');
+    }
+
+    auto arguments = CompileAnalyzeCache::preprocessorArguments(command.arguments);
+    QProcess process;
+    process.setWorkingDirectory(command.directory);
+    process.setProgram(arguments.takeFirst());
+    process.setArguments(arguments);
+    process.setStandardErrorFile(QProcess::nullDevice());
+    process.start();
+    if (!process.waitForStarted(-1)) {
+        return {};
+    }
+    // the preprocessed output can get large, so hash it as it comes in
+    while (process.waitForReadyRead(-1)) {
+        hash.addData(process.readAllStandardOutput());
+    }
+    process.waitForFinished(-1);
+    hash.addData(process.readAllStandardOutput());
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        return {};
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+void pruneCache(const QString& cacheDir)
+{
+    QDir dir(cacheDir);
+    const auto entries = dir.entryInfoList({QStringLiteral("*.stdout")}, QDir::Files, QDir::Time);
+    for (int i = maxCacheEntries; i < entries.size(); ++i) {
+        const QString path = entries[i].absoluteFilePath();
+        QFile::remove(path);
+        QFile::remove(path.left(path.size() - 6) + QLatin1String("stderr"));
+    }
+}
+
+QStringList readLines(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return {};
+    }
+    QStringList lines;
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        if (line.endsWith(QLatin1Char('\n'))) {
+            line.chop(1);
+        }
+        lines << line;
+    }
+    return lines;
+}
+
+}
+
+CompileAnalyzeCache CompileAnalyzeCache::create(const QString& toolName, const QString& toolExecutable,
+                                                const QString& toolCommand, const QString& buildDir,
+                                                const QStringList& sources, int parallelJobCount)
+{
+    CompileAnalyzeCache cache;
+
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                           + QLatin1String("/compileanalyzer/") + toolName.toLower();
+    if (!QDir().mkpath(cacheDir)) {
+        qCWarning(KDEV_COMPILEANALYZER) << "Could not create the result cache directory" << cacheDir;
+        return cache;
+    }
+
+    const QByteArray identity = toolIdentity(toolExecutable, toolCommand);
+    if (identity.isEmpty()) {
+        qCDebug(KDEV_COMPILEANALYZER) << "Could not get the version of" << toolExecutable << ", not caching results";
+        return cache;
+    }
+
+    const auto commands = compileCommands(buildDir);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, parallelJobCount));
+    QVector<QPair<QString, QFuture<QString>>> keys;
+    keys.reserve(sources.size());
+    for (const auto& source : sources) {
+        const auto it = commands.constFind(source);
+        if (it == commands.constEnd()) {
+            continue;
+        }
+        const CompileCommand command = *it;
+        keys.append({source, QtConcurrent::run(&pool, [identity, command]() {
+            return entryKey(identity, command);
+        })});
+    }
+
+    for (auto& key : keys) {
+        const QString entryKey = key.second.result();
+        if (!entryKey.isEmpty()) {
+            cache.m_entryPaths.insert(key.first, cacheDir + QLatin1Char('/') + entryKey);
+        }
+    }
+
+    qCDebug(KDEV_COMPILEANALYZER) << "computed" << cache.m_entryPaths.size() << "result cache keys for" << sources.size() << "sources";
+
+    pruneCache(cacheDir);
+
+    return cache;
+}
+
+QString CompileAnalyzeCache::entryPath(const QString& source) const
+{
+    return m_entryPaths.value(source);
+}
+
+bool CompileAnalyzeCache::readEntry(const QString& source, QStringList* stdoutLines, QStringList* stderrLines) const
+{
+    const QString path = entryPath(source);
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    // the makefile moves the stderr file into place first
+    const QString stdoutFile = path + QLatin1String(".stdout");
+    if (!QFile::exists(stdoutFile)) {
+        return false;
+    }
+
+    *stdoutLines = readLines(stdoutFile);
+    *stderrLines = readLines(path + QLatin1String(".stderr"));
+    return true;
+}
+
+QStringList CompileAnalyzeCache::preprocessorArguments(const QStringList& compileArguments)
+{
+    // options which make the compiler write files, followed by a separate argument or joined with it like "-MFfoo.d"
+    static const QStringList outputOptions = {
+        QStringLiteral("-o"), QStringLiteral("-MF"),
+    };
+    // options which only name the targets in the dependency file, which is not written anymore.
+    // They are only matched with a separate argument, joined they could be mistaken for e.g. "-MTd" of clang-cl
+    static const QStringList dependencyTargetOptions = {
+        QStringLiteral("-MT"), QStringLiteral("-MQ"),
+    };
+    // other options which start like a joined "-o"
+    static const QStringList otherOptionPrefixes = {
+        QStringLiteral("-obj"), QStringLiteral("-open"), QStringLiteral("-order_file"),
+    };
+
+    QStringList result;
+    result.reserve(compileArguments.size() + 1);
+    for (int i = 0; i < compileArguments.size(); ++i) {
+        const QString& argument = compileArguments[i];
+        if (argument == QLatin1String("-c") || argument == QLatin1String("-M") || argument == QLatin1String("-MM")
+            || argument == QLatin1String("-MD") || argument == QLatin1String("-MMD") || argument == QLatin1String("-MP")) {
+            continue;
+        }
+        if (outputOptions.contains(argument) || dependencyTargetOptions.contains(argument)) {
+            ++i;
+            continue;
+        }
+        if (argument.startsWith(QLatin1String("-MF"))) {
+            continue;
+        }
+        if (argument.startsWith(QLatin1String("-o"))) {
+            const bool isOtherOption = std::any_of(otherOptionPrefixes.begin(), otherOptionPrefixes.end(),
+                                                   [&argument](const QString& prefix) {
+                return argument.startsWith(prefix);
+            });
+            if (!isOtherOption) {
+                continue;
+            }
+        }
+        result << argument;
+    }
+    result << QStringLiteral("-E");
+
+    return result;
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef COMPILEANALYZER_COMPILEANALYZECACHE_H
+#define COMPILEANALYZER_COMPILEANALYZECACHE_H
+
+// lib
+#include <compileanalyzercommonexport.h>
+// Qt
+#include <QHash>
+#include <QStringList>
+
+namespace KDevelop
+{
+
+/**
+ * On-disk cache of the output of an analyzer run, per translation unit.
+ *
+ * An entry is keyed by the version output and command line of the analyzer,
+ * the compile command of the translation unit and its preprocessed contents.
+ * So any change to the source file, to one of the headers it includes,
+ * to the compile flags or to the enabled checks results in a new key.
+ *
+ * Entries are written by the makefile of the analyze job, only for runs
+ * which exited successfully, and are replayed instead of running the analyzer again.
+ */
+class KDEVCOMPILEANALYZERCOMMON_EXPORT CompileAnalyzeCache
+{
+public:
+    CompileAnalyzeCache() = default;
+
+    /**
+     * Computes the cache keys of @p sources, using the compilation database in @p buildDir.
+     *
+     * This runs the preprocessor for every source, @p parallelJobCount at a time,
+     * and blocks until all are done. It does not touch any other state,
+     * so it is meant to be called in a worker thread.
+     *
+     * Sources which could not be preprocessed get no key and are not cached.
+     */
+    static CompileAnalyzeCache create(const QString& toolName, const QString& toolExecutable,
+                                      const QString& toolCommand, const QString& buildDir,
+                                      const QStringList& sources, int parallelJobCount);
+
+    /**
+     * @return the path prefix of the cache files for @p source,
+     *         or an empty string if the source cannot be cached
+     */
+    QString entryPath(const QString& source) const;
+
+    /**
+     * Reads the cached output of @p source.
+     *
+     * @return false if there is no entry for the source yet
+     */
+    bool readEntry(const QString& source, QStringList* stdoutLines, QStringList* stderrLines) const;
+
+    /**
+     * @return the arguments to run @p compileArguments as preprocessor only,
+     *         writing to standard output
+     */
+    static QStringList preprocessorArguments(const QStringList& compileArguments);
+
+private:
+    QHash<QString, QString> m_entryPaths;
+};
+
+}
+
+#endif
@@ -22,11 +22,14 @@
 #include "compileanalyzejob.h"
 
 // lib
+#include "compileanalyzecache.h"
 #include <debug.h>
 // KF
 #include <KLocalizedString>
 // Qt
+#include <QFutureWatcher>
 #include <QTemporaryFile>
+#include <QtConcurrentRun>
 
 namespace KDevelop
 {
@@ -83,7 +86,12 @@ void CompileAnalyzeJob::setSources(const QStringList& sources)
     m_sources = sources;
 }
 
-void CompileAnalyzeJob::generateMakefile()
+void CompileAnalyzeJob::setResultCacheEnabled(const QString& toolExecutable)
+{
+    m_cacheToolExecutable = toolExecutable;
+}
+
+void CompileAnalyzeJob::generateMakefile(const QStringList& cachedSources)
 {
     QTemporaryFile makefile(m_buildDir + QLatin1String("/kdevcompileanalyzerXXXXXX.makefile"));
     makefile.setAutoRemove(false);
@@ -92,11 +100,29 @@ void CompileAnalyzeJob::generateMakefile()
 
     QTextStream scriptStream(&makefile);
 
-    scriptStream << QStringLiteral("SOURCES =");
+    // sources with a cache key get their output written to the cache, the others are just analyzed
+    QStringList uncachedSources;
+    QStringList cachingSources;
     for (const auto& source : qAsConst(m_sources)) {
-        scriptStream << QLatin1String(" \\\n\t") << spaceEscapedString(source);
+        if (cachedSources.contains(source)) {
+            continue;
+        }
+        if (m_cache && !m_cache->entryPath(source).isEmpty()) {
+            cachingSources << source;
+        } else {
+            uncachedSources << source;
+        }
     }
-    scriptStream << QLatin1Char('\n');
+
+    const auto writeSourcesVariable = [&scriptStream](const QString& name, const QStringList& sources) {
+        scriptStream << name << QLatin1String(" =");
+        for (const auto& source : sources) {
+            scriptStream << QLatin1String(" \\\n\t") << spaceEscapedString(source);
+        }
+        scriptStream << QLatin1Char('\n');
+    };
+    writeSourcesVariable(QStringLiteral("SOURCES"), uncachedSources);
+    writeSourcesVariable(QStringLiteral("CACHING_SOURCES"), cachingSources);
 
     scriptStream << QLatin1String("COMMAND = ");
     if (!m_verboseOutput) {
@@ -104,22 +130,74 @@ void CompileAnalyzeJob::generateMakefile()
     }
     scriptStream << m_command << QLatin1Char('\n');
 
-    scriptStream << QLatin1String(".PHONY: all $(SOURCES)\n");
-    scriptStream << QLatin1String("all: $(SOURCES)\n");
-    scriptStream << QLatin1String("$(SOURCES):\n");
+    scriptStream << QLatin1String(".PHONY: all $(SOURCES) $(CACHING_SOURCES)\n");
+    scriptStream << QLatin1String("all: $(SOURCES) $(CACHING_SOURCES)\n");
+
+    if (!uncachedSources.isEmpty()) {
+        scriptStream << QLatin1String("$(SOURCES):\n");
+        scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check started  for $@'\n");
+        // Wrap filename ($@) with quotas to handle "whitespaced" file names.
+        scriptStream << QLatin1String("\t$(COMMAND) \"$@\"\n");
+        scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check finished for $@'\n");
+    }
 
-    scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check started  for $@'\n");
-    // Wrap filename ($@) with quotas to handle "whitespaced" file names.
-    scriptStream << QLatin1String("\t$(COMMAND) \"$@\"\n");
-    scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check finished for $@'\n");
+    if (!cachingSources.isEmpty()) {
+        for (const auto& source : qAsConst(cachingSources)) {
+            scriptStream << spaceEscapedString(source) << QLatin1String(": CACHE_FILE = ")
+                         << m_cache->entryPath(source) << QLatin1Char('\n');
+        }
+        scriptStream << QLatin1String("$(CACHING_SOURCES):\n");
+        scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check started  for $@'\n");
+        // Only output of successful runs is moved into the cache, stderr first as the stdout file marks a complete entry.
+        scriptStream << QLatin1String("\t$(COMMAND) \"$@\" > \"$(CACHE_FILE).stdout.tmp\" 2> \"$(CACHE_FILE).stderr.tmp\"; status=$$?; "
+                                      "cat \"$(CACHE_FILE).stdout.tmp\"; cat \"$(CACHE_FILE).stderr.tmp\" >&2; "
+                                      "if [ $$status -eq 0 ]; then "
+                                      "mv -f \"$(CACHE_FILE).stderr.tmp\" \"$(CACHE_FILE).stderr\" && mv -f \"$(CACHE_FILE).stdout.tmp\" \"$(CACHE_FILE).stdout\"; "
+                                      "else rm -f \"$(CACHE_FILE).stdout.tmp\" \"$(CACHE_FILE).stderr.tmp\"; fi; "
+                                      "exit $$status\n");
+        scriptStream << QLatin1String("\t@echo '") << m_toolDisplayName << QLatin1String(" check finished for $@'\n");
+    }
 
     makefile.close();
 }
 
 void CompileAnalyzeJob::start()
 {
+    if (m_cacheToolExecutable.isEmpty()) {
+        startAnalysis();
+        return;
+    }
+
+    // computing the cache keys means preprocessing all sources, so do it off the main thread
+    emit infoMessage(this, i18n("Looking up cached results"));
+    m_cacheWatcher = new QFutureWatcher<CompileAnalyzeCache>(this);
+    connect(m_cacheWatcher, &QFutureWatcherBase::finished, this, [this]() {
+        m_cache.reset(new CompileAnalyzeCache(m_cacheWatcher->result()));
+        m_cacheWatcher->deleteLater();
+        m_cacheWatcher = nullptr;
+        startAnalysis();
+    });
+    m_cacheWatcher->setFuture(QtConcurrent::run([toolName = m_toolDisplayName, toolExecutable = m_cacheToolExecutable,
+                                                 command = m_command, buildDir = m_buildDir, sources = m_sources,
+                                                 parallelJobCount = m_parallelJobCount]() {
+        return CompileAnalyzeCache::create(toolName, toolExecutable, command, buildDir, sources, parallelJobCount);
+    }));
+}
+
+void CompileAnalyzeJob::startAnalysis()
+{
+    QStringList cachedSources;
+    if (m_cache) {
+        for (const auto& source : qAsConst(m_sources)) {
+            if (QFile::exists(m_cache->entryPath(source) + QLatin1String(".stdout"))) {
+                cachedSources << source;
+            }
+        }
+        qCDebug(KDEV_COMPILEANALYZER) << "using cached results for" << cachedSources.size() << "of" << m_sources.size() << "sources";
+    }
+
     // TODO: check success of creation
-    generateMakefile();
+    generateMakefile(cachedSources);
 
     *this << QStringList{
         QStringLiteral("make"),
@@ -138,6 +216,47 @@ void CompileAnalyzeJob::start()
     setPercent(0);
 
     KDevelop::OutputExecuteJob::start();
+
+    if (status() == JobRunning) {
+        replayCachedResults(cachedSources);
+    }
+}
+
+void CompileAnalyzeJob::replayCachedResults(const QStringList& cachedSources)
+{
+    for (const auto& source : cachedSources) {
+        QStringList stdoutLines;
+        QStringList stderrLines;
+        if (!m_cache->readEntry(source, &stdoutLines, &stderrLines)) {
+            continue;
+        }
+
+        // feed the output through the same slots as the live output, so subclasses parse it as usual
+        if (!stdoutLines.isEmpty()) {
+            postProcessStdout(stdoutLines);
+        }
+        if (!stderrLines.isEmpty()) {
+            postProcessStderr(stderrLines);
+        }
+
+        ++m_finishedCount;
+    }
+
+    if (!cachedSources.isEmpty()) {
+        setPercent(static_cast<double>(m_finishedCount)/m_totalCount * 100);
+    }
+}
+
+bool CompileAnalyzeJob::doKill()
+{
+    if (m_cacheWatcher) {
+        // the key computation cannot be interrupted, just drop its result
+        delete m_cacheWatcher;
+        m_cacheWatcher = nullptr;
+        return true;
+    }
+
+    return KDevelop::OutputExecuteJob::doKill();
 }
 
 void CompileAnalyzeJob::parseProgress(const QStringList& lines)
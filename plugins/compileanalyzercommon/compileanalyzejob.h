@@ -29,10 +29,16 @@
 #include <outputview/outputexecutejob.h>
 // Qt
 #include <QRegularExpression>
+// Std
+#include <memory>
+
+template<typename T> class QFutureWatcher;
 
 namespace KDevelop
 {
 
+class CompileAnalyzeCache;
+
 class KDEVCOMPILEANALYZERCOMMON_EXPORT CompileAnalyzeJob : public KDevelop::OutputExecuteJob
 {
     Q_OBJECT
@@ -53,6 +59,16 @@ public:
     void setCommand(const QString& commandcommand, bool verboseOutput = true);
     void setToolDisplayName(const QString& toolDisplayName);
     void setSources(const QStringList& sources);
+    /**
+     * Enables caching the tool output per translation unit across runs.
+     *
+     * Only to be used if the output of the tool depends on nothing but its command line,
+     * the compile commands and the preprocessed sources, so e.g. not with config files
+     * or with fix-its being applied.
+     *
+     * @param toolExecutable the executable of the tool, used to query its version
+     */
+    void setResultCacheEnabled(const QString& toolExecutable);
 
 Q_SIGNALS:
     void problemsDetected(const QVector<KDevelop::IProblem::Ptr>& problems);
@@ -63,9 +79,12 @@ protected Q_SLOTS:
 
 protected:
     void parseProgress(const QStringList& lines);
+    bool doKill() override;
 
 private:
-    void generateMakefile();
+    void startAnalysis();
+    void generateMakefile(const QStringList& cachedSources);
+    void replayCachedResults(const QStringList& cachedSources);
 
 private:
     QString m_makeFilePath;
@@ -76,6 +95,10 @@ private:
     int m_parallelJobCount = 1;
     bool m_verboseOutput = true;
 
+    QString m_cacheToolExecutable;
+    std::unique_ptr<CompileAnalyzeCache> m_cache;
+    QFutureWatcher<CompileAnalyzeCache>* m_cacheWatcher = nullptr;
+
     int m_finishedCount = 0;
     int m_totalCount = 0;
 
@@ -21,6 +21,7 @@
 
 #include "test_compileanalyzejob.h"
 
+#include "compileanalyzecache.h"
 #include "compileanalyzejob.h"
 
 #include <tests/autotestshell.h>
@@ -141,6 +142,39 @@ void TestCompileAnalyzeJob::testJob()
     QCOMPARE(jobTester.started().at(3), QStringLiteral("source4.cpp"));
 }
 
+void TestCompileAnalyzeJob::testPreprocessorArguments_data()
+{
+    QTest::addColumn<QStringList>("compileArguments");
+    QTest::addColumn<QStringList>("expected");
+
+    const QStringList compiler = {QStringLiteral("/usr/bin/c++"), QStringLiteral("-DFOO")};
+    const QStringList source = {QStringLiteral("/src/foo.cpp")};
+    const QStringList preprocess = {QStringLiteral("/src/foo.cpp"), QStringLiteral("-E")};
+
+    QTest::newRow("separate")
+        << compiler + QStringList{QStringLiteral("-MD"), QStringLiteral("-MT"), QStringLiteral("foo.o"),
+                                  QStringLiteral("-MF"), QStringLiteral("foo.o.d"), QStringLiteral("-o"),
+                                  QStringLiteral("foo.o"), QStringLiteral("-c")} + source
+        << compiler + preprocess;
+    QTest::newRow("joined")
+        << compiler + QStringList{QStringLiteral("-MMD"), QStringLiteral("-MFfoo.o.d"), QStringLiteral("-ofoo.o"),
+                                  QStringLiteral("-c")} + source
+        << compiler + preprocess;
+    QTest::newRow("similar-options")
+        << compiler + QStringList{QStringLiteral("-objcmt-migrate-literals"), QStringLiteral("-openmp"),
+                                  QStringLiteral("-MTd"), QStringLiteral("-c")} + source
+        << compiler + QStringList{QStringLiteral("-objcmt-migrate-literals"), QStringLiteral("-openmp"),
+                                  QStringLiteral("-MTd")} + preprocess;
+}
+
+void TestCompileAnalyzeJob::testPreprocessorArguments()
+{
+    QFETCH(QStringList, compileArguments);
+    QFETCH(QStringList, expected);
+
+    QCOMPARE(CompileAnalyzeCache::preprocessorArguments(compileArguments), expected);
+}
+
 QTEST_GUILESS_MAIN(TestCompileAnalyzeJob)
 
 #include "test_compileanalyzejob.moc"
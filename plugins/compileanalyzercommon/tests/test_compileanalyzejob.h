@@ -34,6 +34,8 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testJob();
+    void testPreprocessorArguments_data();
+    void testPreprocessorArguments();
 };
 
 #endif
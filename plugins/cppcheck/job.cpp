@@ -39,6 +39,7 @@
 #include <KLocalizedString>
 // Qt
 #include <QApplication>
+#include <QDir>
 #include <QElapsedTimer>
 #include <QRegularExpression>
 
@@ -62,6 +63,11 @@ Job::Job(const Parameters& params, QObject* parent)
     setProperties(KDevelop::OutputExecuteJob::JobProperty::DisplayStderr);
     setProperties(KDevelop::OutputExecuteJob::JobProperty::PostProcessOutput);
 
+    const QString cacheDirectory = params.cacheDirectory();
+    if (!cacheDirectory.isEmpty() && !QDir().mkpath(cacheDirectory)) {
+        qCWarning(KDEV_CPPCHECK) << "could not create the cache directory" << cacheDirectory;
+    }
+
     *this << params.commandLine();
     qCDebug(KDEV_CPPCHECK) << "checking path" << params.checkPath;
 }
@@ -31,8 +31,10 @@
 #include <KShell>
 #include <KLocalizedString>
 
+#include <QCryptographicHash>
 #include <QFile>
 #include <QRegularExpression>
+#include <QStandardPaths>
 
 namespace cppcheck
 {
@@ -75,6 +77,7 @@ Parameters::Parameters(KDevelop::IProject* project)
     executablePath = KDevelop::Path(GlobalSettings::executablePath()).toLocalFile();
     hideOutputView = GlobalSettings::hideOutputView();
     showXmlOutput  = GlobalSettings::showXmlOutput();
+    cacheResults   = GlobalSettings::cacheResults();
 
     if (!project) {
         checkStyle           = defaults::checkStyle;
@@ -119,6 +122,12 @@ Parameters::Parameters(KDevelop::IProject* project)
         m_projectBuildPath   = buildSystemManager->buildDirectory(m_project->projectItem());
     }
     m_includeDirectories = includesForProject(project);
+
+    // one directory per project, the entries are stored by file name
+    const QByteArray projectHash = QCryptographicHash::hash(m_projectRootPath.toLocalFile().toUtf8(),
+                                                            QCryptographicHash::Sha1).toHex();
+    m_cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                     + QLatin1String("/cppcheck/") + QString::fromLatin1(projectHash);
 }
 
 QStringList Parameters::commandLine() const
@@ -176,6 +185,10 @@ QStringList Parameters::commandLine(QString& infoMessage) const
         result << QStringLiteral("--force");
     }
 
+    if (cacheResults && !m_cacheDirectory.isEmpty()) {
+        result << QLatin1String("--cppcheck-build-dir=") + m_cacheDirectory;
+    }
+
     if (checkConfig) {
         result << QStringLiteral("--check-config");
     }
@@ -258,6 +271,11 @@ KDevelop::Path Parameters::projectRootPath() const
     return m_projectRootPath;
 }
 
+QString Parameters::cacheDirectory() const
+{
+    return cacheResults ? m_cacheDirectory : QString();
+}
+
 QString Parameters::applyPlaceholders(const QString& text) const
 {
     QString result(text);
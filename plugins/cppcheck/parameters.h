@@ -37,6 +37,7 @@ namespace defaults
 // global settings
 static const bool hideOutputView = true;
 static const bool showXmlOutput = false;
+static const bool cacheResults = true;
 
 // project settings
 static const bool checkStyle = false;
@@ -66,6 +67,7 @@ public:
     QString executablePath;
     bool hideOutputView;
     bool showXmlOutput;
+    bool cacheResults;
 
     // project settings
     bool checkStyle;
@@ -89,6 +91,14 @@ public:
 
     KDevelop::Path projectRootPath() const;
 
+    /**
+     * @return the directory passed as --cppcheck-build-dir, where cppcheck keeps
+     *         the results per file, together with a checksum of the file contents and
+     *         the settings. Unchanged files are not checked again but their results replayed.
+     *         Empty if results are not cached.
+     */
+    QString cacheDirectory() const;
+
 private:
     QString applyPlaceholders(const QString& text) const;
 
@@ -96,6 +106,7 @@ private:
 
     KDevelop::Path m_projectRootPath;
     KDevelop::Path m_projectBuildPath;
+    QString m_cacheDirectory;
 
     QList<KDevelop::Path> m_includeDirectories;
 };
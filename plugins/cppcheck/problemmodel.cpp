@@ -80,18 +80,19 @@ void ProblemModel::fixProblemFinalLocation(KDevelop::IProblem::Ptr problem)
     }
 }
 
-bool ProblemModel::problemExists(KDevelop::IProblem::Ptr newProblem)
+QString ProblemModel::problemKey(const KDevelop::IProblem::Ptr& problem)
 {
-    for (auto problem : qAsConst(m_problems)) {
-        if (newProblem->source() == problem->source() &&
-            newProblem->severity() == problem->severity() &&
-            newProblem->finalLocation() == problem->finalLocation() &&
-            newProblem->description() == problem->description() &&
-            newProblem->explanation() == problem->explanation())
-            return true;
-    }
+    const auto location = problem->finalLocation();
+    return QStringLiteral("%1:%2:%3:%4:%5:%6:%7\n%8\n%9").arg(
+        QString::number(problem->source()), QString::number(problem->severity()), location.document.str(),
+        QString::number(location.start().line()), QString::number(location.start().column()),
+        QString::number(location.end().line()), QString::number(location.end().column()),
+        problem->description(), problem->explanation());
+}
 
-    return false;
+bool ProblemModel::problemExists(KDevelop::IProblem::Ptr newProblem)
+{
+    return m_problemKeys.contains(problemKey(newProblem));
 }
 
 void ProblemModel::setMessage(const QString& message)
@@ -115,6 +116,7 @@ void ProblemModel::addProblems(const QVector<KDevelop::IProblem::Ptr>& problems)
         }
 
         m_problems.append(problem);
+        m_problemKeys.insert(problemKey(problem));
         addProblem(problem);
 
         // This performs adjusting of columns width in the ProblemsView
@@ -145,6 +147,7 @@ void ProblemModel::reset(KDevelop::IProject* project, const QString& path)
 
     clearProblems();
     m_problems.clear();
+    m_problemKeys.clear();
 
     QString tooltip;
     if (m_project) {
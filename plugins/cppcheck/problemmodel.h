@@ -22,6 +22,8 @@
 
 #include <shell/problemmodel.h>
 
+#include <QSet>
+
 namespace KDevelop
 {
     class IProject;
@@ -55,6 +57,7 @@ public:
 private:
     void fixProblemFinalLocation(KDevelop::IProblem::Ptr problem);
     bool problemExists(KDevelop::IProblem::Ptr newProblem);
+    static QString problemKey(const KDevelop::IProblem::Ptr& problem);
     void setMessage(const QString& message);
 
     using KDevelop::ProblemModel::setProblems;
@@ -67,6 +70,8 @@ private:
     KDevelop::DocumentRange m_pathLocation;
 
     QVector<KDevelop::IProblem::Ptr> m_problems;
+    /// keys of m_problems, problems are streamed in during long runs and checked against all others
+    QSet<QString> m_problemKeys;
 };
 
 }
@@ -23,20 +23,91 @@
 
 #include "gcclikecompiler.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
+#include <QReadWriteLock>
+#include <QSaveFile>
 #include <QRegularExpression>
 #include <QMap>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <interfaces/iruntime.h>
 #include <interfaces/iruntimecontroller.h>
 
 #include <debug.h>
 
+#include <algorithm>
+
 using namespace KDevelop;
 
+/**
+ * Runtimes are only destroyed once they are no longer current, so probes may only use theirs
+ * until then. Releasing it waits for the calls in progress, not for the probes to finish.
+ */
+class GccLikeCompiler::ProbeRuntime
+{
+public:
+    explicit ProbeRuntime(const IRuntime* runtime)
+        : m_runtime(runtime)
+    {
+    }
+
+    /**
+     * Calls @p function with the runtime, unless it was released
+     *
+     * @return false if the runtime was released, the probe should be cancelled then
+     */
+    template<typename Function>
+    bool use(Function function) const
+    {
+        QReadLocker lock(&m_lock);
+        if (!m_runtime) {
+            return false;
+        }
+        function(m_runtime);
+        return true;
+    }
+
+    bool isReleased() const
+    {
+        QReadLocker lock(&m_lock);
+        return !m_runtime;
+    }
+
+    void release()
+    {
+        QWriteLocker lock(&m_lock);
+        m_runtime = nullptr;
+    }
+
+private:
+    mutable QReadWriteLock m_lock;
+    const IRuntime* m_runtime;
+};
+
 namespace
 {
 
+using DefinesIncludes = GccLikeCompiler::DefinesIncludes;
+using ProbeRuntime = GccLikeCompiler::ProbeRuntime;
+
+/// Timeout for a single compiler run, in milliseconds
+constexpr int probeTimeout = 2000;
+
+/// Interval in which running compilers check whether their probe was cancelled, in milliseconds
+constexpr int cancelCheckInterval = 100;
+
+/// Maximum count of probe results kept on disk
+constexpr int maxCacheFiles = 100;
+
 QString languageOption(Utils::LanguageType type)
 {
     switch (type) {
@@ -82,101 +153,127 @@ QString languageStandard(const QString& arguments, Utils::LanguageType type)
     }
 }
 
+/**
+ * @return a key identifying the compiler binary, or an empty string if it cannot be found
+ *
+ * Results are only stored on disk for compilers with a key, so that an updated compiler is probed again.
+ */
+QByteArray compilerIdentity(const IRuntime* runtime, const QString& compiler)
+{
+    // runtimes search their paths in the host already
+    const QString executable = runtime->findExecutable(compiler);
+    if (executable.isEmpty()) {
+        return {};
+    }
+
+    const QFileInfo info(executable);
+    if (!info.exists()) {
+        return {};
+    }
+
+    return runtime->name().toUtf8() + '\0' + executable.toUtf8() + '\0'
+        + QByteArray::number(info.size()) + '\0' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+QString cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/compilerprobes");
 }
 
-Defines GccLikeCompiler::defines(Utils::LanguageType type, const QString& arguments) const
+QString cacheFilePath(const QByteArray& identity, const QStringList& arguments)
 {
-    auto& data = m_definesIncludes[type][arguments];
-    if (!data.definedMacros.isEmpty() ) {
-        return data.definedMacros;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(identity);
+    for (const auto& argument : arguments) {
+        hash.addData(argument.toUtf8() + '\0');
     }
 
-    // #define a 1
-    // #define a
-    QRegExp defineExpression(QStringLiteral("#define\\s+(\\S+)(?:\\s+(.*)\\s*)?"));
+    return cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QLatin1String(".json");
+}
 
-    const auto rt = ICore::self()->runtimeController()->currentRuntime();
-    QProcess proc;
-    proc.setProcessChannelMode( QProcess::MergedChannels );
-
-    // TODO: what about -mXXX or -target= flags, some of these change search paths/defines
-    const QStringList compilerArguments{
-        languageOption(type),
-        languageStandard(arguments, type),
-        QStringLiteral("-dM"),
-        QStringLiteral("-E"),
-        QStringLiteral("-"),
-    };
-    proc.setStandardInputFile(QProcess::nullDevice());
-    proc.setProgram(path());
-    proc.setArguments(compilerArguments);
-    rt->startProcess(&proc);
+/// Removes the least recently written cache files beyond maxCacheFiles, e.g. for compilers that were updated since
+void pruneCacheFiles()
+{
+    QDir directory(cacheDirectory());
+    const auto files = directory.entryInfoList({QStringLiteral("*.json")}, QDir::Files, QDir::Time);
+    for (int i = maxCacheFiles; i < files.size(); ++i) {
+        directory.remove(files[i].fileName());
+    }
+}
+
+bool startProbe(const ProbeRuntime& runtime, QProcess* proc, const QString& compiler, const QStringList& arguments)
+{
+    proc->setProcessChannelMode( QProcess::MergedChannels );
+    proc->setStandardInputFile(QProcess::nullDevice());
+    proc->setProgram(compiler);
+    proc->setArguments(arguments);
+    return runtime.use([proc](const IRuntime* runtime) {
+        runtime->startProcess(proc);
+    });
+}
+
+/**
+ * Waits for @p proc to finish, but kills it after probeTimeout or when the probe was cancelled
+ *
+ * @return whether the compiler finished in time
+ */
+bool waitForProbe(const ProbeRuntime& runtime, QProcess& proc)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (!proc.waitForStarted(probeTimeout)) {
+        return false;
+    }
+    while (!proc.waitForFinished(cancelCheckInterval)) {
+        if (proc.state() == QProcess::NotRunning) {
+            return false;
+        }
+        if (runtime.isReleased() || timer.hasExpired(probeTimeout)) {
+            proc.kill();
+            proc.waitForFinished(cancelCheckInterval);
+            return false;
+        }
+    }
+    return true;
+}
 
-    if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
-        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard macro definitions from "<< path() << compilerArguments;
+Defines readDefines(const ProbeRuntime& runtime, QProcess& proc, const QString& compiler)
+{
+    if (!waitForProbe(runtime, proc)) {
+        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard macro definitions from "<< compiler << proc.arguments();
         return {};
     }
 
     if (proc.exitCode() != 0) {
-        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching defines for the compiler:" << path() << compilerArguments << proc.readAll();
+        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching defines for the compiler:" << compiler << proc.arguments() << proc.readAll();
         return {};
     }
 
+    // #define a 1
+    // #define a
+    QRegExp defineExpression(QStringLiteral("#define\\s+(\\S+)(?:\\s+(.*)\\s*)?"));
+
+    Defines definedMacros;
     while ( proc.canReadLine() ) {
         auto line = proc.readLine();
 
         if ( defineExpression.indexIn(QString::fromUtf8(line)) != -1 ) {
-            data.definedMacros[defineExpression.cap( 1 )] = defineExpression.cap( 2 ).trimmed();
+            definedMacros[defineExpression.cap( 1 )] = defineExpression.cap( 2 ).trimmed();
         }
     }
 
-    return data.definedMacros;
+    return definedMacros;
 }
 
-Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& arguments) const
+Path::List readIncludes(const ProbeRuntime& runtime, QProcess& proc, const QString& compiler)
 {
-    auto& data = m_definesIncludes[type][arguments];
-    if ( !data.includePaths.isEmpty() ) {
-        return data.includePaths;
-    }
-
-    const auto rt = ICore::self()->runtimeController()->currentRuntime();
-    QProcess proc;
-    proc.setProcessChannelMode( QProcess::MergedChannels );
-
-    // The following command will spit out a bunch of information we don't care
-    // about before spitting out the include paths.  The parts we care about
-    // look like this:
-    // #include "..." search starts here:
-    // #include <...> search starts here:
-    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2
-    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2/i486-linux-gnu
-    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2/backward
-    //  /usr/local/include
-    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/include
-    //  /usr/include
-    // End of search list.
-
-    const QStringList compilerArguments{
-        languageOption(type),
-        languageStandard(arguments, type),
-        QStringLiteral("-E"),
-        QStringLiteral("-v"),
-        QStringLiteral("-"),
-    };
-
-    proc.setStandardInputFile(QProcess::nullDevice());
-    proc.setProgram(path());
-    proc.setArguments(compilerArguments);
-    rt->startProcess(&proc);
-
-    if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
-        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard include paths from " << path();
+    if (!waitForProbe(runtime, proc)) {
+        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard include paths from " << compiler;
         return {};
     }
 
     if (proc.exitCode() != 0) {
-        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching includes for the compiler:" << path() << proc.readAll();
+        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching includes for the compiler:" << compiler << proc.readAll();
         return {};
     }
 
@@ -189,6 +286,7 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
     };
     Status mode = Initial;
 
+    Path::List includePaths;
     const auto output = QString::fromLocal8Bit( proc.readAllStandardOutput() );
     const auto lines = output.splitRef(QLatin1Char('\n'));
     for (const auto& line : lines) {
@@ -210,10 +308,17 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
                     mode = Finished;
                 } else {
                     // This is an include path, add it to the list.
-                    auto hostPath = rt->pathInHost(Path(QFileInfo(line.trimmed().toString()).canonicalFilePath()));
+                    const Path runtimePath(QFileInfo(line.trimmed().toString()).canonicalFilePath());
+                    Path hostPath;
+                    const bool used = runtime.use([&hostPath, &runtimePath](const IRuntime* runtime) {
+                        hostPath = runtime->pathInHost(runtimePath);
+                    });
+                    if (!used) {
+                        return {};
+                    }
                     // but skip folders with compiler builtins, we cannot parse these with clang
                     if (!QFile::exists(hostPath.toLocalFile() + QLatin1String("/cpuid.h"))) {
-                        data.includePaths << Path(QFileInfo(hostPath.toLocalFile()).canonicalFilePath());
+                        includePaths << Path(QFileInfo(hostPath.toLocalFile()).canonicalFilePath());
                     }
                 }
                 break;
@@ -225,16 +330,220 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
         }
     }
 
-    return data.includePaths;
+    return includePaths;
+}
+
+DefinesIncludes probe(const ProbeRuntime& runtime, const QString& compiler, const QStringList& arguments)
+{
+    using namespace CompilerProbe;
+
+    QByteArray identity;
+    const bool used = runtime.use([&identity, &compiler](const IRuntime* runtime) {
+        identity = compilerIdentity(runtime, compiler);
+    });
+    if (!used) {
+        return {};
+    }
+    const QString cacheFile = identity.isEmpty() ? QString() : cacheFilePath(identity, arguments);
+
+    DefinesIncludes result;
+    if (!cacheFile.isEmpty() && readCacheFile(cacheFile, &result)) {
+        return result;
+    }
+    result = {};
+
+    // run both at the same time, they don't depend on each other
+    QProcess definesProc;
+    if (!startProbe(runtime, &definesProc, compiler, arguments + QStringList{QStringLiteral("-dM"), QStringLiteral("-E"), QStringLiteral("-")})) {
+        return {};
+    }
+
+    // The following command will spit out a bunch of information we don't care
+    // about before spitting out the include paths.  The parts we care about
+    // look like this:
+    // #include "..." search starts here:
+    // #include <...> search starts here:
+    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2
+    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2/i486-linux-gnu
+    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/../../../../include/c++/4.1.2/backward
+    //  /usr/local/include
+    //  /usr/lib/gcc/i486-linux-gnu/4.1.2/include
+    //  /usr/include
+    // End of search list.
+    QProcess includesProc;
+    if (!startProbe(runtime, &includesProc, compiler, arguments + QStringList{QStringLiteral("-E"), QStringLiteral("-v"), QStringLiteral("-")})) {
+        definesProc.kill();
+        definesProc.waitForFinished(cancelCheckInterval);
+        return {};
+    }
+
+    result.definedMacros = readDefines(runtime, definesProc, compiler);
+    result.includePaths = readIncludes(runtime, includesProc, compiler);
+
+    // don't store failed probes, so they are tried again in the next session
+    if (!cacheFile.isEmpty() && !result.definedMacros.isEmpty() && !result.includePaths.isEmpty()) {
+        if (writeCacheFile(cacheFile, result)) {
+            pruneCacheFiles();
+        }
+    }
+
+    return result;
+}
+
+QThreadPool* probePool()
+{
+    static QThreadPool* pool = [] {
+        auto* pool = new QThreadPool;
+        // enough for probing a C and a C++ configuration at the same time
+        pool->setMaxThreadCount(2);
+        return pool;
+    }();
+    return pool;
+}
+
+}
+
+QStringList CompilerProbe::probeArguments(Utils::LanguageType type, const QString& arguments)
+{
+    // flags followed by a separate value
+    static const QStringList separateValueFlags = {
+        QStringLiteral("-target"), QStringLiteral("--sysroot"), QStringLiteral("-isysroot"),
+    };
+    // flags with a joined value, and flags without any value
+    static const QStringList joinedValueFlags = {
+        QStringLiteral("--target="), QStringLiteral("--sysroot="), QStringLiteral("--gcc-toolchain="),
+        QStringLiteral("-march="), QStringLiteral("-stdlib="),
+    };
+    static const QStringList plainFlags = {
+        QStringLiteral("-m32"), QStringLiteral("-m64"), QStringLiteral("-mx32"),
+        QStringLiteral("-nostdinc"), QStringLiteral("-nostdinc++"), QStringLiteral("-ffreestanding"),
+    };
+
+    QStringList result{languageOption(type), languageStandard(arguments, type)};
+
+    const auto tokens = arguments.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    for (int i = 0; i < tokens.size(); ++i) {
+        const QString& token = tokens[i];
+        if (separateValueFlags.contains(token) && i + 1 < tokens.size()) {
+            result << token << tokens[++i];
+        } else if (plainFlags.contains(token)
+                   || std::any_of(joinedValueFlags.begin(), joinedValueFlags.end(),
+                                  [&token](const QString& flag) { return token.startsWith(flag); })) {
+            result << token;
+        }
+    }
+
+    return result;
+}
+
+bool CompilerProbe::readCacheFile(const QString& fileName, DefinesIncludes* result)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const auto object = QJsonDocument::fromJson(file.readAll()).object();
+    const auto defines = object.value(QLatin1String("defines")).toObject();
+    for (auto it = defines.begin(); it != defines.end(); ++it) {
+        result->definedMacros.insert(it.key(), it.value().toString());
+    }
+    const auto includes = object.value(QLatin1String("includes")).toArray();
+    for (const auto& include : includes) {
+        result->includePaths << Path(include.toString());
+    }
+
+    return !result->definedMacros.isEmpty();
+}
+
+bool CompilerProbe::writeCacheFile(const QString& fileName, const DefinesIncludes& result)
+{
+    QJsonObject defines;
+    for (auto it = result.definedMacros.begin(); it != result.definedMacros.end(); ++it) {
+        defines.insert(it.key(), it.value());
+    }
+    QJsonArray includes;
+    for (const auto& include : result.includePaths) {
+        includes.append(include.pathOrUrl());
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    // other sessions may read the file at the same time, so only replace it once it is complete
+    QSaveFile file(fileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(QJsonObject{
+            {QStringLiteral("defines"), defines},
+            {QStringLiteral("includes"), includes},
+        }).toJson(QJsonDocument::Compact));
+        if (file.commit()) {
+            return true;
+        }
+    }
+
+    qCWarning(DEFINESANDINCLUDES) << "Could not write compiler probe cache" << fileName;
+    return false;
+}
+
+GccLikeCompiler::DefinesIncludes GccLikeCompiler::definesAndIncludes(Utils::LanguageType type, const QString& arguments) const
+{
+    const QStringList compilerArguments = CompilerProbe::probeArguments(type, arguments);
+    const QString key = compilerArguments.join(QLatin1Char(' '));
+
+    QFuture<DefinesIncludes> future;
+    {
+        QMutexLocker lock(&m_mutex);
+
+        auto it = m_definesIncludes.constFind(key);
+        if (it == m_definesIncludes.constEnd()) {
+            // concurrent requests for the same arguments wait for the same probe
+            const auto runtime = m_runtime;
+            const QString compiler = path();
+            it = m_definesIncludes.insert(key, QtConcurrent::run(probePool(), [runtime, compiler, compilerArguments]() {
+                return probe(*runtime, compiler, compilerArguments);
+            }));
+        }
+        future = *it;
+    }
+
+    const DefinesIncludes result = future.result();
+    if (result.definedMacros.isEmpty()) {
+        // the probe failed or timed out, try again on the next request
+        QMutexLocker lock(&m_mutex);
+        const auto it = m_definesIncludes.find(key);
+        if (it != m_definesIncludes.end() && *it == future) {
+            m_definesIncludes.erase(it);
+        }
+    }
+    return result;
+}
+
+Defines GccLikeCompiler::defines(Utils::LanguageType type, const QString& arguments) const
+{
+    return definesAndIncludes(type, arguments).definedMacros;
+}
+
+Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& arguments) const
+{
+    return definesAndIncludes(type, arguments).includePaths;
 }
 
 void GccLikeCompiler::invalidateCache()
 {
-    m_definesIncludes.clear();
+    std::shared_ptr<ProbeRuntime> previousRuntime;
+    {
+        QMutexLocker lock(&m_mutex);
+        previousRuntime = m_runtime;
+        m_runtime = std::make_shared<ProbeRuntime>(ICore::self()->runtimeController()->currentRuntime());
+        // the probes still running for the previous runtime are cancelled and their results dropped
+        m_definesIncludes.clear();
+    }
+
+    previousRuntime->release();
 }
 
 GccLikeCompiler::GccLikeCompiler(const QString& name, const QString& path, bool editable, const QString& factoryName):
     ICompiler(name, path, factoryName, editable)
+    , m_runtime(std::make_shared<ProbeRuntime>(ICore::self()->runtimeController()->currentRuntime()))
 {
     connect(ICore::self()->runtimeController(), &IRuntimeController::currentRuntimeChanged, this, &GccLikeCompiler::invalidateCache);
 }
@@ -26,6 +26,12 @@
 
 #include "icompiler.h"
 
+#include <QFuture>
+#include <QMutex>
+#include <QStringList>
+
+#include <memory>
+
 class GccLikeCompiler : public QObject, public ICompiler
 {
     Q_OBJECT
@@ -36,17 +42,55 @@ public:
 
     KDevelop::Path::List includes(Utils::LanguageType type, const QString& arguments) const override;
 
-private:
-    void invalidateCache();
-
     struct DefinesIncludes {
         KDevelop::Defines definedMacros;
         KDevelop::Path::List includePaths;
     };
 
-    /// List of defines/includes per arguments
-    mutable QHash<Utils::LanguageType, QHash<QString, DefinesIncludes>> m_definesIncludes;
+    /// The runtime the probes are started for, released once it is no longer current
+    class ProbeRuntime;
+
+private:
+    void invalidateCache();
+
+    /**
+     * @return the defines and include paths for the given language and arguments,
+     *         probing the compiler if they are neither in memory nor on disk
+     */
+    DefinesIncludes definesAndIncludes(Utils::LanguageType type, const QString& arguments) const;
+
+    mutable QMutex m_mutex;
+    /// Defines and includes per normalized probe arguments, see CompilerProbe::probeArguments()
+    mutable QHash<QString, QFuture<DefinesIncludes>> m_definesIncludes;
+    /// Shared with the probes, released once it is no longer current, see invalidateCache()
+    std::shared_ptr<ProbeRuntime> m_runtime;
 };
 
+/**
+ * Helpers for probing GCC-like compilers and persisting the results across sessions
+ */
+namespace CompilerProbe
+{
+/**
+ * @return the arguments passed to the compiler when probing for its defines and include paths
+ *
+ * Only the flags changing these are taken from @p arguments, so that files with
+ * otherwise different flags share the probe. The result is also the cache key.
+ */
+QStringList probeArguments(Utils::LanguageType type, const QString& arguments);
+
+/**
+ * Read a probe result stored by writeCacheFile()
+ *
+ * @return whether the file contained a usable result
+ */
+bool readCacheFile(const QString& fileName, GccLikeCompiler::DefinesIncludes* result);
+
+/**
+ * Store a probe result, replacing @p fileName atomically
+ */
+bool writeCacheFile(const QString& fileName, const GccLikeCompiler::DefinesIncludes& result);
+}
+
 #endif // GCCLIKECOMPILER_H
 
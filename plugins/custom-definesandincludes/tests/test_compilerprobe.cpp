@@ -0,0 +1,94 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "test_compilerprobe.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "compilerprovider/gcclikecompiler.h"
+
+using namespace KDevelop;
+
+QTEST_GUILESS_MAIN(TestCompilerProbe)
+
+void TestCompilerProbe::testProbeArguments_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<QString>("arguments");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("default-standard") << static_cast<int>(Utils::Cpp) << QString()
+        << QStringList{"-xc++", "-std=c++11"};
+    QTest::newRow("last-standard-wins") << static_cast<int>(Utils::Cpp) << "-std=c++11 -O2 -std=c++17"
+        << QStringList{"-xc++", "-std=c++17"};
+    QTest::newRow("unrelated-flags") << static_cast<int>(Utils::C) << "-Wall -O2 -DFOO=1 -I/usr/include/foo -fPIC"
+        << QStringList{"-xc", "-std=c99"};
+    QTest::newRow("target-flags") << static_cast<int>(Utils::Cpp)
+        << "-Wall -target arm-linux-gnueabi --sysroot=/opt/sysroot -m32 -march=armv7 -stdlib=libc++"
+        << QStringList{"-xc++", "-std=c++11", "-target", "arm-linux-gnueabi", "--sysroot=/opt/sysroot", "-m32",
+                       "-march=armv7", "-stdlib=libc++"};
+    QTest::newRow("separate-value") << static_cast<int>(Utils::C) << "-isysroot /opt/sdk -nostdinc"
+        << QStringList{"-xc", "-std=c99", "-isysroot", "/opt/sdk", "-nostdinc"};
+    QTest::newRow("missing-value") << static_cast<int>(Utils::C) << "-O2 -target"
+        << QStringList{"-xc", "-std=c99"};
+}
+
+void TestCompilerProbe::testProbeArguments()
+{
+    QFETCH(int, type);
+    QFETCH(QString, arguments);
+    QFETCH(QStringList, expected);
+
+    QCOMPARE(CompilerProbe::probeArguments(static_cast<Utils::LanguageType>(type), arguments), expected);
+}
+
+void TestCompilerProbe::testCacheFileRoundTrip()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("probes/result.json");
+
+    GccLikeCompiler::DefinesIncludes stored;
+    stored.definedMacros = {{"__GNUC__", "9"}, {"__x86_64__", "1"}, {"EMPTY", ""}};
+    stored.includePaths = {Path("/usr/include"), Path("/usr/include/c++/9")};
+    QVERIFY(CompilerProbe::writeCacheFile(fileName, stored));
+
+    GccLikeCompiler::DefinesIncludes loaded;
+    QVERIFY(CompilerProbe::readCacheFile(fileName, &loaded));
+    QCOMPARE(loaded.definedMacros, stored.definedMacros);
+    QCOMPARE(loaded.includePaths, stored.includePaths);
+}
+
+void TestCompilerProbe::testInvalidCacheFile()
+{
+    QTemporaryDir dir;
+    GccLikeCompiler::DefinesIncludes result;
+    QVERIFY(!CompilerProbe::readCacheFile(dir.filePath("missing.json"), &result));
+
+    // a truncated file must not be taken for a result without any defines
+    const QString fileName = dir.filePath("truncated.json");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{\"defines\":{\"__GN");
+    file.close();
+    QVERIFY(!CompilerProbe::readCacheFile(fileName, &result));
+}
@@ -21,28 +21,27 @@
 #include "milexer.h"
 #include "tokens.h"
 #include <cctype>
-#include <iostream>
+#include <utility>
 
 using namespace KDevMI::MI;
 
-bool MILexer::s_initialized = false;
 scan_fun_ptr MILexer::s_scan_table[];
 
 
 MILexer::MILexer()
 {
-    if (!s_initialized)
-        setupScanTable();
+    // lexers are created on the worker threads parsing debugger output too,
+    // so rely on the thread-safe initialization of function-local statics
+    static const bool initialized = setupScanTable();
+    Q_UNUSED(initialized);
 }
 
 MILexer::~MILexer()
 {
 }
 
-void MILexer::setupScanTable()
+bool MILexer::setupScanTable()
 {
-    s_initialized = true;
-
     for (int i=0; i<128; ++i) {
         switch (i) {
         case '\n':
@@ -66,6 +65,7 @@ void MILexer::setupScanTable()
     }
 
     s_scan_table[128] = &MILexer::scanUnicodeChar;
+    return true;
 }
 
 /*
@@ -82,8 +82,8 @@ TokenStream *MILexer::tokenize(const FileSymbol *fileSymbol)
     m_tokensCount = 0;
     m_tokens.resize(64);
 
-    m_contents = fileSymbol->contents;
-    m_length = m_contents.length();
+    m_contents = fileSymbol->contents.constData();
+    m_length = fileSymbol->contents.length();
     m_ptr = 0;
 
     m_lines.resize(8);
@@ -110,12 +110,14 @@ TokenStream *MILexer::tokenize(const FileSymbol *fileSymbol)
     }
 
     auto *tokenStream = new TokenStream;
-    tokenStream->m_contents = m_contents;
+    tokenStream->m_contents = fileSymbol->contents;
 
-    tokenStream->m_lines = m_lines;
+    // hand the vectors over instead of sharing them, sharing would make
+    // the next tokenize() call detach and copy them again
+    tokenStream->m_lines = std::move(m_lines);
     tokenStream->m_line = m_line;
 
-    tokenStream->m_tokens = m_tokens;
+    tokenStream->m_tokens = std::move(m_tokens);
     tokenStream->m_tokensCount = m_tokensCount;
 
     tokenStream->m_firstToken = tokenStream->m_tokens.data();
@@ -123,6 +125,9 @@ TokenStream *MILexer::tokenize(const FileSymbol *fileSymbol)
 
     tokenStream->m_cursor = m_cursor;
 
+    m_contents = nullptr;
+    m_length = 0;
+
     return tokenStream;
 }
 
@@ -131,10 +136,10 @@ int MILexer::nextToken(int &pos, int &len)
     while (m_ptr < m_length) {
         const int start = m_ptr;
 
-        const char ch = m_contents[m_ptr];
-        Q_ASSERT(ch >= 0);
+        const auto ch = static_cast<uchar>(m_contents[m_ptr]);
         int kind = 0;
-        (this->*s_scan_table[static_cast<uchar>(ch)])(&kind);
+        // everything outside of ASCII is handled by the last entry
+        (this->*s_scan_table[qMin<uint>(ch, 128)])(&kind);
 
         switch (kind) {
             case Token_whitespaces:
@@ -188,15 +193,16 @@ void MILexer::scanUnicodeChar(int *kind)
 void MILexer::scanStringLiteral(int *kind)
 {
     ++m_ptr;
-    while (char c = m_contents[m_ptr]) {
-        switch (c) {
+    while (m_ptr < m_length) {
+        switch (m_contents[m_ptr]) {
+        case '\0':
         case '\n':
             // ### error
             *kind = Token_string_literal;
             return;
         case '\\':
             {
-                char next = m_contents.at(m_ptr+1);
+                const char next = m_ptr + 1 < m_length ? m_contents[m_ptr + 1] : '\0';
                 if (next == '"' || next == '\\')
                     m_ptr += 2;
                 else
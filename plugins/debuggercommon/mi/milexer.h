@@ -60,6 +60,13 @@ struct TokenStream
     inline QByteArray currentTokenText() const
     { return tokenText(-1); }
 
+    /// Points into the lexed contents, no copy is made
+    inline const char* currentTokenData() const
+    { return m_contents.constData() + m_currentToken->position; }
+
+    inline int currentTokenLength() const
+    { return m_currentToken->length; }
+
     QByteArray tokenText(int index = 0) const;
 
     inline int lineOffset(int line) const
@@ -119,13 +126,13 @@ private:
     void scanNumberLiteral(int *kind);
     void scanIdentifier(int *kind);
 
-    void setupScanTable();
+    static bool setupScanTable();
 
 private:
-    static bool s_initialized;
     static scan_fun_ptr s_scan_table[128 + 1];
 
-    QByteArray m_contents;
+    // View of the contents being lexed; owned by the FileSymbol
+    const char* m_contents = nullptr;
     int m_ptr = 0;
     // Cached 'm_contents.length()'
     int m_length = 0;
@@ -322,51 +322,41 @@ bool MIParser::parseCSV(TupleValue& value,
 
 QString MIParser::parseStringLiteral()
 {
-    QByteArray messageByteArray = m_lex->currentTokenText();
-    QString message = QString::fromUtf8(messageByteArray.constData());
+    // Unescape on the raw bytes and decode once: escape sequences are plain
+    // ASCII and can never be part of a multi-byte UTF-8 sequence.
+    const char* data = m_lex->currentTokenData();
+    const int length = m_lex->currentTokenLength();
 
-    int length = message.length();
-    QString message2;
-    message2.reserve(length);
+    QByteArray message;
+    message.reserve(length);
     // The [1,length-1] range removes quotes without extra
     // call to 'mid'
-    for(int i = 1, e = length-1; i != e; ++i)
+    for (int i = 1, e = length - 1; i < e; ++i)
     {
-        int translated = -1;
-        if (message[i] == QLatin1Char('\\')) {
-            if (i+1 < length)
-            {
-                // TODO: implement all the other escapes, maybe
-                if (message[i+1] == QLatin1Char('n')) {
-                    translated = '\n';
-                }
-                else if (message[i+1] == QLatin1Char('\\')) {
-                    translated = '\\';
-                }
-                else if (message[i+1] == QLatin1Char('"')) {
-                    translated = '"';
-                }
-                else if (message[i+1] == QLatin1Char('t')) {
-                    translated = '\t';
-                }
-                else if (message[i+1] == QLatin1Char('r')) {
-                    translated = '\r';
-                }
+        char translated = 0;
+        if (data[i] == '\\' && i + 1 < length) {
+            // TODO: implement all the other escapes, maybe
+            switch (data[i + 1]) {
+            case 'n': translated = '\n'; break;
+            case '\\': translated = '\\'; break;
+            case '"': translated = '"'; break;
+            case 't': translated = '\t'; break;
+            case 'r': translated = '\r'; break;
+            default: break;
             }
         }
 
-        if (translated != -1)
+        if (translated)
         {
-            message2.append(translated);
+            message.append(translated);
             ++i;
         }
         else
         {
-            message2.append(message[i]);
+            message.append(data[i]);
         }
     }
 
     m_lex->nextToken();
-    return message2;
+    return QString::fromUtf8(message);
 }
-
@@ -34,14 +34,18 @@
 #include <KMessageBox>
 
 #include <QApplication>
+#include <QFutureWatcher>
 #include <QString>
 #include <QStringList>
+#include <QtConcurrentRun>
 
 #include <csignal>
+#include <cstring>
 
 #include <memory>
 #include <stdexcept>
 #include <sstream>
+#include <vector>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
@@ -52,6 +56,34 @@
 using namespace KDevMI;
 using namespace KDevMI::MI;
 
+namespace {
+/// Output chunks at least this big are parsed on a worker thread
+const int ASYNC_PARSE_THRESHOLD = 64 * 1024;
+}
+
+struct MIDebugger::OutputChunk
+{
+    /// The raw output, holds the data @c lines point into
+    QByteArray data;
+    QVector<QByteArray> lines;
+    /// Filled by the worker thread, when @c parsedAsync is set
+    std::vector<std::unique_ptr<MI::Record>> records;
+    QFutureWatcher<void> watcher;
+    bool parsedAsync = false;
+    int nextLine = 0;
+
+    void parse()
+    {
+        MIParser parser;
+        records.reserve(lines.size());
+        for (const auto& line : qAsConst(lines)) {
+            FileSymbol file;
+            file.contents = line;
+            records.push_back(parser.parse(&file));
+        }
+    }
+};
+
 MIDebugger::MIDebugger(QObject* parent)
     : QObject(parent)
 {
@@ -69,6 +101,11 @@ MIDebugger::MIDebugger(QObject* parent)
 
 MIDebugger::~MIDebugger()
 {
+    // the workers write into the chunks
+    for (const auto& chunk : m_pendingOutput) {
+        chunk->watcher.waitForFinished();
+    }
+
     // prevent Qt warning: QProcess: Destroyed while process is still running.
     if (m_process && m_process->state() == QProcess::Running) {
         disconnect(m_process, &QProcess::errorOccurred,
@@ -144,18 +181,79 @@ void MIDebugger::readyReadStandardOutput()
     m_process->setReadChannel(QProcess::StandardOutput);
 
     m_buffer += m_process->readAll();
-    for (;;)
-    {
-        /* In MI mode, all messages are exactly one line.
-           See if we have any complete lines in the buffer. */
-        int i = m_buffer.indexOf('\n');
-        if (i == -1)
-            break;
-        QByteArray reply(m_buffer.left(i));
-        m_buffer.remove(0, i+1);
 
-        processLine(reply);
+    /* In MI mode, all messages are exactly one line.
+       Split off everything up to the last complete line, so that only
+       the incomplete tail is copied, not the whole buffer for each line. */
+    const int end = m_buffer.lastIndexOf('\n') + 1;
+    if (end == 0)
+        return;
+
+    auto chunk = std::make_unique<OutputChunk>();
+    chunk->data = m_buffer;
+    m_buffer = m_buffer.mid(end);
+    chunk->data.truncate(end);
+
+    const char* const data = chunk->data.constData();
+    for (int pos = 0; pos < end;) {
+        const auto* newline = static_cast<const char*>(std::memchr(data + pos, '\n', end - pos));
+        const int length = newline - (data + pos);
+        chunk->lines.append(QByteArray::fromRawData(data + pos, length));
+        pos += length + 1;
+    }
+
+    if (!m_pendingOutput.empty() || end >= ASYNC_PARSE_THRESHOLD) {
+        // big chunks, e.g. from printing large data structures, would block the UI
+        // for a noticeable time; parse them on a worker and only handle the records here
+        OutputChunk* const rawChunk = chunk.get();
+        chunk->parsedAsync = true;
+        connect(&chunk->watcher, &QFutureWatcherBase::finished,
+                this, &MIDebugger::processPendingOutput);
+        chunk->watcher.setFuture(QtConcurrent::run([rawChunk]() { rawChunk->parse(); }));
+    }
+
+    m_pendingOutput.push_back(std::move(chunk));
+    processPendingOutput();
+}
+
+void MIDebugger::processPendingOutput()
+{
+    // handlers of the records may spin an event loop and thereby re-enter here,
+    // so always continue with the front chunk instead of holding on to a line
+    while (!m_pendingOutput.empty()) {
+        OutputChunk* const chunk = m_pendingOutput.front().get();
+        if (!chunk->watcher.isFinished()) {
+            // the watcher will trigger us again
+            return;
+        }
+        if (chunk->nextLine == chunk->lines.size()) {
+            m_pendingOutput.pop_front();
+            continue;
+        }
+
+        // keep the data alive, the chunk might be gone when processLine returns
+        const QByteArray data = chunk->data;
+        const QByteArray line = chunk->lines.at(chunk->nextLine);
+        std::unique_ptr<MI::Record> record;
+        if (!chunk->parsedAsync) {
+            FileSymbol file;
+            file.contents = line;
+            record = m_parser.parse(&file);
+        } else {
+            record = std::move(chunk->records[chunk->nextLine]);
+        }
+        ++chunk->nextLine;
+
+        processLine(line, std::move(record));
+    }
+}
+
+void MIDebugger::flushPendingOutput()
+{
+    for (const auto& chunk : m_pendingOutput) {
+        chunk->watcher.waitForFinished();
     }
+    processPendingOutput();
 }
 
 void MIDebugger::readyReadStandardError()
@@ -164,17 +262,12 @@ void MIDebugger::readyReadStandardError()
     emit debuggerInternalOutput(QString::fromUtf8(m_process->readAll()));
 }
 
-void MIDebugger::processLine(const QByteArray& line)
+void MIDebugger::processLine(const QByteArray& line, std::unique_ptr<MI::Record> r)
 {
     if (line != "(gdb) ") {
         qCDebug(DEBUGGERCOMMON) << "Debugger output (pid =" << m_process->pid() << "): " << line;
     }
 
-    FileSymbol file;
-    file.contents = line;
-
-    std::unique_ptr<MI::Record> r(m_parser.parse(&file));
-
     if (!r)
     {
         // simply ignore the invalid MI message because both gdb and lldb
@@ -347,6 +440,9 @@ void MIDebugger::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qCDebug(DEBUGGERCOMMON) << "Debugger FINISHED\n";
 
+    // handle the last replies before reporting the exit
+    flushPendingOutput();
+
     bool abnormal = exitCode != 0 || exitStatus != QProcess::NormalExit;
     emit userCommandOutput(QStringLiteral("Process exited\n"));
     emit exited(abnormal, i18n("Process exited"));
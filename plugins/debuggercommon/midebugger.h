@@ -31,6 +31,9 @@
 #include <QByteArray>
 #include <QObject>
 
+#include <deque>
+#include <memory>
+
 class KConfigGroup;
 class KProcess;
 
@@ -132,7 +135,14 @@ protected Q_SLOTS:
     void processErrored(QProcess::ProcessError);
 
 protected:
-    void processLine(const QByteArray& line);
+    void processLine(const QByteArray& line, std::unique_ptr<MI::Record> r);
+
+private Q_SLOTS:
+    void processPendingOutput();
+
+private:
+    /** Waits for all output still being parsed and processes it.  */
+    void flushPendingOutput();
 
 protected:
     QString m_debuggerExecutable;
@@ -144,6 +154,12 @@ protected:
     /** The unprocessed output from debugger. Output is
         processed as soon as we see newline. */
     QByteArray m_buffer;
+
+private:
+    struct OutputChunk;
+    /** Complete lines received from the debugger, in order. Large chunks
+        are parsed on a worker thread, the records are only handled here.  */
+    std::deque<std::unique_ptr<OutputChunk>> m_pendingOutput;
 };
 
 }
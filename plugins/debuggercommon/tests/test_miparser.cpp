@@ -117,6 +117,10 @@ void TestMIParser::testParseLine_data()
         << QByteArray("~\"Breakpoint 1 at 0x400ab0: file /path/to/some/file.cpp, line 28.\\n\"")
         << (int)KDevMI::MI::Record::Stream
         << StreamRecordData{KDevMI::MI::StreamRecord::Console, "Breakpoint 1 at 0x400ab0: file /path/to/some/file.cpp, line 28.\n"}.toVariant();
+    QTest::newRow("escapedutf8reply")
+        << QByteArray("~\"a\\tb \\\"c\\\" d\\\\e \xc3\xa4\\x\\n\"")
+        << (int)KDevMI::MI::Record::Stream
+        << StreamRecordData{KDevMI::MI::StreamRecord::Console, QString::fromUtf8("a\tb \"c\" d\\e \xc3\xa4\\x\n")}.toVariant();
     QTest::newRow("breakreply3")
         << QByteArray("=breakpoint-created,bkpt={number=\"1\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",addr=\"0x0000000000400ab0\",func=\"main(int, char**)\",file=\"/path/to/some/file.cpp\",fullname=\"/path/to/some/file.cpp\",line=\"28\",thread-groups=[\"i1\"],times=\"0\",original-location=\"/path/to/some/file.cpp:28\"}")
         << (int)KDevMI::MI::Record::Async
@@ -47,6 +47,20 @@ KJob* MakeBuilder::build( KDevelop::ProjectBaseItem *dom )
     return runMake( dom, MakeJob::BuildCommand );
 }
 
+KJob* MakeBuilder::buildItems(const QList<KDevelop::ProjectBaseItem*>& items)
+{
+    // building a folder means running make without a target, which does not combine with others
+    for (KDevelop::ProjectBaseItem* item : items) {
+        if (!item->target()) {
+            return nullptr;
+        }
+    }
+
+    auto* job = qobject_cast<MakeJob*>(runMake(items.first(), MakeJob::BuildCommand));
+    job->setCoalescedItems(items.mid(1));
+    return job;
+}
+
 KJob* MakeBuilder::clean( KDevelop::ProjectBaseItem *dom )
 {
     return runMake( dom, MakeJob::CleanCommand, QStringList(QStringLiteral("clean")) );
@@ -81,15 +95,31 @@ void MakeBuilder::jobFinished(KJob* job)
 
     if (mj->error())
     {
-        emit failed( mj->item() );
+        const auto failedItems = mj->failedItems();
+        for (KDevelop::ProjectBaseItem* item : failedItems) {
+            emit failed( item );
+        }
+        // a coalesced build keeps going, the targets not depending on a failed one were built
+        if (mj->commandType() == MakeJob::BuildCommand) {
+            const auto items = mj->items();
+            for (KDevelop::ProjectBaseItem* item : items) {
+                if (!failedItems.contains(item)) {
+                    emit built( item );
+                }
+            }
+        }
 
     } else
     {
         switch( mj->commandType() )
         {
-            case MakeJob::BuildCommand:
-                emit built( mj->item() );
+            case MakeJob::BuildCommand: {
+                const auto items = mj->items();
+                for (KDevelop::ProjectBaseItem* item : items) {
+                    emit built( item );
+                }
                 break;
+            }
             case MakeJob::InstallCommand:
                 emit installed( mj->item() );
                 break;
@@ -64,6 +64,14 @@ public:
      * @TODO: Work on any project item, for fileitems you may find a target.
      */
     KJob* build(KDevelop::ProjectBaseItem *dom) override;
+    /**
+     * Builds all target @p items with a single "make -k target1 target2 ...".
+     *
+     * Returns nullptr if any of the items is not a target. If the run fails, only the items
+     * whose target make reported as failed are reported as failed, all of them if make
+     * did not tell.
+     */
+    KJob* buildItems(const QList<KDevelop::ProjectBaseItem*>& items) override;
     KJob* clean(KDevelop::ProjectBaseItem *dom) override;
     KJob* install(KDevelop::ProjectBaseItem *dom, const QUrl &installPath) override;
 
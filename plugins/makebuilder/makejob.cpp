@@ -131,6 +131,55 @@ KDevelop::ProjectBaseItem * MakeJob::item() const
     return ICore::self()->projectController()->projectModel()->itemFromIndex(m_idx);
 }
 
+QList<KDevelop::ProjectBaseItem*> MakeJob::items() const
+{
+    QList<ProjectBaseItem*> ret;
+    if (ProjectBaseItem* it = item()) {
+        ret << it;
+    }
+    ProjectModel* model = ICore::self()->projectController()->projectModel();
+    for (const QPersistentModelIndex& index : m_coalescedIndexes) {
+        if (ProjectBaseItem* it = model->itemFromIndex(index)) {
+            ret << it;
+        }
+    }
+    return ret;
+}
+
+QList<KDevelop::ProjectBaseItem*> MakeJob::failedItems() const
+{
+    const auto allItems = items();
+    if (!m_failuresKnown) {
+        return allItems;
+    }
+
+    QList<ProjectBaseItem*> ret;
+    for (ProjectBaseItem* it : allItems) {
+        if (m_failedTargets.contains(it->target()->text())) {
+            ret << it;
+        }
+    }
+    return ret;
+}
+
+void MakeJob::setCoalescedItems(const QList<KDevelop::ProjectBaseItem*>& items)
+{
+    // the output tells which of the targets failed
+    setProperties(PostProcessOutput);
+
+    m_coalescedIndexes.clear();
+    m_coalescedIndexes.reserve(items.size());
+    QStringList names;
+    names.reserve(items.size() + 1);
+    names << item()->text();
+    for (ProjectBaseItem* it : items) {
+        m_coalescedIndexes << it->index();
+        names << it->text();
+    }
+
+    setJobName(i18n("Make (%1)", names.join(QLatin1String(", "))));
+}
+
 MakeJob::CommandType MakeJob::commandType() const
 {
     return m_command;
@@ -238,7 +287,8 @@ QStringList MakeJob::commandLine() const
     QString makeBin = builderGroup.readEntry("Make Binary", MakeBuilderPreferences::standardMakeExecutable());
     cmdline << makeBin;
 
-    if( ! builderGroup.readEntry("Abort on First Error", true))
+    // a coalesced build keeps going, so one failing target does not keep the others from being built
+    if( ! builderGroup.readEntry("Abort on First Error", true) || !m_coalescedIndexes.isEmpty() )
     {
         cmdline << (isNMake(makeBin) ? QStringLiteral("/K") : QStringLiteral("-k"));
     }
@@ -276,20 +326,23 @@ QStringList MakeJob::commandLine() const
 
     if( m_overrideTargets.isEmpty() )
     {
-        QString target;
-        switch (it->type()) {
-            case KDevelop::ProjectBaseItem::Target:
-            case KDevelop::ProjectBaseItem::ExecutableTarget:
-            case KDevelop::ProjectBaseItem::LibraryTarget:
-                Q_ASSERT(it->target());
-                cmdline << it->target()->text();
-                break;
-            case KDevelop::ProjectBaseItem::BuildFolder:
-                target = builderGroup.readEntry("Default Target", QString());
-                if( !target.isEmpty() )
-                    cmdline << target;
-                break;
-            default: break;
+        const auto targetItems = items();
+        for (ProjectBaseItem* targetItem : targetItems) {
+            QString target;
+            switch (targetItem->type()) {
+                case KDevelop::ProjectBaseItem::Target:
+                case KDevelop::ProjectBaseItem::ExecutableTarget:
+                case KDevelop::ProjectBaseItem::LibraryTarget:
+                    Q_ASSERT(targetItem->target());
+                    cmdline << targetItem->target()->text();
+                    break;
+                case KDevelop::ProjectBaseItem::BuildFolder:
+                    target = builderGroup.readEntry("Default Target", QString());
+                    if( !target.isEmpty() )
+                        cmdline << target;
+                    break;
+                default: break;
+            }
         }
     }else
     {
@@ -299,6 +352,68 @@ QStringList MakeJob::commandLine() const
     return cmdline;
 }
 
+void MakeJob::postProcessStdout(const QStringList& lines)
+{
+    findFailedTargets(lines);
+    OutputExecuteJob::postProcessStdout(lines);
+}
+
+void MakeJob::postProcessStderr(const QStringList& lines)
+{
+    findFailedTargets(lines);
+    OutputExecuteJob::postProcessStderr(lines);
+}
+
+void MakeJob::findFailedTargets(const QStringList& lines)
+{
+    // The top level make reports the goals it did not build, e.g.
+    // "make: *** [Makefile:84: foo] Error 2" or "make: Target 'bar' not remade because of errors."
+    // Recursive makes are reported as "make[1]: ...", those are skipped.
+    static const QRegularExpression failedRe(QStringLiteral(
+        "^[^\\s\\[]*make(?:\\.exe)?: (?:\\*\\*\\* \\[(?:.*: )?([^\\]]+)\\] Error"
+        "|\\*\\*\\* No rule to make target [`']([^']+)'"
+        "|Target [`']([^']+)' not remade because of errors)"));
+
+    for (const QString& line : lines) {
+        const QRegularExpressionMatch match = failedRe.match(line);
+        if (!match.hasMatch()) {
+            continue;
+        }
+        const QString target = match.captured(1) + match.captured(2) + match.captured(3);
+        bool isItemTarget = false;
+        const auto allItems = items();
+        for (ProjectBaseItem* it : allItems) {
+            if (it->target() && it->target()->text() == target) {
+                isItemTarget = true;
+                break;
+            }
+        }
+        if (isItemTarget) {
+            m_failedTargets.insert(target);
+        } else {
+            m_failedOther = true;
+        }
+    }
+}
+
+void MakeJob::childProcessExited(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_failuresKnown = !m_coalescedIndexes.isEmpty() && exitStatus == QProcess::NormalExit && exitCode != 0
+                      && !m_failedOther && !m_failedTargets.isEmpty();
+    if (m_failuresKnown) {
+        const auto allItems = items();
+        for (ProjectBaseItem* it : allItems) {
+            if (m_failedTargets.contains(it->target()->text())) {
+                model()->appendLine(i18n("*** Failed to build %1 ***", it->text()));
+            } else {
+                model()->appendLine(i18n("*** Built %1 ***", it->text()));
+            }
+        }
+    }
+
+    OutputExecuteJob::childProcessExited(exitCode, exitStatus);
+}
+
 QString MakeJob::environmentProfile() const
 {
     ProjectBaseItem* it = item();
@@ -26,7 +26,9 @@
 
 #include <outputview/outputexecutejob.h>
 
+#include <QSet>
 #include <QString>
+#include <QVector>
 
 #include "imakebuilder.h"
 
@@ -65,9 +67,24 @@ public:
     void start() override;
 
     KDevelop::ProjectBaseItem* item() const;
+    /// @return item() and the coalesced items which are still available
+    QList<KDevelop::ProjectBaseItem*> items() const;
     CommandType commandType() const;
     QStringList customTargets() const;
 
+    /**
+     * Builds the targets of @p items with the same make invocation as item().
+     *
+     * They have to share the build directory of item(). The invocation keeps going
+     * after errors, so the targets that do not depend on a failed one are still built.
+     */
+    void setCoalescedItems(const QList<KDevelop::ProjectBaseItem*>& items);
+    /**
+     * @return the items of a failed job whose target was not built, all items if
+     * make did not tell which of the targets failed
+     */
+    QList<KDevelop::ProjectBaseItem*> failedItems() const;
+
 
     // This returns the build directory for registered item.
     QUrl workingDirectory() const override;
@@ -81,10 +98,23 @@ public:
     // This returns the configured global environment profile.
     QString environmentProfile() const override;
 
+protected Q_SLOTS:
+    void postProcessStdout(const QStringList& lines) override;
+    void postProcessStderr(const QStringList& lines) override;
+    void childProcessExited(int exitCode, QProcess::ExitStatus exitStatus) override;
+
 private:
     static bool isNMake(const QString& makeBin);
-    
+    void findFailedTargets(const QStringList& lines);
+
     QPersistentModelIndex m_idx;
+    QVector<QPersistentModelIndex> m_coalescedIndexes;
+    /// targets that make reported as failed, only collected for coalesced builds
+    QSet<QString> m_failedTargets;
+    /// whether make reported a failure not belonging to any of the targets
+    bool m_failedOther = false;
+    /// whether the failed job built some of the targets, and m_failedTargets lists the others
+    bool m_failuresKnown = false;
     CommandType m_command;
     QStringList m_overrideTargets;
     MakeVariables m_variables;
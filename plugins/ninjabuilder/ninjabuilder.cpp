@@ -112,7 +112,8 @@ NinjaJob* NinjaBuilder::runNinja(KDevelop::ProjectBaseItem* item, NinjaJob::Comm
     KConfigGroup group = config->group("NinjaBuilder");
 
     if (!group.readEntry("Abort on First Error", true)) {
-        jobArguments << QStringLiteral("-k");
+        // -k takes the number of failures to stop at, 0 keeps going
+        jobArguments << QStringLiteral("-k0");
     }
     if (group.readEntry("Override Number Of Jobs", false)) {
         int jobCount = group.readEntry("Number Of Jobs", 1);
@@ -146,6 +147,33 @@ KJob* NinjaBuilder::build(KDevelop::ProjectBaseItem* item)
     return runNinja(item, NinjaJob::BuildCommand, argumentsForItem(item), "built");
 }
 
+KJob* NinjaBuilder::buildItems(const QList<KDevelop::ProjectBaseItem*>& items)
+{
+    QVector<QStringList> itemTargets;
+    itemTargets.reserve(items.size());
+    QStringList targets;
+    bool buildsDefaultTarget = false;
+    for (KDevelop::ProjectBaseItem* item : items) {
+        const QStringList currentTargets = argumentsForItem(item);
+        itemTargets << currentTargets;
+        // the default target builds everything, including the other items
+        buildsDefaultTarget |= currentTargets.isEmpty();
+        for (const QString& target : currentTargets) {
+            if (!targets.contains(target)) {
+                targets << target;
+            }
+        }
+    }
+    if (buildsDefaultTarget) {
+        targets.clear();
+    }
+
+    // keep going after errors, so one failing item does not keep the others from being built
+    NinjaJob* job = runNinja(items.first(), NinjaJob::BuildCommand, QStringList(QStringLiteral("-k0")) + targets, "built");
+    job->setCoalescedItems(items.mid(1), itemTargets);
+    return job;
+}
+
 KJob* NinjaBuilder::clean(KDevelop::ProjectBaseItem* item)
 {
     return runNinja(item, NinjaJob::CleanCommand, QStringList(QStringLiteral("-t")) << QStringLiteral("clean"), "cleaned");
@@ -39,6 +39,12 @@ public:
     explicit NinjaBuilder(QObject* parent = nullptr, const QVariantList& args = QVariantList());
 
     KJob* build(KDevelop::ProjectBaseItem* item) override;
+    /**
+     * Builds the targets of all @p items with a single "ninja -k0 target1 target2 ...".
+     *
+     * If the run fails, only the items depending on a failed command are reported as failed.
+     */
+    KJob* buildItems(const QList<KDevelop::ProjectBaseItem*>& items) override;
     KJob* clean(KDevelop::ProjectBaseItem* item) override;
     KJob* install(KDevelop::ProjectBaseItem* dom, const QUrl& installPath) override;
     KJob* install(KDevelop::ProjectBaseItem* item);
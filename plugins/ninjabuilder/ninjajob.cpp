@@ -27,11 +27,14 @@
 #include <interfaces/iproject.h>
 #include <interfaces/icore.h>
 #include <interfaces/iprojectcontroller.h>
+#include <interfaces/iruntime.h>
+#include <interfaces/iruntimecontroller.h>
 
 #include <KLocalizedString>
 #include <KConfigGroup>
 
 #include <QFile>
+#include <QProcess>
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QUrl>
@@ -101,13 +104,8 @@ NinjaJob::NinjaJob(KDevelop::ProjectBaseItem* item, CommandType commandType,
         }
     }
 
-    QString title;
-    if (!targets.isEmpty()) {
-        title = i18n("Ninja (%1): %2", item->text(), targets.join(QLatin1Char(' ')));
-    } else {
-        title = i18n("Ninja (%1)", item->text());
-    }
-    setJobName(title);
+    m_targets = targets;
+    updateJobName();
 
     connect(this, &NinjaJob::finished, this, &NinjaJob::emitProjectBuilderSignal);
 }
@@ -117,6 +115,11 @@ NinjaJob::~NinjaJob()
     // prevent crash when emitting KJob::finished from ~KJob
     // (=> at this point NinjaJob is already destructed...)
     disconnect(this, &NinjaJob::finished, this, &NinjaJob::emitProjectBuilderSignal);
+
+    if (m_findFailedItemsProcess) {
+        m_findFailedItemsProcess->disconnect(this);
+        delete m_findFailedItemsProcess;
+    }
 }
 
 void NinjaJob::setIsInstalling(bool isInstalling)
@@ -184,17 +187,82 @@ void NinjaJob::emitProjectBuilderSignal(KJob* job)
         return;
     }
 
-    KDevelop::ProjectBaseItem* it = item();
-    if (!it) {
+    for (int i = 0; i <= m_coalescedIndexes.size(); ++i) {
+        KDevelop::ProjectBaseItem* it = itemAt(i);
+        if (!it) {
+            continue;
+        }
+        // a coalesced build keeps going, the items not depending on a failed command were built
+        const bool failed = job->error() != 0 && (i >= m_itemFailed.size() || m_itemFailed.at(i));
+        if (!failed) {
+            Q_ASSERT(!m_signal.isEmpty());
+            QMetaObject::invokeMethod(m_plugin, m_signal.constData(), Q_ARG(KDevelop::ProjectBaseItem*, it));
+        } else {
+            QMetaObject::invokeMethod(m_plugin, "failed", Q_ARG(KDevelop::ProjectBaseItem*, it));
+        }
+    }
+}
+
+void NinjaJob::childProcessExited(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus == QProcess::NormalExit && exitCode != 0 && !m_itemTargets.isEmpty() && !m_failedCommands.isEmpty()) {
+        m_itemFailed.clear();
+        findFailedItems(exitCode);
         return;
     }
+    OutputExecuteJob::childProcessExited(exitCode, exitStatus);
+}
 
-    if (job->error() == 0) {
-        Q_ASSERT(!m_signal.isEmpty());
-        QMetaObject::invokeMethod(m_plugin, m_signal.constData(), Q_ARG(KDevelop::ProjectBaseItem*, it));
-    } else {
-        QMetaObject::invokeMethod(m_plugin, "failed", Q_ARG(KDevelop::ProjectBaseItem*, it));
+void NinjaJob::findFailedItems(int exitCode)
+{
+    const int index = m_itemFailed.size();
+    if (index == m_itemTargets.size()) {
+        for (int i = 0; i < m_itemFailed.size(); ++i) {
+            if (KDevelop::ProjectBaseItem* it = itemAt(i)) {
+                model()->appendLine(m_itemFailed.at(i) ? i18n("*** Failed to build %1 ***", it->text())
+                                                       : i18n("*** Built %1 ***", it->text()));
+            }
+        }
+        OutputExecuteJob::childProcessExited(exitCode, QProcess::NormalExit);
+        return;
     }
+
+    // "ninja -t commands" lists all commands needed for the targets of the item, the item
+    // failed if any of them failed
+    auto* process = new QProcess(this);
+    m_findFailedItemsProcess = process;
+    process->setWorkingDirectory(workingDirectory().toLocalFile());
+    process->setProgram(ninjaExecutable());
+    process->setArguments(QStringList{QStringLiteral("-t"), QStringLiteral("commands")} + m_itemTargets.at(index));
+
+    const auto itemDone = [this, process, exitCode](bool failed) {
+        m_itemFailed << failed;
+        process->deleteLater();
+        findFailedItems(exitCode);
+    };
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [process, itemDone, this](int queryExitCode, QProcess::ExitStatus queryExitStatus) {
+        bool failed = true;
+        if (queryExitStatus == QProcess::NormalExit && queryExitCode == 0) {
+            failed = false;
+            const QString commands = QString::fromLocal8Bit(process->readAllStandardOutput());
+            const auto commandLines = commands.splitRef(QLatin1Char('\n'));
+            for (const QStringRef& command : commandLines) {
+                if (m_failedCommands.contains(command.toString())) {
+                    failed = true;
+                    break;
+                }
+            }
+        }
+        itemDone(failed);
+    });
+    connect(process, &QProcess::errorOccurred, this, [itemDone](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            itemDone(true);
+        }
+    });
+
+    KDevelop::ICore::self()->runtimeController()->currentRuntime()->startProcess(process);
 }
 
 void NinjaJob::postProcessStderr(const QStringList& lines)
@@ -213,6 +281,16 @@ void NinjaJob::appendLines(const QStringList& lines)
         return;
     }
 
+    if (!m_itemTargets.isEmpty()) {
+        // a failed command is reported as "FAILED: <outputs>", followed by the command line
+        for (const QString& line : lines) {
+            if (m_nextLineIsFailedCommand) {
+                m_failedCommands.insert(line);
+            }
+            m_nextLineIsFailedCommand = line.startsWith(QLatin1String("FAILED: "));
+        }
+    }
+
     QStringList ret(lines);
     bool prev = false;
     for (QStringList::iterator it = ret.end(); it != ret.begin(); ) {
@@ -232,6 +310,60 @@ KDevelop::ProjectBaseItem* NinjaJob::item() const
     return KDevelop::ICore::self()->projectController()->projectModel()->itemFromIndex(m_idx);
 }
 
+KDevelop::ProjectBaseItem* NinjaJob::itemAt(int index) const
+{
+    if (index == 0) {
+        return item();
+    }
+    return KDevelop::ICore::self()->projectController()->projectModel()->itemFromIndex(m_coalescedIndexes.at(index - 1));
+}
+
+QList<KDevelop::ProjectBaseItem*> NinjaJob::items() const
+{
+    QList<KDevelop::ProjectBaseItem*> ret;
+    if (KDevelop::ProjectBaseItem* it = item()) {
+        ret << it;
+    }
+    KDevelop::ProjectModel* model = KDevelop::ICore::self()->projectController()->projectModel();
+    for (const QPersistentModelIndex& index : m_coalescedIndexes) {
+        if (KDevelop::ProjectBaseItem* it = model->itemFromIndex(index)) {
+            ret << it;
+        }
+    }
+    return ret;
+}
+
+void NinjaJob::setCoalescedItems(const QList<KDevelop::ProjectBaseItem*>& items, const QVector<QStringList>& itemTargets)
+{
+    Q_ASSERT(itemTargets.size() == items.size() + 1);
+    m_itemTargets = itemTargets;
+    m_coalescedIndexes.clear();
+    m_coalescedIndexes.reserve(items.size());
+    for (KDevelop::ProjectBaseItem* it : items) {
+        m_coalescedIndexes << it->index();
+    }
+    updateJobName();
+}
+
+void NinjaJob::updateJobName()
+{
+    QStringList names;
+    const auto jobItems = items();
+    names.reserve(jobItems.size());
+    for (KDevelop::ProjectBaseItem* it : jobItems) {
+        names << it->text();
+    }
+    const QString itemNames = names.join(QLatin1String(", "));
+
+    QString title;
+    if (!m_targets.isEmpty()) {
+        title = i18n("Ninja (%1): %2", itemNames, m_targets.join(QLatin1Char(' ')));
+    } else {
+        title = i18n("Ninja (%1)", itemNames);
+    }
+    setJobName(title);
+}
+
 NinjaJob::CommandType NinjaJob::commandType() const
 {
     return m_commandType;
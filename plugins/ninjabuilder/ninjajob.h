@@ -23,6 +23,8 @@
 #include <outputview/outputexecutejob.h>
 
 #include <QPointer>
+#include <QSet>
+#include <QVector>
 
 namespace KDevelop {
 class ProjectBaseItem;
@@ -59,6 +61,15 @@ public:
     static QString ninjaExecutable();
 
     KDevelop::ProjectBaseItem* item() const;
+    /// @return item() and the coalesced items which are still available
+    QList<KDevelop::ProjectBaseItem*> items() const;
+    /**
+     * Marks @p items as built by this job as well, their targets have to be part of the arguments.
+     *
+     * @p itemTargets holds the targets of item() followed by those of @p items. When the job fails,
+     * they are used to find out which items depend on the failed commands.
+     */
+    void setCoalescedItems(const QList<KDevelop::ProjectBaseItem*>& items, const QVector<QStringList>& itemTargets);
     CommandType commandType() const;
     QUrl workingDirectory() const override;
     QStringList privilegedExecutionCommand() const override;
@@ -66,6 +77,7 @@ public:
 protected Q_SLOTS:
     void postProcessStdout(const QStringList& lines) override;
     void postProcessStderr(const QStringList& lines) override;
+    void childProcessExited(int exitCode, QProcess::ExitStatus exitStatus) override;
 
 private Q_SLOTS:
     void emitProjectBuilderSignal(KJob* job);
@@ -73,11 +85,26 @@ private Q_SLOTS:
 private:
     bool m_isInstalling;
     QPersistentModelIndex m_idx;
+    QVector<QPersistentModelIndex> m_coalescedIndexes;
     CommandType m_commandType;
     QByteArray m_signal;
     QPointer<NinjaBuilder> m_plugin;
 
     void appendLines(const QStringList& lines);
+    void updateJobName();
+    KDevelop::ProjectBaseItem* itemAt(int index) const;
+    void findFailedItems(int exitCode);
+
+    /// targets of item() and the coalesced items, only set for coalesced builds
+    QVector<QStringList> m_itemTargets;
+    /// the commands ninja reported as failed, only collected for coalesced builds
+    QSet<QString> m_failedCommands;
+    bool m_nextLineIsFailedCommand = false;
+    /// whether the item at the same position in m_itemTargets failed
+    QVector<bool> m_itemFailed;
+    QPointer<QProcess> m_findFailedItemsProcess;
+
+    QStringList m_targets;
 };
 
 #endif  // NINJAJOB_H
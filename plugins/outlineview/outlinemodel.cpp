@@ -31,6 +31,10 @@
 #include <debug.h>
 #include "outlinenode.h"
 
+#include <QHash>
+
+#include <iterator>
+
 using namespace KDevelop;
 
 OutlineModel::OutlineModel(QObject* parent)
@@ -174,20 +178,31 @@ QModelIndex OutlineModel::parent(const QModelIndex& index) const
 
 void OutlineModel::rebuildOutline(IDocument* doc)
 {
-    beginResetModel();
+    std::unique_ptr<OutlineNode> newRoot;
     if (!doc) {
-        m_rootNode = OutlineNode::dummyNode();
+        newRoot = OutlineNode::dummyNode();
     } else {
-        // TODO: do this in a separate thread? Might take a while for large documents
-        // and we really shouldn't be blocking the GUI thread!
+        // only the structure is collected under the lock, the texts and icons are
+        // created when the view asks for them
+        // TODO: do this in a separate thread? Might still take a while for large documents
         DUChainReadLocker lock;
         TopDUContext* topContext = DUChainUtils::standardContextForUrl(doc->url());
         if (topContext) {
-            m_rootNode = OutlineNode::fromTopContext(topContext);
+            newRoot = OutlineNode::fromTopContext(topContext);
         } else {
-            m_rootNode = OutlineNode::dummyNode();
+            newRoot = OutlineNode::dummyNode();
         }
     }
+
+    if (m_rootNode && doc && doc == m_lastDoc) {
+        // the document was reparsed, only update what changed so the view keeps its state
+        m_rootNode->m_declOrContext = newRoot->m_declOrContext;
+        mergeChildren(m_rootNode.get(), QModelIndex(), newRoot.get());
+        return;
+    }
+
+    beginResetModel();
+    m_rootNode = std::move(newRoot);
     if (doc != m_lastDoc) {
         m_lastUrl = doc ? IndexedString(doc->url()) : IndexedString();
         m_lastDoc = doc;
@@ -195,6 +210,101 @@ void OutlineModel::rebuildOutline(IDocument* doc)
     endResetModel();
 }
 
+void OutlineModel::mergeChildren(OutlineNode* target, const QModelIndex& targetIndex, OutlineNode* source)
+{
+    auto& oldChildren = target->m_children;
+    auto& newChildren = source->m_children;
+
+    // Match the new children to the old ones in document order. For each new child the first not yet
+    // matched old child representing the same item is taken, moved items end up removed and reinserted.
+    auto keyFor = [](const OutlineNode& node) {
+        return node.m_isDeclaration ? qMakePair(node.m_identifier.index(), QString())
+                                    : qMakePair(0u, node.m_cachedText);
+    };
+    QHash<QPair<uint, QString>, QVector<int>> oldRows;
+    for (int row = 0; row < static_cast<int>(oldChildren.size()); ++row) {
+        oldRows[keyFor(*oldChildren[row])].append(row);
+    }
+    QHash<QPair<uint, QString>, int> nextCandidate;
+    std::vector<bool> oldMatched(oldChildren.size(), false);
+    std::vector<bool> newMatched(newChildren.size(), false);
+    int minRow = 0;
+    for (size_t i = 0; i < newChildren.size(); ++i) {
+        const auto key = keyFor(*newChildren[i]);
+        const auto rowsIt = oldRows.constFind(key);
+        if (rowsIt == oldRows.constEnd()) {
+            continue;
+        }
+        const QVector<int>& rows = *rowsIt;
+        int& candidate = nextCandidate[key];
+        while (candidate < rows.size() && rows[candidate] < minRow) {
+            ++candidate;
+        }
+        if (candidate < rows.size()) {
+            const int row = rows[candidate++];
+            oldMatched[row] = true;
+            newMatched[i] = true;
+            minRow = row + 1;
+        }
+    }
+
+    // remove the old children without counterpart, contiguous runs at once
+    for (int last = static_cast<int>(oldChildren.size()) - 1; last >= 0; --last) {
+        if (oldMatched[last]) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !oldMatched[first - 1]) {
+            --first;
+        }
+        beginRemoveRows(targetIndex, first, last);
+        oldChildren.erase(oldChildren.begin() + first, oldChildren.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    // now the remaining old children are in the same order as the matched new ones
+    int row = 0;
+    for (size_t i = 0; i < newChildren.size();) {
+        if (newMatched[i]) {
+            OutlineNode* oldNode = oldChildren[row].get();
+            OutlineNode* newNode = newChildren[i].get();
+            oldNode->m_declOrContext = newNode->m_declOrContext;
+            const QModelIndex oldIndex = createIndex(row, 0, oldNode);
+            // nodes the view never asked for pick up the new item when they are shown,
+            // the others are only updated if e.g. the signature of a function changed
+            if (oldNode->m_resolved) {
+                newNode->resolve();
+                if (oldNode->m_cachedText != newNode->m_cachedText
+                    || oldNode->m_cachedIcon.cacheKey() != newNode->m_cachedIcon.cacheKey()) {
+                    oldNode->m_cachedText = newNode->m_cachedText;
+                    oldNode->m_cachedIcon = newNode->m_cachedIcon;
+                    emit dataChanged(oldIndex, oldIndex);
+                }
+            }
+            mergeChildren(oldNode, oldIndex, newNode);
+            ++row;
+            ++i;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < newChildren.size() && !newMatched[end]) {
+            ++end;
+        }
+        const int count = static_cast<int>(end - i);
+        beginInsertRows(targetIndex, row, row + count - 1);
+        for (size_t j = i; j < end; ++j) {
+            newChildren[j]->m_parent = target;
+        }
+        oldChildren.insert(oldChildren.begin() + row, std::make_move_iterator(newChildren.begin() + i),
+                           std::make_move_iterator(newChildren.begin() + end));
+        endInsertRows();
+        row += count;
+        i = end;
+    }
+}
+
 void OutlineModel::activate(const QModelIndex& realIndex)
 {
     if (!realIndex.isValid()) {
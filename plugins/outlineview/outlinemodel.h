@@ -54,6 +54,10 @@ public Q_SLOTS:
 private Q_SLOTS:
     void rebuildOutline(KDevelop::IDocument* doc);
 private:
+    /// Updates the children of @p target to the ones of @p source, emitting fine-grained change signals.
+    /// Nodes that are not new are kept, so persistent indexes like the expansion state of the view stay valid.
+    void mergeChildren(OutlineNode* target, const QModelIndex& targetIndex, OutlineNode* source);
+
     std::unique_ptr<OutlineNode> m_rootNode;
     KDevelop::IDocument* m_lastDoc;
     KDevelop::IndexedString m_lastUrl;
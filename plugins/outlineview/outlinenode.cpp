@@ -39,6 +39,7 @@ using namespace KDevelop;
 OutlineNode::OutlineNode(const QString& text, OutlineNode* parent)
     : m_cachedText(text)
     , m_parent(parent)
+    , m_resolved(true)
 {
 }
 
@@ -46,6 +47,11 @@ OutlineNode::OutlineNode(DUContext* ctx, const QString& name, OutlineNode* paren
     : m_cachedText(name)
     , m_declOrContext(ctx)
     , m_parent(parent)
+{
+    appendContext(ctx, ctx->topContext());
+}
+
+QIcon OutlineNode::iconForContext(DUContext* ctx)
 {
     KTextEditor::CodeCompletionModel::CompletionProperties prop;
     switch (ctx->type()) {
@@ -67,27 +73,62 @@ OutlineNode::OutlineNode(DUContext* ctx, const QString& name, OutlineNode* paren
         default:
             break;
     }
-    m_cachedIcon = DUChainUtils::iconForProperties(prop);
-    appendContext(ctx, ctx->topContext());
+    return DUChainUtils::iconForProperties(prop);
 }
 
-
 OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
     : m_declOrContext(decl)
     , m_parent(parent)
+    , m_identifier(decl->indexedIdentifier())
+    , m_isDeclaration(true)
 {
     // qCDebug(PLUGIN_OUTLINE) << "Adding:" << decl->qualifiedIdentifier().toString() << ": " <<typeid(*decl).name();
 
+    // functions don't get any children
+    if (AbstractType::Ptr type = decl->abstractType()) {
+        if (type->whichType() == AbstractType::TypeFunction) {
+            return;
+        }
+    }
+
+    if (DUContext* ctx = decl->internalContext()) {
+        appendContext(ctx, decl->topContext());
+    }
+}
+
+void OutlineNode::resolve() const
+{
+    if (m_resolved) {
+        return;
+    }
+
+    DUChainReadLocker lock;
+    DUChainBase* object = m_declOrContext.data();
+    if (!object) {
+        // the item is gone, a new outline is on its way
+        return;
+    }
+    if (m_isDeclaration) {
+        auto* decl = static_cast<Declaration*>(object);
+        m_cachedText = textForDeclaration(decl);
+        m_cachedIcon = DUChainUtils::iconForDeclaration(decl);
+    } else {
+        m_cachedIcon = iconForContext(static_cast<DUContext*>(object));
+    }
+    m_resolved = true;
+}
+
+QString OutlineNode::textForDeclaration(Declaration* decl)
+{
     // TODO: properly qualified identifier for out of line function definitions
-    m_cachedText = decl->identifier().toString();
-    m_cachedIcon = DUChainUtils::iconForDeclaration(decl);
+    QString text = decl->identifier().toString();
     if (auto* alias = dynamic_cast<NamespaceAliasDeclaration*>(decl)) {
         //e.g. C++ using namespace statement
-        m_cachedText = alias->importIdentifier().toString();
+        text = alias->importIdentifier().toString();
     }
     else if (auto* member = dynamic_cast<ClassMemberDeclaration*>(decl)) {
         if (member->isFriend()) {
-            m_cachedText = QLatin1String("friend ") + m_cachedText;
+            text = QLatin1String("friend ") + text;
         }
     }
     if (AbstractType::Ptr type = decl->abstractType()) {
@@ -100,35 +141,35 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
             FunctionType::Ptr func = type.cast<FunctionType>();
             // func->partToString() does not add the argument names -> do it manually
             if (DUContext* fCtx = DUChainUtils::functionContext(decl)) {
-                m_cachedText += QLatin1Char('(');
+                text += QLatin1Char('(');
                 bool first = true;
                 const auto childDecls = fCtx->localDeclarations(decl->topContext());
                 for (Declaration* childDecl : childDecls) {
                     if (first) {
                         first = false;
                     } else {
-                        m_cachedText += QLatin1String(", ");
+                        text += QLatin1String(", ");
                     }
 
                     if (childDecl->abstractType()) {
-                        m_cachedText += childDecl->abstractType()->toString();
+                        text += childDecl->abstractType()->toString();
                     }
                     auto ident = childDecl->identifier();
                     if (!ident.isEmpty()) {
-                        m_cachedText += QLatin1Char(' ') +  ident.toString();
+                        text += QLatin1Char(' ') +  ident.toString();
                     }
 
                 }
-                m_cachedText += QLatin1Char(')');
+                text += QLatin1Char(')');
             } else {
                 qCWarning(PLUGIN_OUTLINE) << "Missing function context:" << decl->qualifiedIdentifier().toString();
-                m_cachedText += func->partToString(FunctionType::SignatureArguments);
+                text += func->partToString(FunctionType::SignatureArguments);
             }
             //constructors/destructors have no return type, a trailing semicolon would look stupid
             if (func->returnType()) {
-                m_cachedText += QLatin1String(" : ") + func->partToString(FunctionType::SignatureReturn);
+                text += QLatin1String(" : ") + func->partToString(FunctionType::SignatureReturn);
             }
-            return; // don't append any children here!
+            return text;
         }
         case AbstractType::TypeEnumeration:
             //no need to append the fully qualified type
@@ -136,7 +177,7 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
         case AbstractType::TypeEnumerator:
             //no need to append the fully qualified type
             Q_ASSERT(decl->type<EnumeratorType>());
-            m_cachedText += QLatin1String(" = ") + decl->type<EnumeratorType>()->valueAsString();
+            text += QLatin1String(" = ") + decl->type<EnumeratorType>()->valueAsString();
             break;
         case AbstractType::TypeStructure: {
             //this seems to be the way it has to be done (after grepping through source code)
@@ -145,7 +186,7 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
             const bool isFriend = decl->indexedIdentifier() == friendIdentifier;
             if (isFriend) {
                 //FIXME There seems to be no way of finding out whether the friend is class/struct/etc
-                m_cachedText += QLatin1Char(' ') + type->toString();
+                text += QLatin1Char(' ') + type->toString();
             }
             break;
         }
@@ -153,14 +194,14 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
             //append the type it aliases
             TypeAliasType::Ptr alias = type.cast<TypeAliasType>();
             if (AbstractType::Ptr targetType = alias->type()) {
-                m_cachedText += QLatin1String(" : ") + targetType->toString();
+                text += QLatin1String(" : ") + targetType->toString();
             }
         }
         break;
         default:
             QString typeStr = type->toString();
             if (!typeStr.isEmpty()) {
-                m_cachedText += QLatin1String(" : ") + typeStr;
+                text += QLatin1String(" : ") + typeStr;
             }
         }
     }
@@ -168,18 +209,16 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
 
     //these two don't seem to be hit
     if (decl->isAutoDeclaration()) {
-        m_cachedText = QLatin1String("Implicit: ") + m_cachedText;
+        text = QLatin1String("Implicit: ") + text;
     }
     if (decl->isAnonymous()) {
-        m_cachedText = QLatin1String("<anonymous>") + m_cachedText;
+        text = QLatin1String("<anonymous>") + text;
     }
 
-    if (DUContext* ctx = decl->internalContext()) {
-        appendContext(ctx, decl->topContext());
-    }
-    if (m_cachedText.isEmpty()) {
-        m_cachedText = i18nc("An anonymous declaration (class, function, etc.)", "<anonymous>");
+    if (text.isEmpty()) {
+        text = i18nc("An anonymous declaration (class, function, etc.)", "<anonymous>");
     }
+    return text;
 }
 
 std::unique_ptr<OutlineNode> OutlineNode::dummyNode()
@@ -190,6 +229,7 @@ std::unique_ptr<OutlineNode> OutlineNode::dummyNode()
 std::unique_ptr<OutlineNode> OutlineNode::fromTopContext(TopDUContext* ctx)
 {
     auto result = dummyNode();
+    result->m_declOrContext = ctx;
     result->appendContext(ctx, ctx);
     return result;
 }
@@ -200,7 +240,7 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
     const auto childDecls = ctx->localDeclarations(top);
     for (Declaration* childDecl : childDecls) {
         if (childDecl) {
-            m_children.emplace_back(childDecl, this);
+            m_children.emplace_back(new OutlineNode(childDecl, this));
         }
     }
     bool certainlyRequiresSorting = false;
@@ -239,22 +279,22 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
                 //  +-+- FooClass
                 //  | \-- method2()
                 //  \ OtherStuff
-                auto it = std::find_if(m_children.begin(), m_children.end(), [childContext](const OutlineNode& node) {
-                    if (auto* ctx = dynamic_cast<DUContext*>(node.duChainObject())) {
+                auto it = std::find_if(m_children.begin(), m_children.end(), [childContext](const std::unique_ptr<OutlineNode>& node) {
+                    if (auto* ctx = dynamic_cast<DUContext*>(node->duChainObject())) {
                         return ctx->equalScopeIdentifier(childContext);
                     }
                     return false;
                 });
                 if (it != m_children.end()) {
-                    it->appendContext(childContext, top);
+                    (*it)->appendContext(childContext, top);
                 }
                 else {
                     // TODO: get the correct icon for the context
-                    m_children.emplace_back(childContext, ctxName, this);
+                    m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
                 }
             } else {
                 // just add the context
-                m_children.emplace_back(childContext, ctxName, this);
+                m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
             }
         }
     }
@@ -275,17 +315,17 @@ void OutlineNode::sortByLocation(bool requiresSorting)
     // TODO: does it make sense to cache m_declOrContext->range().start?
     // adds 8 bytes to each node, but save a lot of pointer lookups when sorting
     // qDebug("sorting children of %s (%p) by location", qPrintable(m_cachedText), this);
-    auto compare = [](const OutlineNode& n1, const OutlineNode& n2) -> bool {
+    auto compare = [](const std::unique_ptr<OutlineNode>& n1, const std::unique_ptr<OutlineNode>& n2) -> bool {
         // nodes without decl always go at the end
-        if (!n1.m_declOrContext) {
+        if (!n1->m_declOrContext) {
             return false;
-        } else if (!n2.m_declOrContext) {
+        } else if (!n2->m_declOrContext) {
             return true;
         }
-        return n1.m_declOrContext->range().start < n2.m_declOrContext->range().start;
+        return n1->m_declOrContext->range().start < n2->m_declOrContext->range().start;
     };
     // since most nodes will be correctly sorted we check that before calling std::sort().
-    // This saves a lot of move ctor/assignment calls in the common case.
+    // This saves a lot of pointer moves in the common case.
     // If we appended a context without a Declaration* we know that it will be unsorted
     // so we can pass requiresSorting = true to skip the useless std::is_sorted() call.
     // uncomment the following qDebug() lines to see whether this optimization really makes sense
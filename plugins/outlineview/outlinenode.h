@@ -26,6 +26,7 @@
 #include <language/duchain/duchainbase.h>
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchainpointer.h>
+#include <language/duchain/identifier.h>
 
 
 namespace KDevelop {
@@ -33,35 +34,50 @@ class Declaration;
 class DUContext;
 }
 
+class OutlineModel;
+
+/**
+ * A node of the outline tree.
+ *
+ * Building the tree only records the structure. The display string and icon are created
+ * the first time the view asks for them and kept afterwards. Children are heap allocated so
+ * their address stays valid while the model inserts and removes siblings.
+ */
 class OutlineNode
 {
     Q_DISABLE_COPY(OutlineNode)
     void appendContext(KDevelop::DUContext* ctx, KDevelop::TopDUContext* top);
     void sortByLocation(bool requiresSorting);
+    void resolve() const;
+    static QString textForDeclaration(KDevelop::Declaration* decl);
+    static QIcon iconForContext(KDevelop::DUContext* ctx);
 public:
     OutlineNode(const QString& text, OutlineNode* parent);
-    OutlineNode(OutlineNode&& other) Q_DECL_NOEXCEPT;
-    OutlineNode& operator=(OutlineNode&& other) Q_DECL_NOEXCEPT;
     OutlineNode(KDevelop::Declaration* decl, OutlineNode* parent);
     OutlineNode(KDevelop::DUContext* ctx, const QString& name, OutlineNode* parent);
-    virtual ~OutlineNode();
+    ~OutlineNode();
     QIcon icon() const;
     QString text() const;
     const OutlineNode* parent() const;
-    const std::vector<OutlineNode>& children() const;
     int childCount() const;
     const OutlineNode* childAt(int index) const;
     int indexOf(const OutlineNode* child) const;
     static std::unique_ptr<OutlineNode> fromTopContext(KDevelop::TopDUContext* ctx);
     static std::unique_ptr<OutlineNode> dummyNode();
     KDevelop::DUChainBase* duChainObject() const;
-    friend void swap(OutlineNode& n1, OutlineNode& n2);
 private:
-    QString m_cachedText;
-    QIcon m_cachedIcon;
+    friend class OutlineModel;
+
+    /// For declarations only set once resolved, contexts keep their name from the start
+    mutable QString m_cachedText;
+    mutable QIcon m_cachedIcon;
     KDevelop::DUChainBasePointer m_declOrContext;
     OutlineNode* m_parent;
-    std::vector<OutlineNode> m_children;
+    std::vector<std::unique_ptr<OutlineNode>> m_children;
+    /// Identifier of the declaration, used to match nodes after a reparse
+    KDevelop::IndexedIdentifier m_identifier;
+    bool m_isDeclaration = false;
+    mutable bool m_resolved = false;
 };
 
 inline int OutlineNode::childCount() const
@@ -69,14 +85,9 @@ inline int OutlineNode::childCount() const
     return static_cast<int>(m_children.size());
 }
 
-inline const std::vector<OutlineNode>& OutlineNode::children() const
-{
-    return m_children;
-}
-
 inline const OutlineNode* OutlineNode::childAt(int index) const
 {
-    return &m_children.at(index);
+    return m_children.at(index).get();
 }
 
 inline const OutlineNode* OutlineNode::parent() const
@@ -87,9 +98,8 @@ inline const OutlineNode* OutlineNode::parent() const
 inline int OutlineNode::indexOf(const OutlineNode* child) const
 {
     const auto max = m_children.size();
-    // Comparing the address here is only fine since we never modify the vector after initial creation
     for (size_t i = 0; i < max; i++) {
-        if (child == &m_children[i]) {
+        if (child == m_children[i].get()) {
             return static_cast<int>(i);
         }
     }
@@ -98,11 +108,13 @@ inline int OutlineNode::indexOf(const OutlineNode* child) const
 
 inline QIcon OutlineNode::icon() const
 {
+    resolve();
     return m_cachedIcon;
 }
 
 inline QString OutlineNode::text() const
 {
+    resolve();
     return m_cachedText;
 }
 
@@ -112,51 +124,3 @@ inline KDevelop::DUChainBase* OutlineNode::duChainObject() const
     return m_declOrContext.data();
 }
 
-
-inline OutlineNode::OutlineNode(OutlineNode&& other) Q_DECL_NOEXCEPT
-    : m_cachedText(std::move(other.m_cachedText))
-    , m_cachedIcon(std::move(other.m_cachedIcon))
-    , m_declOrContext(std::move(other.m_declOrContext))
-    , m_parent(std::move(other.m_parent))
-    , m_children(std::move(other.m_children))
-{
-    // qDebug("Move ctor %p -> %p", &other, this);
-    other.m_parent = nullptr;
-    other.m_declOrContext = nullptr;
-    for (OutlineNode& child : m_children) {
-        // when we are moved the parent pointer has to be updated for the children!
-        child.m_parent = this;
-    }
-}
-
-inline OutlineNode& OutlineNode::operator=(OutlineNode&& other) Q_DECL_NOEXCEPT
-{
-    if (this == &other) {
-        return *this;
-    }
-    m_cachedText = std::move(other.m_cachedText);
-    m_cachedIcon = std::move(other.m_cachedIcon);
-    m_declOrContext = std::move(other.m_declOrContext);
-    m_parent = std::move(other.m_parent);
-    m_children = std::move(other.m_children);
-    // qDebug("Move assignment %p -> %p", &other, this);
-    other.m_parent = nullptr;
-    other.m_declOrContext = nullptr;
-    for (OutlineNode& child : m_children) {
-        // when we are moved the parent pointer has to be updated for the children!
-        child.m_parent = this;
-    }
-    return *this;
-}
-
-inline void swap(OutlineNode& n1, OutlineNode& n2)
-{
-    // For some reason std::sort only sometimes calls swap and mostly uses move ctor + assign.
-    // Probably it uses different algorithms for different sequence sizes
-    // qDebug("Swapping %p and %p", &n1, &n2);
-    std::swap(n1.m_cachedText, n2.m_cachedText);
-    std::swap(n1.m_cachedIcon, n2.m_cachedIcon);
-    std::swap(n1.m_declOrContext, n2.m_declOrContext);
-    std::swap(n1.m_parent, n2.m_parent);
-    std::swap(n1.m_children, n2.m_children);
-}
@@ -23,6 +23,10 @@
 
 #include "cache.h"
 #include "debug.h"
+#include "parsesession.h"
+
+#include <language/backgroundparser/backgroundparser.h>
+#include <interfaces/icore.h>
 
 #include <QString>
 #include <QProcess>
@@ -30,6 +34,94 @@
 #include <QStandardPaths>
 #include <QCryptographicHash>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QRunnable>
+#include <QSaveFile>
+
+namespace {
+
+/// Number of qmlplugindump processes running at the same time
+constexpr int maxParallelPluginDumps = 2;
+
+QString pluginDumpPath(const QString& pluginPath)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/kdevqmljssupport/%1.qml").arg(
+            QString::fromLatin1(QCryptographicHash::hash(pluginPath.toUtf8(), QCryptographicHash::Md5).toHex()));
+}
+
+class PluginDumpJob : public QRunnable
+{
+public:
+    PluginDumpJob(QmlJS::Cache* cache, const QString& pluginPath, void (QmlJS::Cache::*dump)(const QString&))
+        : m_cache(cache)
+        , m_pluginPath(pluginPath)
+        , m_dump(dump)
+    {
+    }
+
+    void run() override
+    {
+        (m_cache->*m_dump)(m_pluginPath);
+    }
+
+private:
+    QmlJS::Cache* m_cache;
+    QString m_pluginPath;
+    void (QmlJS::Cache::*m_dump)(const QString&);
+};
+
+}
+
+QByteArray QmlJS::PluginDump::stamp(const QString& pluginPath)
+{
+    const QFileInfo info(pluginPath);
+    return "// " + QByteArray::number(info.size()) + ' '
+        + QByteArray::number(info.lastModified().toMSecsSinceEpoch()) + '\n';
+}
+
+bool QmlJS::PluginDump::read(const QString& dumpPath, QByteArray* stamp, QByteArray* contents)
+{
+    QFile dumpFile(dumpPath);
+    if (!dumpFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = dumpFile.readLine();   // "// <plugin path>"
+    *stamp = dumpFile.readLine();
+    *contents = header + dumpFile.readAll();
+    return true;
+}
+
+bool QmlJS::PluginDump::write(const QString& dumpPath, const QByteArray& stamp, const QByteArray& contents)
+{
+    QDir().mkpath(QFileInfo(dumpPath).absolutePath());
+
+    // Replace the old dump only once the new one is complete
+    QSaveFile dumpFile(dumpPath);
+    if (!dumpFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    // Keep the plugin path in the first line, the stamp follows it
+    const int headerEnd = contents.indexOf('\n') + 1;
+    dumpFile.write(contents.left(headerEnd));
+    dumpFile.write(stamp);
+    dumpFile.write(contents.mid(headerEnd));
+    return dumpFile.commit();
+}
+
+bool QmlJS::PluginDump::isUpToDate(const QString& dumpPath, const QString& pluginPath)
+{
+    QFile dumpFile(dumpPath);
+    if (!dumpFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // only the stamp in the second line is needed, not the whole dump
+    dumpFile.readLine();
+    return dumpFile.readLine() == PluginDump::stamp(pluginPath);
+}
 
 QmlJS::Cache::Cache()
 {
@@ -40,6 +132,8 @@ QmlJS::Cache::Cache()
         << PluginDumpExecutable(QStringLiteral("qmlplugindump-qt4"), QStringLiteral("1.0"))
         << PluginDumpExecutable(QStringLiteral("qmlplugindump-qt5"), QStringLiteral("2.0"))
         << PluginDumpExecutable(QStringLiteral("qml1plugindump-qt5"), QStringLiteral("1.0"));
+
+    m_pluginDumpPool.setMaxThreadCount(maxParallelPluginDumps);
 }
 
 QmlJS::Cache& QmlJS::Cache::instance()
@@ -128,7 +222,7 @@ QString QmlJS::Cache::modulePath(const KDevelop::IndexedString& baseFile, const
     return path;
 }
 
-QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
+QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos, const KDevelop::IndexedString& requester)
 {
     QStringList result;
 
@@ -165,72 +259,140 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
             }
         }
 
-        // Locate an existing dump of the file
-        QString dumpFile = QStringLiteral("kdevqmljssupport/%1.qml").arg(
-            QString::fromLatin1(QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Md5).toHex())
-        );
-        QString dumpPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-            dumpFile
-        );
+        // Locate an existing dump of the file, made in this or a previous session
+        const QString dumpPath = pluginDumpPath(filePath);
 
-        if (!dumpPath.isEmpty()) {
-            QMutexLocker lock(&m_mutex);
+        if (!QFile::exists(dumpPath)) {
+            // The plugin is skipped until its dump is ready
+            schedulePluginDump(filePath, requester);
+            continue;
+        }
+
+        result.append(dumpPath);
 
-            result.append(dumpPath);
+        if (PluginDump::isUpToDate(dumpPath, filePath)) {
+            QMutexLocker lock(&m_mutex);
             m_modulePaths.insert(filePath, dumpPath);
-            continue;
+        } else {
+            // The plugin changed, keep using the old dump until the new one is ready
+            schedulePluginDump(filePath, requester);
         }
+    }
 
-        // Create a dump of the file
-        const QStringList args = {QStringLiteral("-noinstantiate"), QStringLiteral("-path"), filePath};
+    return result;
+}
 
-        for (const PluginDumpExecutable& executable : qAsConst(m_pluginDumpExecutables)) {
-            QProcess qmlplugindump;
-            qmlplugindump.setProcessChannelMode(QProcess::SeparateChannels);
-            qmlplugindump.start(executable.executable, args, QIODevice::ReadOnly);
+void QmlJS::Cache::schedulePluginDump(const QString& pluginPath, const KDevelop::IndexedString& requester)
+{
+    QMutexLocker lock(&m_mutex);
 
-            qCDebug(KDEV_QMLJS_DUCHAIN) << "starting qmlplugindump with args:" << executable.executable << args << qmlplugindump.state() << fileInfo.absolutePath();
+    const bool queued = m_pendingPluginDumps.contains(pluginPath);
+    m_pendingPluginDumps[pluginPath].insert(requester);
 
-            if (!qmlplugindump.waitForFinished(3000)) {
-                if (qmlplugindump.state() == QProcess::Running) {
-                    qCWarning(KDEV_QMLJS_DUCHAIN) << "qmlplugindump didn't finish in time -- killing";
-                    qmlplugindump.kill();
-                    qmlplugindump.waitForFinished(100);
-                } else {
-                    qCDebug(KDEV_QMLJS_DUCHAIN) << "qmlplugindump attempt failed" << qmlplugindump.program() << qmlplugindump.arguments() << qmlplugindump.readAllStandardError();
-                }
-                continue;
-            }
+    if (!queued) {
+        m_pluginDumpPool.start(new PluginDumpJob(this, pluginPath, &Cache::dumpPlugin));
+    }
+}
 
-            if (qmlplugindump.exitCode() != 0) {
-                qCWarning(KDEV_QMLJS_DUCHAIN) << "qmlplugindump finished with exit code:" << qmlplugindump.exitCode();
-                continue;
-            }
+void QmlJS::Cache::cancelPluginDumps()
+{
+    m_pluginDumpsCancelled = true;
+    m_pluginDumpPool.clear();
+    m_pluginDumpPool.waitForDone();
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_pendingPluginDumps.clear();
+    }
+    m_pluginDumpsCancelled = false;
+}
 
-            // Open a file in which the dump can be written
-            QFile dumpFile(
-                QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-                + dumpPath
-            );
+void QmlJS::Cache::dumpPlugin(const QString& pluginPath)
+{
+    const QString dumpPath = pluginDumpPath(pluginPath);
+    const QByteArray stamp = PluginDump::stamp(pluginPath);
+    const QStringList args = {QStringLiteral("-noinstantiate"), QStringLiteral("-path"), pluginPath};
 
-            if (dumpFile.open(QIODevice::WriteOnly)) {
-                qmlplugindump.readLine();   // Skip "import QtQuick.tooling 1.1"
+    QByteArray contents;
+    bool dumped = false;
 
-                dumpFile.write("// " + filePath.toUtf8() + '\n');
-                dumpFile.write("import QtQuick " + executable.quickVersion.toUtf8() + '\n');
-                dumpFile.write(qmlplugindump.readAllStandardOutput());
-                dumpFile.close();
+    for (const PluginDumpExecutable& executable : qAsConst(m_pluginDumpExecutables)) {
+        if (m_pluginDumpsCancelled) {
+            return;
+        }
 
-                result.append(dumpFile.fileName());
+        QProcess qmlplugindump;
+        qmlplugindump.setProcessChannelMode(QProcess::SeparateChannels);
+        qmlplugindump.start(executable.executable, args, QIODevice::ReadOnly);
 
-                QMutexLocker lock(&m_mutex);
-                m_modulePaths.insert(filePath, dumpFile.fileName());
-                break;
+        qCDebug(KDEV_QMLJS_DUCHAIN) << "starting qmlplugindump with args:" << executable.executable << args << qmlplugindump.state();
+
+        if (!qmlplugindump.waitForFinished(3000)) {
+            if (qmlplugindump.state() == QProcess::Running) {
+                qCWarning(KDEV_QMLJS_DUCHAIN) << "qmlplugindump didn't finish in time -- killing";
+                qmlplugindump.kill();
+                qmlplugindump.waitForFinished(100);
+            } else {
+                qCDebug(KDEV_QMLJS_DUCHAIN) << "qmlplugindump attempt failed" << qmlplugindump.program() << qmlplugindump.arguments() << qmlplugindump.readAllStandardError();
             }
+            continue;
         }
+
+        if (qmlplugindump.exitCode() != 0) {
+            qCWarning(KDEV_QMLJS_DUCHAIN) << "qmlplugindump finished with exit code:" << qmlplugindump.exitCode();
+            continue;
+        }
+
+        qmlplugindump.readLine();   // Skip "import QtQuick.tooling 1.1"
+
+        contents = "// " + pluginPath.toUtf8() + '\n'
+                 + "import QtQuick " + executable.quickVersion.toUtf8() + '\n'
+                 + qmlplugindump.readAllStandardOutput();
+        dumped = true;
+        break;
     }
 
-    return result;
+    QByteArray oldStamp;
+    QByteArray oldContents;
+    const bool existed = PluginDump::read(dumpPath, &oldStamp, &oldContents);
+
+    bool changed = false;
+    if (dumped) {
+        changed = !existed || oldContents != contents;
+
+        if (!PluginDump::write(dumpPath, stamp, contents)) {
+            qCWarning(KDEV_QMLJS_DUCHAIN) << "cannot write the qmlplugindump output to" << dumpPath;
+            dumped = false;
+            changed = false;
+        }
+    }
+
+    QSet<KDevelop::IndexedString> requesters;
+    {
+        QMutexLocker lock(&m_mutex);
+
+        requesters = m_pendingPluginDumps.take(pluginPath);
+        // Also remember failures, so that they are not tried again in this session.
+        // An outdated dump is still better than none, so keep using it if the plugin could not be dumped again
+        m_modulePaths.insert(pluginPath, (dumped || existed) ? dumpPath : QString());
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    // The language controller may be gone already
+    if (m_pluginDumpsCancelled || KDevelop::ICore::self()->shuttingDown()) {
+        return;
+    }
+
+    // Files that were parsed before the dump existed don't depend on it yet, the others
+    // are reparsed once the dump itself is
+    const auto priority = KDevelop::BackgroundParser::NormalPriority;
+    ParseSession::scheduleForParsing(KDevelop::IndexedString(dumpPath), priority);
+    for (const KDevelop::IndexedString& requester : qAsConst(requesters)) {
+        ParseSession::scheduleForParsing(requester, priority);
+    }
 }
 
 void QmlJS::Cache::setFileCustomIncludes(const KDevelop::IndexedString& file, const KDevelop::Path::List& dirs)
@@ -33,12 +33,44 @@
 #include <QList>
 #include <QSet>
 #include <QMutex>
+#include <QThreadPool>
+
+#include <atomic>
 
 class QStringList;
 
 namespace QmlJS
 {
 
+/**
+ * Storage of the qmlplugindump dumps made by Cache
+ *
+ * A dump starts with a comment holding the path of the plugin, followed by a
+ * comment with the stamp of the plugin binary it was made from.
+ */
+namespace PluginDump
+{
+/**
+ * Identifies the version of a plugin binary by its size and modification time
+ */
+KDEVQMLJSDUCHAIN_EXPORT QByteArray stamp(const QString& pluginPath);
+
+/**
+ * Read a dump, split into the stamp line and everything else
+ */
+KDEVQMLJSDUCHAIN_EXPORT bool read(const QString& dumpPath, QByteArray* stamp, QByteArray* contents);
+
+/**
+ * Atomically replace the dump at @p dumpPath, @p contents as returned by read()
+ */
+KDEVQMLJSDUCHAIN_EXPORT bool write(const QString& dumpPath, const QByteArray& stamp, const QByteArray& contents);
+
+/**
+ * Return whether the dump at @p dumpPath exists and was made from the current version of the plugin
+ */
+KDEVQMLJSDUCHAIN_EXPORT bool isUpToDate(const QString& dumpPath, const QString& pluginPath);
+}
+
 /**
  * Cache for values that may be slow to compute (search paths, things
  * involving QStandardPaths, etc)
@@ -74,9 +106,24 @@ public:
      * Return the list of the paths of the given files.
      *
      * Files having a name ending in ".so" are replaced with the path of their
-     * qmlplugindump dump.
+     * qmlplugindump dump. Dumps are kept across sessions, and are made again
+     * when the size or modification time of the plugin changes.
+     *
+     * qmlplugindump is never run by this method: if there is no dump yet, the
+     * plugin is skipped and a dump is made in the background, a few at a time.
+     * When it is done, @p requester is reparsed. When an existing dump was out of
+     * date and its contents changed, the dump itself is reparsed, which in turn
+     * reparses the files importing it.
+     */
+    QStringList getFileNames(const QFileInfoList& fileInfos, const KDevelop::IndexedString& requester);
+
+    /**
+     * Drop the queued qmlplugindump runs and wait for the running one, which then neither
+     * tries further executables nor reparses anything.
+     *
+     * Called when the plugin is unloaded, so that no dump job outlives it.
      */
-    QStringList getFileNames(const QFileInfoList& fileInfos);
+    void cancelPluginDumps();
 
     /**
      * Set the custom include directories list of a file
@@ -109,6 +156,16 @@ public:
 private:
     KDevelop::Path::List libraryPaths_internal(const KDevelop::IndexedString& baseFile) const;
 
+    /**
+     * Queue a qmlplugindump run for @p pluginPath, unless one is already queued
+     */
+    void schedulePluginDump(const QString& pluginPath, const KDevelop::IndexedString& requester);
+
+    /**
+     * Run qmlplugindump for @p pluginPath and store its result, called from m_pluginDumpPool
+     */
+    void dumpPlugin(const QString& pluginPath);
+
     struct PluginDumpExecutable {
         QString executable;
         QString quickVersion;       // Version of QtQuick that should be imported when this qmlplugindump is used
@@ -125,6 +182,10 @@ private:
     QHash<KDevelop::IndexedString, QSet<KDevelop::IndexedString>> m_dependencies;
     QHash<KDevelop::IndexedString, bool> m_isUpToDate;
     QHash<KDevelop::IndexedString, KDevelop::Path::List> m_includeDirs;
+    // plugin paths with a queued or running dump, and the files that asked for them
+    QHash<QString, QSet<KDevelop::IndexedString>> m_pendingPluginDumps;
+    QThreadPool m_pluginDumpPool;
+    std::atomic<bool> m_pluginDumpsCancelled{false};
 };
 
 }
@@ -0,0 +1,105 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../cache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+class TestPluginDump : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testWriteAndRead();
+    void testUpToDate();
+};
+
+namespace {
+void writePlugin(const QString& fileName, const QByteArray& contents)
+{
+    QFile plugin(fileName);
+    QVERIFY(plugin.open(QIODevice::WriteOnly));
+    plugin.write(contents);
+}
+}
+
+void TestPluginDump::testWriteAndRead()
+{
+    QTemporaryDir dir;
+    const QString pluginPath = dir.filePath("libplugin.so");
+    const QString dumpPath = dir.filePath("dumps/plugin.qml");
+    writePlugin(pluginPath, "binary");
+
+    const QByteArray stamp = QmlJS::PluginDump::stamp(pluginPath);
+    QVERIFY(stamp.startsWith("// "));
+    QVERIFY(stamp.endsWith('\n'));
+
+    const QByteArray contents = "// " + pluginPath.toUtf8() + "\nimport QtQuick 2.0\nModule {}\n";
+    QVERIFY(QmlJS::PluginDump::write(dumpPath, stamp, contents));
+
+    // the stamp is stored in the second line, and left out of the contents
+    QFile dumpFile(dumpPath);
+    QVERIFY(dumpFile.open(QIODevice::ReadOnly));
+    dumpFile.readLine();
+    QCOMPARE(dumpFile.readLine(), stamp);
+
+    QByteArray readStamp;
+    QByteArray readContents;
+    QVERIFY(QmlJS::PluginDump::read(dumpPath, &readStamp, &readContents));
+    QCOMPARE(readStamp, stamp);
+    QCOMPARE(readContents, contents);
+
+    QVERIFY(!QmlJS::PluginDump::read(dir.filePath("missing.qml"), &readStamp, &readContents));
+}
+
+void TestPluginDump::testUpToDate()
+{
+    QTemporaryDir dir;
+    const QString pluginPath = dir.filePath("libplugin.so");
+    const QString dumpPath = dir.filePath("plugin.qml");
+    writePlugin(pluginPath, "binary");
+
+    QVERIFY(!QmlJS::PluginDump::isUpToDate(dumpPath, pluginPath));
+
+    QVERIFY(QmlJS::PluginDump::write(dumpPath, QmlJS::PluginDump::stamp(pluginPath), "// plugin\nModule {}\n"));
+    QVERIFY(QmlJS::PluginDump::isUpToDate(dumpPath, pluginPath));
+
+    // a rebuilt plugin needs a new dump
+    writePlugin(pluginPath, "rebuilt binary");
+    QVERIFY(!QmlJS::PluginDump::isUpToDate(dumpPath, pluginPath));
+
+    QVERIFY(QmlJS::PluginDump::write(dumpPath, QmlJS::PluginDump::stamp(pluginPath), "// plugin\nModule {}\n"));
+    QVERIFY(QmlJS::PluginDump::isUpToDate(dumpPath, pluginPath));
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    // so does a plugin of the same size, as long as its modification time changed
+    QFile plugin(pluginPath);
+    QVERIFY(plugin.open(QIODevice::ReadWrite));
+    QVERIFY(plugin.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    plugin.close();
+    QVERIFY(!QmlJS::PluginDump::isUpToDate(dumpPath, pluginPath));
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestPluginDump)
+
+#include "test_qmljsplugindump.moc"
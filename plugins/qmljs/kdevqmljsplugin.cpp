@@ -24,6 +24,7 @@
 #include "qmljshighlighting.h"
 #include "codecompletion/model.h"
 #include "navigation/propertypreviewwidget.h"
+#include "duchain/cache.h"
 #include "duchain/helper.h"
 
 #include <qmljs/qmljsmodelmanagerinterface.h>
@@ -85,6 +86,9 @@ KDevQmlJsPlugin::~KDevQmlJsPlugin()
     // By locking the parse-mutexes, we make sure that parse jobs get a chance to finish in a good state
     parseLock()->unlock();
 
+    // the dump jobs reparse files through this plugin
+    QmlJS::Cache::instance().cancelPluginDumps();
+
     QmlJS::unregisterDUChainItems();
 }
 